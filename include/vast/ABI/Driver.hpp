@@ -18,11 +18,11 @@ VAST_UNRELAX_WARNINGS
 
 namespace vast::abi {
     template< typename FnOp >
-    auto make_x86_64(FnOp fn, const mlir::DataLayout &dl) {
+    auto make_x86_64(FnOp fn, const mlir::DataLayout &dl, hl::record_layout_cache &layouts) {
         using out        = func_info< FnOp >;
         using classifier = classifier_base< out, mlir_type_info >;
 
-        auto type_info = mlir_type_info(*fn.getContext(), dl);
+        auto type_info = mlir_type_info(*fn.getContext(), dl, layouts);
         return make< FnOp, mlir_type_info, classifier >(fn, type_info);
     }
 } // namespace vast::abi
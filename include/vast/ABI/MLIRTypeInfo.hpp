@@ -10,6 +10,7 @@ VAST_UNRELAX_WARNINGS
 
 #include "vast/ABI/ABI.hpp"
 
+#include "vast/Dialect/HighLevel/HighLevelRecordLayout.hpp"
 #include "vast/Dialect/HighLevel/HighLevelUtils.hpp"
 
 namespace vast::abi {
@@ -20,10 +21,14 @@ namespace vast::abi {
       protected:
         mcontext_t &mctx;
         const data_layout_t &dl;
+        // Fields of records are queried repeatedly for each eightbyte.
+        hl::record_layout_cache &layouts;
 
       public:
-        explicit mlir_type_info(mcontext_t &mctx, const data_layout_t &dl)
-            : mctx(mctx), dl(dl)
+        explicit mlir_type_info(
+            mcontext_t &mctx, const data_layout_t &dl, hl::record_layout_cache &layouts
+        )
+            : mctx(mctx), dl(dl), layouts(layouts)
         {}
 
         static bool is_void(mlir_type t);
@@ -190,7 +195,7 @@ namespace vast::abi {
         if (auto array_type = mlir::dyn_cast< hl::ArrayType >(type))
             return mock_array_fields(array_type);
         if (auto record_type = mlir::dyn_cast< hl::RecordType >(type))
-            return field_types(record_type, from);
+            return layouts.get(record_type, from).field_types();
         VAST_UNREACHABLE("Unsupported type: {0}", type);
     }
 
@@ -219,12 +224,24 @@ namespace vast::abi {
     auto mlir_type_info::field_containing_offset(mlir_type t, std::size_t offset, operation from)
         -> std::optional< std::tuple< mlir_type, std::size_t > >
     {
-        auto curr = 0;
-        for (auto field : fields(t, from)) {
-            if (curr + size(field) > offset) {
-                return { std::make_tuple(field, curr) };
+        if (is_array(t)) {
+            std::size_t curr = 0;
+            for (auto field : fields(t, from)) {
+                if (curr + size(field) > offset) {
+                    return { std::make_tuple(field, curr) };
+                }
+                curr += size(field);
+            }
+            return {};
+        }
+
+        // Fields are walked as if packed, as the classifier does.
+        std::size_t curr = 0;
+        for (const auto &field : layouts.get(mlir::cast< hl::RecordType >(t), from).fields) {
+            if (curr + field.size > offset) {
+                return { std::make_tuple(field.type, curr) };
             }
-            curr += size(field);
+            curr += field.size;
         }
         return {};
     }
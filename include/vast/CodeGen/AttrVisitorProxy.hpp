@@ -6,9 +6,9 @@
 
 namespace vast::cg {
 
-    struct attr_visitor_proxy : fallthrough_list_node {
+    struct attr_visitor_layer {
 
-        explicit attr_visitor_proxy(visitor_base &head) : head(head) {}
+        explicit attr_visitor_layer(visitor_base &head) : head(head) {}
 
         using excluded_attr_list = util::type_list<
               clang::WeakAttr
@@ -18,10 +18,25 @@ namespace vast::cg {
 
         operation visit_decl_attrs(operation op, const clang_decl *decl, scope_context &scope);
 
-        operation visit(const clang_decl *decl, scope_context &scope) override;
+        operation visit(const clang_decl *decl, scope_context &scope, auto &&next) {
+            if (auto op = next(decl, scope)) {
+                return visit_decl_attrs(op, decl, scope);
+            }
+
+            return {};
+        }
 
       protected:
         visitor_view head;
     };
 
+    struct attr_visitor_proxy : fallthrough_list_node, attr_visitor_layer {
+
+        explicit attr_visitor_proxy(visitor_base &head) : attr_visitor_layer(head) {}
+
+        using fallthrough_list_node::visit;
+
+        operation visit(const clang_decl *decl, scope_context &scope) override;
+    };
+
 } // namespace vast::cg
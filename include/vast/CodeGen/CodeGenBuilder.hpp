@@ -14,6 +14,9 @@
 #include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
 #include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
 
+#include <memory>
+#include <mutex>
+
 namespace vast::cg {
 
     static inline auto first_result = [] (auto op) { return op->getResult(0); };
@@ -173,6 +176,17 @@ namespace vast::cg {
 
         core::module module;
 
+        // Set for builders of codegen workers, guards emission of operations
+        // and queries of generators that are shared by the workers.
+        std::shared_ptr< std::recursive_mutex > shared_mutex;
+
+        [[nodiscard]] std::unique_lock< std::recursive_mutex > lock_shared() {
+            if (shared_mutex) {
+                return std::unique_lock(*shared_mutex);
+            }
+            return {};
+        }
+
         insertion_guard insertion_guard() { return { *this }; }
 
         void set_insertion_point_to_start(region_ptr region) {
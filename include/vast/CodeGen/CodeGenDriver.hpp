@@ -16,6 +16,7 @@ VAST_UNRELAX_WARNINGS
 
 #include "vast/CodeGen/ScopeContext.hpp"
 #include "vast/CodeGen/CodeGenModule.hpp"
+#include "vast/CodeGen/DataLayout.hpp"
 
 #include "vast/Frontend/Options.hpp"
 
@@ -51,11 +52,13 @@ namespace vast::cg {
             , mcontext_t &_mctx
             , std::unique_ptr< codegen_builder > _bld
             , std::shared_ptr< visitor_base > _visitor
+            , std::shared_ptr< type_layouts > _layouts
         )
             : actx(_actx)
             , mctx(_mctx)
             , bld(std::move(_bld))
             , visitor(std::move(_visitor))
+            , layouts(std::move(_layouts))
             , top(mk_wrapping_module(mctx))
             , mod(mk_module_with_attrs(
                 actx, top.get(), cc::get_source_language(actx.getLangOpts())
@@ -71,14 +74,33 @@ namespace vast::cg {
 
         bool enable_verifier(bool set = true) { return (enabled_verifier = set); }
 
+        // Bodies of function definitions are emitted by `jobs` workers when
+        // the whole translation unit is visited.
+        void enable_parallel_codegen(unsigned jobs, codegen_worker_factory factory);
+
+        // Bodies of function definitions are emitted only by `emit_definitions`
+        // once the whole translation unit is visited.
+        void enable_streaming();
+
+        // Emits collected function definitions one at a time, `emitted` is
+        // invoked right after a body is generated and may move it away.
+        void emit_definitions(llvm::function_ref< void(vast_function) > emitted);
+
         virtual void emit(clang::DeclGroupRef decls);
         virtual void emit(clang::Decl *decl);
 
         virtual void emit_data_layout();
+
+        // Attaches layout of types that `part` refers to, used for parts of
+        // streamed modules that were extracted from `module()`.
+        void emit_data_layout(core::module part);
+        virtual void emit_definitions();
         virtual void finalize();
 
         owning_mlir_module_ref freeze();
 
+        core::module module() { return mod; }
+
         mcontext_t &mcontext() { return mctx; }
         acontext_t &acontext() { return actx; }
 
@@ -89,6 +111,8 @@ namespace vast::cg {
         // driver options
         //
         bool enabled_verifier;
+        unsigned codegen_jobs = 1;
+        codegen_worker_factory mk_worker;
 
         //
         // contexts
@@ -104,6 +128,9 @@ namespace vast::cg {
         std::unique_ptr< codegen_builder > bld;
         std::shared_ptr< visitor_base > visitor;
 
+        // shared with visitors of codegen workers
+        std::shared_ptr< type_layouts > layouts;
+
         //
         // module generation state
         //
@@ -31,6 +31,7 @@ namespace vast::cg {
         using generator_base::generator_base;
 
         operation emit(const clang_function *decl);
+        void emit_definition(const clang_function *decl, vast_function fn);
         void declare_function_params(const clang_function *decl, vast_function fn);
 
         void emit_body(const clang_function *decl, vast_function prototype);
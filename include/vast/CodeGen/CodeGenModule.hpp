@@ -15,6 +15,7 @@ VAST_UNRELAX_WARNINGS
 #include "vast/Util/DataLayout.hpp"
 
 #include "vast/CodeGen/CodeGenVisitorBase.hpp"
+#include "vast/CodeGen/CodeGenVisitorList.hpp"
 #include "vast/CodeGen/CodeGenBuilder.hpp"
 #include "vast/CodeGen/ScopeContext.hpp"
 #include "vast/CodeGen/CodeGenMetaGenerator.hpp"
@@ -28,6 +29,16 @@ VAST_UNRELAX_WARNINGS
 
 namespace vast::cg {
 
+    // Builder and visitors of a worker that emits function bodies
+    // concurrently with other workers.
+    struct codegen_worker
+    {
+        std::unique_ptr< codegen_builder > bld;
+        std::shared_ptr< visitor_base > visitor;
+    };
+
+    using codegen_worker_factory = std::function< codegen_worker() >;
+
     struct module_generator : generator_base
     {
         module_generator(codegen_builder &bld, scoped_visitor_view visitor)
@@ -39,6 +50,20 @@ namespace vast::cg {
 
         void finalize();
         void emit_data_layout();
+
+        // Emits bodies of collected function definitions using up to `jobs`
+        // workers created by `factory`.
+        void emit_definitions(
+            std::vector< deferred_definition > definitions,
+            unsigned jobs, const codegen_worker_factory &factory
+        );
+
+        // Emits bodies of collected function definitions one at a time,
+        // `emitted` is invoked right after a body is generated.
+        void emit_definitions(
+            std::vector< deferred_definition > definitions,
+            llvm::function_ref< void(vast_function) > emitted
+        );
     };
 
 } // namespace vast::cg
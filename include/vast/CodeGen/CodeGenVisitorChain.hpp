@@ -0,0 +1,174 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/CodeGen/CodeGenVisitorBase.hpp"
+
+#include <concepts>
+#include <tuple>
+#include <type_traits>
+
+namespace vast::cg {
+
+    namespace detail {
+
+        //
+        // Queries of the visitor interface. Layers are called with qualified
+        // names, so that visitors derived from `visitor_base` are not
+        // dispatched virtually.
+        //
+        struct visit_query {
+            template< typename layer_t, typename... args_t >
+            static auto call(layer_t &layer, args_t &&... args)
+                -> decltype(layer.layer_t::visit(std::forward< args_t >(args)...))
+            {
+                return layer.layer_t::visit(std::forward< args_t >(args)...);
+            }
+        };
+
+        struct visit_prototype_query {
+            template< typename layer_t, typename... args_t >
+            static auto call(layer_t &layer, args_t &&... args)
+                -> decltype(layer.layer_t::visit_prototype(std::forward< args_t >(args)...))
+            {
+                return layer.layer_t::visit_prototype(std::forward< args_t >(args)...);
+            }
+        };
+
+        struct location_query {
+            template< typename layer_t, typename... args_t >
+            static auto call(layer_t &layer, args_t &&... args)
+                -> decltype(layer.layer_t::location(std::forward< args_t >(args)...))
+            {
+                return layer.layer_t::location(std::forward< args_t >(args)...);
+            }
+        };
+
+        struct symbol_query {
+            template< typename layer_t, typename... args_t >
+            static auto call(layer_t &layer, args_t &&... args)
+                -> decltype(layer.layer_t::symbol(std::forward< args_t >(args)...))
+            {
+                return layer.layer_t::symbol(std::forward< args_t >(args)...);
+            }
+        };
+
+    } // namespace detail
+
+    //
+    // Statically composed counterpart of `visitor_list`. Layers are resolved
+    // at compile time and stored inline, a query costs a single virtual call
+    // of the chain itself regardless of the number of layers.
+    //
+    // Layers are of two kinds:
+    //  - visitors derived from `visitor_base` are tried in order, a query
+    //    falls through to the next layer if the visitor yields nothing
+    //    (as `try_or_through_list_node` does),
+    //  - proxies take an additional `next` callable for the queries they
+    //    intercept (e.g., `type_caching_layer`), other queries pass through.
+    //
+    // The last layer has to handle every query.
+    //
+    template< typename... layers_t >
+    struct visitor_chain final : visitor_base
+    {
+        // Each factory is given the chain, which is the head visitor of the
+        // layers (see `as_layer` and `as_layer_with_list_ref`).
+        template< typename... factories_t >
+        explicit visitor_chain(factories_t &&... factories)
+            : layers(factories(static_cast< visitor_base & >(*this))...)
+        {}
+
+        operation visit(const clang_decl *decl, scope_context &scope) override {
+            return query< 0 >(detail::visit_query{}, decl, scope);
+        }
+
+        operation visit(const clang_stmt *stmt, scope_context &scope) override {
+            return query< 0 >(detail::visit_query{}, stmt, scope);
+        }
+
+        mlir_type visit(const clang_type *type, scope_context &scope) override {
+            return query< 0 >(detail::visit_query{}, type, scope);
+        }
+
+        mlir_type visit(clang_qual_type type, scope_context &scope) override {
+            return query< 0 >(detail::visit_query{}, type, scope);
+        }
+
+        std::optional< named_attr > visit(const clang_attr *attr, scope_context &scope) override {
+            return query< 0 >(detail::visit_query{}, attr, scope);
+        }
+
+        operation visit_prototype(const clang_function *decl, scope_context &scope) override {
+            return query< 0 >(detail::visit_prototype_query{}, decl, scope);
+        }
+
+        std::optional< loc_t > location(const clang_decl *decl) override {
+            return query< 0 >(detail::location_query{}, decl);
+        }
+
+        std::optional< loc_t > location(const clang_stmt *stmt) override {
+            return query< 0 >(detail::location_query{}, stmt);
+        }
+
+        std::optional< loc_t > location(const clang_expr *expr) override {
+            return query< 0 >(detail::location_query{}, expr);
+        }
+
+        std::optional< symbol_name > symbol(clang_global decl) override {
+            return query< 0 >(detail::symbol_query{}, decl);
+        }
+
+        std::optional< symbol_name > symbol(const clang_decl_ref_expr *decl) override {
+            return query< 0 >(detail::symbol_query{}, decl);
+        }
+
+        template< typename layer_t >
+        layer_t &get() { return std::get< layer_t >(layers); }
+
+      private:
+        static constexpr std::size_t size = sizeof...(layers_t);
+
+        template< std::size_t idx, typename query_t, typename... args_t >
+        auto query(query_t q, args_t &... args) {
+            using layer_t = std::tuple_element_t< idx, std::tuple< layers_t... > >;
+            auto &layer   = std::get< idx >(layers);
+
+            if constexpr (idx + 1 == size) {
+                return query_t::call(layer, args...);
+            } else {
+                auto next = [this, q] (auto &... next_args) {
+                    return this->template query< idx + 1 >(q, next_args...);
+                };
+
+                if constexpr (std::derived_from< layer_t, visitor_base >) {
+                    if (auto result = query_t::call(layer, args...)) {
+                        return result;
+                    }
+                    return next(args...);
+                } else if constexpr (requires { query_t::call(layer, args..., next); }) {
+                    return query_t::call(layer, args..., next);
+                } else {
+                    return next(args...);
+                }
+            }
+        }
+
+        std::tuple< layers_t... > layers;
+    };
+
+    template< typename layer_t, typename... args_t >
+    auto as_layer(args_t &&... args) {
+        return [&args...] (visitor_base &) {
+            return layer_t(std::forward< args_t >(args)...);
+        };
+    }
+
+    template< typename layer_t, typename... args_t >
+    auto as_layer_with_list_ref(args_t &&... args) {
+        return [&args...] (visitor_base &head) {
+            return layer_t(head, std::forward< args_t >(args)...);
+        };
+    }
+
+} // namespace vast::cg
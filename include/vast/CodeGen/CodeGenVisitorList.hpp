@@ -16,6 +16,26 @@ namespace vast::cg {
 
     struct visitor_list_node : visitor_base {
         visitor_node_ptr next;
+
+        // Queries of the next node as callables, so that layers of a
+        // `visitor_chain` can serve as nodes of a list as well.
+        auto next_visitor() {
+            return [this] (auto &&... args) {
+                return next->visit(std::forward< decltype(args) >(args)...);
+            };
+        }
+
+        auto next_location() {
+            return [this] (auto &&... args) {
+                return next->location(std::forward< decltype(args) >(args)...);
+            };
+        }
+
+        auto next_symbol() {
+            return [this] (auto &&... args) {
+                return next->symbol(std::forward< decltype(args) >(args)...);
+            };
+        }
     };
 
     template< typename visitor >
@@ -2,13 +2,66 @@
 
 #pragma once
 
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/AST/ASTContext.h>
+#include <llvm/ADT/DenseMap.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/CodeGen/Common.hpp"
+
 #include "vast/Util/Common.hpp"
 #include "vast/Util/DataLayout.hpp"
 
 #include "vast/Dialect/Core/CoreOps.hpp"
 
+#include <mutex>
+#include <vector>
+
 namespace vast::cg
 {
     void emit_data_layout(mcontext_t &ctx, core::module mod, const dl::DataLayoutBlueprint &dl);
 
+    //
+    // Data layout of types generated by codegen. Types are recorded by
+    // `type_caching_layer` when they are first generated, possibly by several
+    // codegen workers at once, their layout is queried from the AST context
+    // by `emit`, which is not called concurrently with codegen. Entries are
+    // keyed by the exact vast type, as layout queries are, hence qualified
+    // variants get entries of their own. Layout of forward declared types is
+    // queried once they are defined.
+    //
+    struct type_layouts
+    {
+        explicit type_layouts(const acontext_t &actx) : actx(actx) {}
+
+        void record(const clang_type *type, mlir_type vast_type);
+
+        void record(clang_qual_type type, mlir_type vast_type) {
+            record(type.getTypePtr(), vast_type);
+        }
+
+        // Attaches layout of types recorded so far to `mod`.
+        void emit(mcontext_t &mctx, core::module mod);
+
+        // Attaches to `mod` layout of recorded types that its operations
+        // refer to. Used for parts of streamed modules, so that each part
+        // does not carry the whole table.
+        void emit_referenced(mcontext_t &mctx, core::module mod);
+
+      private:
+        // Queries layout of recorded types that are defined.
+        void resolve();
+
+        const acontext_t &actx;
+
+        std::mutex mutex;
+        std::vector< std::pair< const clang_type *, mlir_type > > pending;
+
+        llvm::DenseMap< const clang_type *, clang::TypeInfo > infos;
+        dl::DataLayoutBlueprint blueprint;
+        bool changed = true;
+    };
+
 } // namespace vast::cg
@@ -8,6 +8,7 @@ VAST_RELAX_WARNINGS
 #include <clang/AST/ASTContext.h>
 #include <clang/AST/TypeLoc.h>
 #include <clang/Basic/FileEntry.h>
+#include <llvm/ADT/DenseMap.h>
 VAST_UNRELAX_WARNINGS
 
 #include "vast/CodeGen/Common.hpp"
@@ -15,40 +16,48 @@ VAST_UNRELAX_WARNINGS
 
 namespace vast::cg
 {
-    struct default_meta_gen final : meta_generator {
-        default_meta_gen(acontext_t *actx, mcontext_t *mctx)
-            : actx(actx), mctx(mctx)
-        {}
+    enum class location_granularity {
+        column,  // file, line and column of each node
+        line,    // file and line, columns are left out
+        function // location of the enclosing function (line only)
+    };
 
-        loc_t location(const clang_decl *decl) const override {
-            return location(decl->getLocation());
-        }
+    std::optional< location_granularity > parse_location_granularity(string_ref value);
 
-        loc_t location(const clang_stmt *stmt) const override {
-            return location(stmt->getBeginLoc());
-        }
+    //
+    // Many nodes share a source location, most notably ones expanded from the
+    // same macro, so locations are memoized by the raw encoding of the clang
+    // location and file names are interned once per file.
+    //
+    struct default_meta_gen final : meta_generator {
+        default_meta_gen(
+            acontext_t *actx, mcontext_t *mctx,
+            location_granularity granularity = location_granularity::column
+        )
+            : actx(actx), mctx(mctx), granularity(granularity)
+        {}
 
-        loc_t location(const clang_expr *expr) const override {
-            return location(expr->getExprLoc());
-        }
+        loc_t location(const clang_decl *decl) const override;
+        loc_t location(const clang_stmt *stmt) const override;
+        loc_t location(const clang_expr *expr) const override;
 
       private:
 
-        loc_t location(const clang::FullSourceLoc &loc) const {
-            auto file = loc.getFileEntryRef() ? loc.getFileEntryRef()->getName() : "unknown";
-            auto line = loc.getLineNumber();
-            auto col  = loc.getColumnNumber();
-            return { mlir::FileLineColLoc::get(mctx, file, line, col) };
-        }
+        loc_t location(clang::SourceLocation loc) const;
+        loc_t make_location(clang::SourceLocation loc) const;
+
+        mlir::StringAttr filename(clang::FileID id) const;
 
-        loc_t location(const clang::SourceLocation &loc) const {
-            if (loc.isValid())
-                return location(clang::FullSourceLoc(loc, actx->getSourceManager()));
-            return mlir::UnknownLoc::get(mctx);
-        }
+        const clang_decl *enclosing_function(const clang_decl *decl) const;
+        const clang_decl *enclosing_function(const clang_stmt *stmt) const;
 
         acontext_t *actx;
         mcontext_t *mctx;
+        location_granularity granularity;
+
+        mutable llvm::DenseMap< clang::SourceLocation::UIntTy, loc_t > locations;
+        mutable llvm::DenseMap< clang::FileID, mlir::StringAttr > filenames;
+        mutable llvm::DenseMap< const clang_stmt *, const clang_decl * > functions;
     };
 
 } // namespace vast::cg
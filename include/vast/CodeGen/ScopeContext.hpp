@@ -8,6 +8,7 @@ VAST_RELAX_WARNINGS
 #include <llvm/ADT/ScopedHashTable.h>
 VAST_UNRELAX_WARNINGS
 
+#include "vast/CodeGen/CodeGenPolicy.hpp"
 #include "vast/CodeGen/DefaultSymbolGenerator.hpp"
 #include "vast/Util/TypeList.hpp"
 #include "vast/Util/Symbols.hpp"
@@ -15,6 +16,7 @@ VAST_UNRELAX_WARNINGS
 #include "vast/Dialect/Core/Interfaces/SymbolInterface.hpp"
 
 #include <functional>
+#include <memory>
 #include <queue>
 
 namespace vast::cg
@@ -45,6 +47,10 @@ namespace vast::cg
         members_scope_table members;
         labels_scope_table labels;
         enum_constants_table enum_constants;
+
+        // Read-only tables consulted for symbols missing in these ones, e.g.,
+        // module symbols visible to function bodies emitted by codegen workers.
+        const symbol_tables *shared = nullptr;
     };
 
 
@@ -90,20 +96,30 @@ namespace vast::cg
             }
         }
 
+        template< typename table_t >
+        operation lookup(table_t symbol_tables::*table, const clang_named_decl *decl) const {
+            for (auto tables = &symbols; tables; tables = tables->shared) {
+                if (auto op = (tables->*table).lookup(decl)) {
+                    return op;
+                }
+            }
+            return {};
+        }
+
         operation lookup_var(const clang_named_decl  *decl) const {
-            return symbols.vars.lookup(decl);
+            return lookup(&symbol_tables::vars, decl);
         }
 
         operation lookup_fun(const clang_named_decl *decl) const {
-            return symbols.funs.lookup(decl);
+            return lookup(&symbol_tables::funs, decl);
         }
 
         operation lookup_type(const clang_named_decl *decl) const {
-            return symbols.types.lookup(decl);
+            return lookup(&symbol_tables::types, decl);
         }
 
         operation lookup_label(const clang_named_decl *decl) const {
-            return symbols.labels.lookup(decl);
+            return lookup(&symbol_tables::labels, decl);
         }
 
         bool is_declared_fun(const clang_named_decl *decl) const {
@@ -162,6 +178,8 @@ namespace vast::cg
             deferred.push_back(std::move(task));
         }
 
+        scope_context &root() { return parent ? parent->root() : *this; }
+
         std::deque< deferred_task > deferred;
 
         // links between scopes
@@ -216,6 +234,15 @@ namespace vast::cg
         virtual ~prototype_scope() = default;
     };
 
+    // Function definition whose body is emitted after the whole translation
+    // unit is visited. Unlike a deferred task, it does not capture the
+    // generator that declared the function.
+    struct deferred_definition {
+        const clang_function *decl;
+        operation fn;
+        std::shared_ptr< codegen_policy > policy;
+    };
+
     // Refers to file scope §6.2.1 of C standard
     //
     // If the declarator or type specifier that declares the identifier appears
@@ -232,6 +259,11 @@ namespace vast::cg
 
         virtual ~module_scope() = default;
 
+        // When set, function definitions are collected instead of deferred,
+        // so that their bodies can be emitted by codegen workers.
+        bool collect_definitions = false;
+        std::vector< deferred_definition > definitions;
+
         symbol_table_scope< const clang_named_decl *, operation > functions;
         symbol_table_scope< const clang_named_decl *, operation > types;
         symbol_table_scope< const clang_named_decl *, operation > globals;
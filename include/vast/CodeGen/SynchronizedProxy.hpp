@@ -0,0 +1,71 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/CodeGen/CodeGenVisitorList.hpp"
+
+#include <mutex>
+
+namespace vast::cg {
+
+    //
+    // Serializes queries of generators shared by codegen workers. Meta and
+    // symbol generators consult the source manager and the mangle context and
+    // attribute visitors evaluate constant expressions, none of which can be
+    // used from several threads at once.
+    //
+    struct synchronized_layer {
+
+        explicit synchronized_layer(std::shared_ptr< std::recursive_mutex > mutex)
+            : mutex(std::move(mutex))
+        {}
+
+        std::optional< named_attr > visit(const clang_attr *attr, scope_context &scope, auto &&next) {
+            std::lock_guard lock(*mutex);
+            return next(attr, scope);
+        }
+
+        std::optional< loc_t > location(const auto *node, auto &&next) {
+            std::lock_guard lock(*mutex);
+            return next(node);
+        }
+
+        std::optional< symbol_name > symbol(auto node, auto &&next) {
+            std::lock_guard lock(*mutex);
+            return next(node);
+        }
+
+      private:
+        std::shared_ptr< std::recursive_mutex > mutex;
+    };
+
+    struct synchronized_proxy : fallthrough_list_node, synchronized_layer {
+
+        explicit synchronized_proxy(std::shared_ptr< std::recursive_mutex > mutex)
+            : synchronized_layer(std::move(mutex))
+        {}
+
+        using fallthrough_list_node::visit;
+
+        std::optional< named_attr > visit(const clang_attr *attr, scope_context &scope) override {
+            return synchronized_layer::visit(attr, scope, next_visitor());
+        }
+
+        std::optional< loc_t > location(const clang_decl *decl) override { return locked_location(decl); }
+        std::optional< loc_t > location(const clang_stmt *stmt) override { return locked_location(stmt); }
+        std::optional< loc_t > location(const clang_expr *expr) override { return locked_location(expr); }
+
+        std::optional< symbol_name > symbol(clang_global decl) override { return locked_symbol(decl); }
+        std::optional< symbol_name > symbol(const clang_decl_ref_expr *decl) override { return locked_symbol(decl); }
+
+      private:
+        std::optional< loc_t > locked_location(const auto *node) {
+            return synchronized_layer::location(node, next_location());
+        }
+
+        std::optional< symbol_name > locked_symbol(auto node) {
+            return synchronized_layer::symbol(node, next_symbol());
+        }
+    };
+
+} // namespace vast::cg
@@ -3,40 +3,70 @@
 #pragma once
 
 #include "vast/CodeGen/CodeGenVisitorList.hpp"
+#include "vast/CodeGen/DataLayout.hpp"
 
 namespace vast::cg {
 
-    struct type_caching_proxy : fallthrough_list_node {
+    //
+    // Caches types generated by the rest of the visitors and records them to
+    // `layouts` when they are first generated. Used as a layer of a
+    // statically composed `visitor_chain`, where `next` visits the type by
+    // the remaining layers, or through `type_caching_proxy` in a visitor list.
+    //
+    struct type_caching_layer {
 
-        mlir_type visit(const clang_type *type, scope_context &scope) override {
-            return visit_type(type, cache, scope);
+        explicit type_caching_layer(std::shared_ptr< type_layouts > layouts)
+            : layouts(std::move(layouts))
+        {}
+
+        mlir_type visit(const clang_type *type, scope_context &scope, auto &&next) {
+            return visit_type(type, cache, scope, next);
         }
 
-        mlir_type visit(clang_qual_type type, scope_context &scope) override {
+        mlir_type visit(clang_qual_type type, scope_context &scope, auto &&next) {
             // Can't lookup Empty value
             if (type.isNull()) {
-                return next->visit(type, scope);
+                return next(type, scope);
             }
-            return visit_type(type, qual_cache, scope);
+            return visit_type(type, qual_cache, scope, next);
         }
 
-        mlir_type visit_type(auto type, auto& cache, scope_context& scope);
-
         llvm::DenseMap< const clang_type *, mlir_type > cache;
         llvm::DenseMap< clang_qual_type, mlir_type > qual_cache;
+
+      private:
+        std::shared_ptr< type_layouts > layouts;
+
+        mlir_type visit_type(auto type, auto &cache, scope_context &scope, auto &&next) {
+            if (auto value = cache.lookup(type)) {
+                return value;
+            }
+
+            if (auto result = next(type, scope)) {
+                cache.try_emplace(type, result);
+                layouts->record(type, result);
+                return result;
+            } else {
+                return {};
+            }
+        }
     };
 
-    mlir_type type_caching_proxy::visit_type(auto type, auto& cache, scope_context& scope) {
-        if (auto value = cache.lookup(type)) {
-            return value;
+    struct type_caching_proxy : fallthrough_list_node, type_caching_layer {
+
+        explicit type_caching_proxy(std::shared_ptr< type_layouts > layouts)
+            : type_caching_layer(std::move(layouts))
+        {}
+
+        using fallthrough_list_node::visit;
+
+        mlir_type visit(const clang_type *type, scope_context &scope) override {
+            return type_caching_layer::visit(type, scope, next_visitor());
         }
 
-        if (auto result = next->visit(type, scope)) {
-            cache.try_emplace(type, result);
-            return result;
-        } else {
-            return {};
+        mlir_type visit(clang_qual_type type, scope_context &scope) override {
+            return type_caching_layer::visit(type, scope, next_visitor());
         }
-    }
+    };
 
 } // namespace vast::cg
@@ -5,6 +5,7 @@
 #include "vast/Util/Warnings.hpp"
 
 VAST_RELAX_WARNINGS
+#include "mlir/Rewrite/FrozenRewritePatternSet.h"
 #include "mlir/Transforms/DialectConversion.h"
 VAST_UNRELAX_WARNINGS
 
@@ -12,10 +13,126 @@ VAST_UNRELAX_WARNINGS
 #include "vast/Conversion/Common/Types.hpp"
 #include "vast/Conversion/TypeConverters/LLVMTypeConverter.hpp"
 
+#include "vast/Dialect/Core/SymbolTable.hpp"
+
+#include "vast/Util/PatternProfiler.hpp"
 #include "vast/Util/TypeList.hpp"
+#include "vast/Util/WrappedPattern.hpp"
 
 namespace vast {
 
+    template< typename T >
+    concept has_skip_functions_option = requires(T a) { static_cast< bool >(a.skip_functions); };
+
+    //
+    // Operations a conversion is applied to. Function-granular passes leave
+    // isolated operations (functions) to their function-level instances and
+    // convert only the rest of the anchor.
+    //
+    static inline llvm::SmallVector< operation > conversion_roots(
+        operation anchor, bool skip_functions
+    ) {
+        if (!skip_functions) {
+            return { anchor };
+        }
+
+        llvm::SmallVector< operation > roots;
+        for (auto &region : anchor->getRegions()) {
+            for (auto &op : region.getOps()) {
+                if (!op.hasTrait< mlir::OpTrait::IsIsolatedFromAbove >()) {
+                    roots.push_back(&op);
+                }
+            }
+        }
+
+        return roots;
+    }
+
+    //
+    // Tells the active symbol table cache that a pattern changed symbols.
+    // Dialect conversion notifies its listener only about committed changes,
+    // until then cached tables would miss symbols inserted or renamed by
+    // previously applied patterns, and changes of rejected patterns are rolled
+    // back without notifications. The cache is therefore bypassed until the
+    // conversion finishes (see `symbol_table_cache::notify_uncommitted_changes`).
+    //
+    struct symbol_observing_pattern : util::wrapped_pattern
+    {
+        struct observer : mlir::RewriterBase::ForwardingListener
+        {
+            observer(mlir::OpBuilder::Listener *listener, core::symbol_table_cache &cache)
+                : mlir::RewriterBase::ForwardingListener(listener), cache(cache)
+            {}
+
+            void notifyOperationInserted(
+                operation op, mlir::OpBuilder::InsertPoint previous
+            ) override {
+                ForwardingListener::notifyOperationInserted(op, previous);
+                observe(op);
+            }
+
+            void notifyOperationModified(operation op) override {
+                ForwardingListener::notifyOperationModified(op);
+                observe(op);
+            }
+
+            void notifyOperationErased(operation op) override {
+                observe(op);
+                ForwardingListener::notifyOperationErased(op);
+            }
+
+            void observe(operation op) {
+                if (mlir::isa< core::symbol, core::SymbolTableOpInterface >(op)) {
+                    cache.notify_uncommitted_changes();
+                }
+            }
+
+            core::symbol_table_cache &cache;
+        };
+
+        using util::wrapped_pattern::wrapped_pattern;
+
+        logical_result matchAndRewrite(
+            operation op, mlir::PatternRewriter &rewriter
+        ) const override {
+            auto cache    = core::symbol_table_cache::active();
+            auto listener = rewriter.getListener();
+            if (!cache || !listener) {
+                return pattern->matchAndRewrite(op, rewriter);
+            }
+
+            observer notify(listener, *cache);
+            rewriter.setListener(&notify);
+            auto result = pattern->matchAndRewrite(op, rewriter);
+            rewriter.setListener(listener);
+            return result;
+        }
+    };
+
+    // Patterns whose root and generated operations are neither symbols nor
+    // symbol tables cannot change what symbol lookups see.
+    static inline bool might_change_symbols(const mlir::RewritePattern &pattern) {
+        auto is_symbolic = [] (mlir::OperationName name) {
+            return name.hasInterface< core::symbol >()
+                || name.hasInterface< core::SymbolTableOpInterface >();
+        };
+
+        auto root = pattern.getRootKind();
+        if (!root || is_symbolic(*root)) {
+            return true;
+        }
+
+        return llvm::any_of(pattern.getGeneratedOps(), is_symbolic);
+    }
+
+    static inline void observe_symbol_changes(mlir::RewritePatternSet &patterns) {
+        for (auto &pattern : patterns.getNativePatterns()) {
+            if (might_change_symbols(*pattern)) {
+                pattern = util::wrapped_pattern::wrap< symbol_observing_pattern >(std::move(pattern));
+            }
+        }
+    }
+
     template< typename self >
     struct populate_patterns
     {
@@ -47,10 +164,57 @@ namespace vast {
 
         auto &underlying() { return static_cast<self &>(*this); }
 
-        auto apply_conversions(auto &&cfg) {
-            return mlir::applyPartialConversion(
-                underlying().getOperation(), cfg.target, std::move(cfg.patterns)
+        bool converts_functions_separately() {
+            if constexpr (has_skip_functions_option< self >) {
+                return underlying().skip_functions;
+            } else {
+                return false;
+            }
+        }
+
+        // Profile of the pass if pattern profiling is enabled. Patterns may be
+        // frozen in `initialize`, before the pass has an operation to run on.
+        util::pattern_profile *pattern_profile(mcontext_t *mctx) {
+            return util::active_pattern_profile(mctx, underlying().getArgument());
+        }
+
+        mlir::FrozenRewritePatternSet freeze_patterns(mlir::RewritePatternSet patterns) {
+            observe_symbol_changes(patterns);
+            if (auto profile = pattern_profile(patterns.getContext())) {
+                util::profile_patterns(patterns, *profile);
+            }
+            return mlir::FrozenRewritePatternSet(std::move(patterns));
+        }
+
+        logical_result apply_conversions(
+            const conversion_target &target, const mlir::FrozenRewritePatternSet &patterns
+        ) {
+            auto cache = core::symbol_table_cache::active();
+
+            mlir::ConversionConfig config;
+            // keep the active symbol table cache in sync with committed changes
+            config.listener = cache;
+            auto roots = conversion_roots(
+                underlying().getOperation(), converts_functions_separately()
             );
+
+            auto apply = [&] {
+                if (auto profile = pattern_profile(&target.getContext())) {
+                    auto timer = profile->time_conversion();
+                    return mlir::applyPartialConversion(roots, target, patterns, config);
+                }
+                return mlir::applyPartialConversion(roots, target, patterns, config);
+            };
+
+            auto result = apply();
+            if (cache) {
+                cache->notify_conversion_finished(result);
+            }
+            return result;
+        }
+
+        logical_result apply_conversions(auto &&cfg) {
+            return apply_conversions(cfg.target, freeze_patterns(std::move(cfg.patterns)));
         }
 
         template< typename... conversions >
@@ -68,6 +232,11 @@ namespace vast {
     template< typename T >
     concept has_setup = requires(T a) { a.setup_pass(); };
 
+    // Passes whose patterns and target do not capture state of a particular
+    // run (e.g., the converted operation) can opt into frozen configurations.
+    template< typename T >
+    concept has_frozen_config = requires { requires T::freeze_config; };
+
     using rewrite_pattern_set = mlir::RewritePatternSet;
 
     // base configuration class
@@ -119,6 +288,43 @@ namespace vast {
         using base_type::getOperation;
         using base_type::signalPassFailure;
 
+        using statistic = mlir::Pass::Statistic;
+
+        statistic symbol_lookups{
+            this, "symbol-lookups", "Number of symbol table lookups"
+        };
+
+        statistic symbol_table_materializations{
+            this, "symbol-table-materializations", "Number of symbol tables built from IR"
+        };
+
+        statistic indexed_symbols{
+            this, "indexed-symbols", "Number of symbols inserted into cached symbol tables"
+        };
+
+        //
+        // Patterns and conversion target of passes that opt in with
+        // `freeze_config`, built once in `initialize` and shared by all runs of
+        // the pass instance and its clones.
+        //
+        struct frozen_config {
+            frozen_config(conversion_target target, mlir::FrozenRewritePatternSet patterns)
+                : target(std::move(target)), patterns(std::move(patterns))
+            {}
+
+            conversion_target target;
+            mlir::FrozenRewritePatternSet patterns;
+        };
+
+        std::shared_ptr< const frozen_config > frozen;
+
+        ConversionPassMixinBase() = default;
+
+        // statistics are not copyable, the copy gets fresh counters
+        ConversionPassMixinBase(const ConversionPassMixinBase &other)
+            : base_type(other), populate_patterns< derived >(other), frozen(other.frozen)
+        {}
+
         auto &self() { return static_cast< derived & >(*this); }
 
         template< typename pattern >
@@ -126,17 +332,64 @@ namespace vast {
             cfg.template add_pattern< pattern >();
         }
 
-        logical_result run_on_operation(auto &&cfg) {
-            if (mlir::failed(patterns::apply_conversions(std::move(cfg)))) {
+        logical_result run_on_operation(
+            const conversion_target &target, const mlir::FrozenRewritePatternSet &frozen_patterns
+        ) {
+            if (mlir::failed(patterns::apply_conversions(target, frozen_patterns))) {
                 return signalPassFailure(), mlir::failure();
             }
             return mlir::success();
         }
 
-        logical_result run_on_operation() {
+        logical_result run_on_operation(auto &&cfg) {
+            return run_on_operation(
+                cfg.target, patterns::freeze_patterns(std::move(cfg.patterns))
+            );
+        }
+
+        void freeze_config() {
             auto cfg = self().make_config();
             self().populate_conversions(cfg);
-            return run_on_operation(std::move(cfg));
+            frozen = std::make_shared< const frozen_config >(
+                std::move(cfg.target), patterns::freeze_patterns(std::move(cfg.patterns))
+            );
+        }
+
+        logical_result run_on_operation() {
+            if constexpr (has_frozen_config< derived >) {
+                // clones that do not share the configuration build their own
+                if (!frozen) {
+                    freeze_config();
+                }
+                return run_on_operation(frozen->target, frozen->patterns);
+            } else {
+                auto cfg = self().make_config();
+                self().populate_conversions(cfg);
+                return run_on_operation(std::move(cfg));
+            }
+        }
+
+        mlir::LogicalResult initialize(mcontext_t *) override {
+            if constexpr (has_frozen_config< derived >) {
+                freeze_config();
+            }
+            return mlir::success();
+        }
+
+        // Symbol tables are materialized at most once per pass run and then
+        // maintained by the cache instead of being rebuilt on every lookup.
+        logical_result run_with_symbol_table_cache() {
+            core::symbol_table_cache cache;
+            auto result = [&] {
+                core::symbol_table_cache::scope guard(cache);
+                return self().run_on_operation();
+            }();
+
+            const auto &stats = cache.stats();
+            symbol_lookups += stats.lookups;
+            symbol_table_materializations += stats.materializations;
+            indexed_symbols += stats.indexed_symbols;
+            return result;
         }
 
 
@@ -145,7 +398,7 @@ namespace vast {
                 self().setup_pass();
             }
 
-            if (mlir::succeeded(self().run_on_operation())) {
+            if (mlir::succeeded(run_with_symbol_table_cache())) {
                 if constexpr (has_run_after_conversion< derived >) {
                     self().run_after_conversion();
                 }
@@ -166,6 +419,10 @@ namespace vast {
     //
     // `static void populate_conversions(base_conversion_config &cfg)`
     //
+    // Patterns and target are built for each run. Passes which do not capture
+    // per-run state in them can declare `static constexpr bool freeze_config = true`
+    // to build them once per pass instance in `initialize`.
+    //
     // Example usage:
     //
     // struct ExamplePass : ConversionPassMixin<ExamplePass, ExamplePassBase> {
@@ -198,6 +455,16 @@ namespace vast {
     {
         std::shared_ptr< type_converter > tc;
 
+        TypeConvertingConversionPassMixin() = default;
+
+        // Patterns refer to the type converter, each clone builds its own
+        // converter and patterns on its first run.
+        TypeConvertingConversionPassMixin(const TypeConvertingConversionPassMixin &other)
+            : ConversionPassMixinBase< derived, base >(other)
+        {
+            this->frozen.reset();
+        }
+
         type_converting_conversion_config< type_converter > make_config() {
             auto &ctx = this->getContext();
             tc = std::make_shared< type_converter >(ctx);
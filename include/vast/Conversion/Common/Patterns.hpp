@@ -267,14 +267,14 @@ namespace vast {
         static void legalize(conversion_target &trg) { trg.addIllegalOp< op_t >(); }
     };
 
-    template< typename op_t >
+    template< typename op_t, typename rewriter_t = conversion_rewriter >
     struct match_and_rewrite_state_capture
     {
         using adaptor_t = typename op_t::Adaptor;
 
         op_t op;
         adaptor_t operands;
-        conversion_rewriter &rewriter;
+        rewriter_t &rewriter;
     };
 
 } // namespace vast
@@ -5,6 +5,7 @@
 #include "vast/Util/Warnings.hpp"
 
 VAST_RELAX_WARNINGS
+#include <llvm/ADT/MapVector.h>
 #include <mlir/Dialect/DLTI/DLTI.h>
 #include <mlir/Dialect/LLVMIR/LLVMDialect.h>
 #include <mlir/IR/BuiltinDialect.h>
@@ -16,6 +17,8 @@ VAST_RELAX_WARNINGS
 #include <mlir/Interfaces/DataLayoutInterfaces.h>
 VAST_UNRELAX_WARNINGS
 
+#include "vast/Dialect/Core/CoreAttributes.hpp"
+
 #include "vast/Util/Common.hpp"
 #include "vast/Util/DataLayout.hpp"
 
@@ -43,7 +46,7 @@ namespace vast::conv::tc {
                 return;
             }
 
-            entries.try_emplace(type, attr);
+            entries.insert({ type, attr });
         }
 
         mlir_attr wrap(mcontext_t &mctx) const {
@@ -57,7 +60,8 @@ namespace vast::conv::tc {
             return mlir::DataLayoutSpecAttr::get(&mctx, flattened);
         }
 
-        llvm::DenseMap< mlir_type, mlir_attr > entries;
+        // Entries are emitted in the order of insertion.
+        llvm::MapVector< mlir_type, mlir_attr > entries;
     };
 
     // Each dialect can have its own encoding of data layout entries.
@@ -127,22 +131,65 @@ namespace vast::conv::tc {
         return vast_dl_entry_helper::make(mctx, trg_type, old_entry);
     }
 
+    // Entries of VAST types are kept in `core::DataLayoutSpecAttr` until
+    // some type is converted to a dialect with its own encoding (LLVM), then
+    // the layout is converted to `DLTI`.
+    static inline mlir_attr convert_data_layout(auto &type_converter, auto &&entries) {
+        auto &mctx = type_converter.get_context();
+
+        data_layout_blueprint bp;
+        llvm::DenseMap< mlir_type, core::type_layout > vast_entries;
+        std::vector< mlir_type > vast_order;
+
+        for (const auto &e : entries) {
+            auto dl_entry = dl::DLEntry(e);
+            auto trg_type = type_converter.convert_type_to_type(dl_entry.type);
+            // What does this imply?
+            if (!trg_type) {
+                continue;
+            }
+
+            auto trg_dialect = &trg_type->getDialect();
+            if (mlir::isa< mlir::BuiltinDialect, mlir::LLVM::LLVMDialect >(trg_dialect)) {
+                bp.add(*trg_type, make_entry(*trg_type, dl_entry));
+                continue;
+            }
+
+            auto layout = dl_entry.layout();
+            layout.type = *trg_type;
+            auto [it, inserted] = vast_entries.try_emplace(*trg_type, layout);
+            VAST_CHECK(
+                inserted || it->second == layout,
+                "New dl entry for type: {0} would make dl incosistent.", *trg_type
+            );
+            if (inserted) {
+                vast_order.push_back(*trg_type);
+            }
+        }
+
+        if (bp.entries.empty()) {
+            std::vector< core::type_layout > layouts;
+            layouts.reserve(vast_order.size());
+            for (auto type : vast_order) {
+                layouts.push_back(vast_entries.at(type));
+            }
+            return core::DataLayoutSpecAttr::get(&mctx, layouts);
+        }
+
+        for (auto type : vast_order) {
+            bp.add(type, make_entry(type, dl::DLEntry(vast_entries.at(type))));
+        }
+        return bp.wrap(mctx);
+    }
+
     // This is leaky abstraction of our data layout implementation, so maybe
     // move this to `Util/DataLayout.hpp`?
     static inline auto convert_data_layout_attrs(auto &type_converter) {
         return [&type_converter](mlir::DataLayoutSpecInterface spec) {
-            data_layout_blueprint bp;
-            for (auto e : spec.getEntries()) {
-                auto dl_entry = dl::DLEntry(e);
-                auto trg_type = type_converter.convert_type_to_type(dl_entry.type);
-                // What does this imply?
-                if (!trg_type) {
-                    continue;
-                }
-
-                bp.add(*trg_type, make_entry(*trg_type, std::move(dl_entry)));
+            if (auto table = mlir::dyn_cast< core::DataLayoutSpecAttr >(spec)) {
+                return convert_data_layout(type_converter, table.getLayouts());
             }
-            return bp.wrap(type_converter.get_context());
+            return convert_data_layout(type_converter, spec.getEntries());
         };
     }
 
@@ -16,6 +16,7 @@ VAST_UNRELAX_WARNINGS
 
 #include "vast/Dialect/Core/CoreOps.hpp"
 
+#include "vast/Dialect/HighLevel/HighLevelRecordLayout.hpp"
 #include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
 #include "vast/Dialect/HighLevel/HighLevelUtils.hpp"
 #include "vast/Util/Maybe.hpp"
@@ -126,8 +127,18 @@ namespace vast::conv::tc {
             };
         }
 
-        llvm_type_converter(mcontext_t *mctx, const mlir::DataLayoutAnalysis &dl, lower_to_llvm_options opts, operation op)
-            : base(mctx, opts, &dl)
+        // Operation from which record definitions are looked up.
+        operation scope;
+
+        // Definitions and fields of records, shared with other users of
+        // the module's record layouts.
+        hl::record_layout_cache &layouts;
+
+        llvm_type_converter(
+            mcontext_t *mctx, const mlir::DataLayoutAnalysis &dl, lower_to_llvm_options opts,
+            operation op, hl::record_layout_cache &layouts
+        )
+            : base(mctx, opts, &dl), scope(op), layouts(layouts)
         {
             addConversion([&](hl::LabelType t) { return t; });
             addConversion([&](hl::LValueType t) { return this->convert_lvalue_type(t); });
@@ -142,7 +153,7 @@ namespace vast::conv::tc {
                 return LLVM::LLVMVoidType::get(t.getContext());
             });
 
-            addConversion([op, this](hl::RecordType t, mlir::SmallVectorImpl< mlir_type > &out) {
+            addConversion([this](hl::RecordType t, mlir::SmallVectorImpl< mlir_type > &out) {
                 auto core = mlir::LLVM::LLVMStructType::getIdentified(
                     t.getContext(), t.getName()
                 );
@@ -151,7 +162,7 @@ namespace vast::conv::tc {
                 if (core.isOpaque() && !llvm::count(stack, t)) {
                     stack.push_back(t);
                     auto pop = llvm::make_scope_exit([&]{ stack.pop_back(); });
-                    if (auto body = convert_field_types(op, t)) {
+                    if (auto body = convert_field_types(scope, t)) {
                         [[maybe_unused]] auto status = core.setBody(*body, false);
                         VAST_ASSERT(mlir::succeeded(status));
                     }
@@ -186,6 +197,10 @@ namespace vast::conv::tc {
         llvm_type_converter &operator=(const llvm_type_converter &) = delete;
         llvm_type_converter &operator=(llvm_type_converter &&)      = delete;
 
+        // Allows a single converter to be shared by conversions of operations
+        // from different symbol scopes.
+        void set_scope(operation op) { scope = op; }
+
 
         maybe_types_t do_conversion(mlir_type t) const {
             types_t out;
@@ -302,22 +317,20 @@ namespace vast::conv::tc {
                 return {};
             }
 
-            auto ts = core::symbol_table::lookup< core::type_symbol >(op, t.getName());
-            VAST_CHECK(ts, "Record type {0} not present in the symbol table.", t.getName());
-            auto def = mlir::dyn_cast_if_present< core::aggregate_interface >(ts);
+            auto layout = layouts.lookup(t, op);
 
             // Nothing found, leave the structure opaque.
-            if (!def) {
+            if (!layout) {
                 return {};
             }
 
-            if (auto union_decl = mlir::dyn_cast< hl::UnionDeclOp >(*def)) {
-                auto dla    = mlir::DataLayoutAnalysis(union_decl);
-                auto dl     = dla.getAtOrAbove(union_decl);
-                auto fields = union_lowering{ dl, union_decl }.compute_lowering().fields;
+            if (layout->is_union) {
+                auto union_decl = mlir::cast< hl::UnionDeclOp >(layout->def.getOperation());
+                const auto &dl  = this->getDataLayoutAnalysis()->getAtOrAbove(union_decl);
+                auto fields     = union_lowering{ dl, union_decl }.compute_lowering().fields;
                 return { union_lowering::final_fields(std::move(fields)) };
             } else {
-                return { def.getFieldTypes() };
+                return { layout->field_types() };
             }
         }
 
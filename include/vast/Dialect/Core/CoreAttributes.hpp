@@ -9,8 +9,10 @@ VAST_RELAX_WARNINGS
 #include <llvm/Support/Locale.h>
 #include <mlir/IR/BuiltinAttributes.h>
 #include <mlir/Interfaces/CallInterfaces.h>
+#include <mlir/Interfaces/DataLayoutInterfaces.h>
 VAST_UNRELAX_WARNINGS
 
+#include "vast/Dialect/Core/CoreDataLayout.hpp"
 #include "vast/Dialect/Core/CoreDialect.hpp"
 #include "vast/Dialect/Core/CoreTraits.hpp"
 
@@ -0,0 +1,75 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/Hashing.h>
+#include <mlir/IR/AttributeSupport.h>
+#include <mlir/IR/Types.h>
+VAST_UNRELAX_WARNINGS
+
+#include <cstdint>
+
+namespace vast::core {
+
+    // Data layout of a single type as computed by the frontend.
+    struct type_layout
+    {
+        mlir::Type type;
+        std::uint32_t bw        = 0;
+        std::uint32_t abi_align = 0;
+
+        bool operator==(const type_layout &) const = default;
+    };
+
+    inline llvm::hash_code hash_value(const type_layout &entry) {
+        return llvm::hash_combine(entry.type, entry.bw, entry.abi_align);
+    }
+
+    namespace detail {
+
+        //
+        // Storage of `core::DataLayoutSpecAttr`. Besides the entries it keeps
+        // an open addressing table of entry indices keyed by type, so that
+        // queries do not scan the entries, and the list of type kinds present
+        // to answer `getSpecForType` without touching the entries. Both are
+        // allocated in the context, as storages are never destroyed.
+        //
+        struct DataLayoutSpecAttrStorage : mlir::AttributeStorage
+        {
+            using KeyTy = llvm::ArrayRef< type_layout >;
+
+            DataLayoutSpecAttrStorage(
+                llvm::ArrayRef< type_layout > layouts,
+                llvm::ArrayRef< std::uint32_t > buckets,
+                llvm::ArrayRef< mlir::TypeID > kinds
+            )
+                : layouts(layouts), buckets(buckets), kinds(kinds)
+            {}
+
+            bool operator==(const KeyTy &key) const { return key == layouts; }
+
+            static llvm::hash_code hashKey(const KeyTy &key) {
+                return llvm::hash_combine_range(key.begin(), key.end());
+            }
+
+            static DataLayoutSpecAttrStorage *construct(
+                mlir::AttributeStorageAllocator &allocator, const KeyTy &key
+            );
+
+            const type_layout *lookup(mlir::Type type) const;
+
+            bool contains_kind(mlir::TypeID kind) const;
+
+            llvm::ArrayRef< type_layout > layouts;
+            // Index of the entry + 1, zero marks an empty bucket.
+            llvm::ArrayRef< std::uint32_t > buckets;
+            llvm::ArrayRef< mlir::TypeID > kinds;
+        };
+
+    } // namespace detail
+
+} // namespace vast::core
@@ -7,6 +7,7 @@
 VAST_RELAX_WARNINGS
 #include <llvm/ADT/DenseMap.h>
 #include <mlir/IR/OpDefinition.h>
+#include <mlir/IR/PatternMatch.h>
 VAST_UNRELAX_WARNINGS
 
 #include "vast/Dialect/Core/CoreTraits.hpp"
@@ -140,6 +141,8 @@ namespace vast::core {
         template< symbol_op_interface symbol_kind >
         [[nodiscard]] operation lookup(string_ref symbol) const;
 
+        [[nodiscard]] operation lookup(symbol_kind kind, string_ref symbol) const;
+
         template< util::flat_list symbols_list >
         void try_insert(operation op) {
             if constexpr ( symbols_list::empty ) {
@@ -156,12 +159,36 @@ namespace vast::core {
             try_insert< util::flatten< symbol_lists > >(op);
         }
 
+        //
+        // Inserts symbol under the first recognized symbol kind it implements.
+        // Returns false if the symbol is not recognized by this table.
+        //
+        bool try_insert_dynamic(operation op);
+
+        //
+        // Removes symbol `op` registered under `name`. Returns false if the
+        // symbol was not present in the table.
+        //
+        bool erase(operation op, string_ref name);
+
         bool can_hold_symbol_kind(symbol_kind kind) const {
             return symbol_tables.contains(kind);
         }
 
         operation get_defining_operation() { return symbol_table_op; }
 
+        std::size_t size() const;
+
+        void for_each_symbol(auto &&yield) const {
+            for (const auto &[kind, table] : symbol_tables) {
+                for (const auto &[name, ops] : table) {
+                    for (auto op : ops) {
+                        yield(name, op);
+                    }
+                }
+            }
+        }
+
       protected:
 
         template< util::flat_list symbols_list >
@@ -174,6 +201,7 @@ namespace vast::core {
                     get_symbol_kind< typename symbols_list::head >,
                     single_symbol_kind_table{}
                 );
+                ordered_kinds.push_back(get_symbol_kind< typename symbols_list::head >);
 
                 // continue with the rest of the recognized symbols
                 setup_symbol_tables< typename symbols_list::tail >();
@@ -198,11 +226,104 @@ namespace vast::core {
 
         operation symbol_table_op;
         llvm::DenseMap< symbol_kind, single_symbol_kind_table > symbol_tables;
+
+        // recognized kinds in the order of recognized symbols lists,
+        // used to resolve the kind of dynamically inserted symbols
+        llvm::SmallVector< symbol_kind > ordered_kinds;
+    };
+
+    //
+    // Cache of materialized symbol tables.
+    //
+    // While a cache is active (see `symbol_table_cache::scope`), static
+    // `symbol_table::lookup` queries reuse tables materialized by previous
+    // lookups instead of rebuilding them from the IR. The cache is a rewriter
+    // listener, notifications update the table owning the symbol in place.
+    // A table that cannot be updated in place (e.g., a nested symbol table
+    // was inserted into it) is dropped and materialized again by the next
+    // lookup. Lookups trust the tables, so a miss never rebuilds them.
+    //
+    // Dialect conversion notifies its listener only about committed changes,
+    // rejected changes are rolled back silently. The cache therefore never
+    // records changes of running patterns: once a pattern touches a symbol
+    // (see `observe_symbol_changes` in `vast/Conversion/Common/Mixins.hpp`),
+    // lookups bypass the cache until the conversion finishes. A failed
+    // conversion drops all tables, a successful one has already updated them
+    // through the committed notifications.
+    //
+    struct symbol_table_cache : mlir::RewriterBase::Listener
+    {
+        struct statistics {
+            std::size_t lookups = 0;
+            std::size_t materializations = 0;
+            std::size_t indexed_symbols = 0;
+        };
+
+        //
+        // RAII guard that makes the cache active on the current thread.
+        //
+        struct scope {
+            explicit scope(symbol_table_cache &cache);
+            ~scope();
+
+            scope(const scope &) = delete;
+            scope &operator=(const scope &) = delete;
+
+          private:
+            symbol_table_cache *previous;
+        };
+
+        static symbol_table_cache *active();
+
+        [[nodiscard]] operation lookup(operation from, symbol_kind kind, string_ref symbol);
+
+        void invalidate() { tables.clear(); indexed.clear(); }
+
+        // Drops the table defined by `table_op`, it is materialized again by
+        // the next lookup that reaches it.
+        void invalidate(operation table_op);
+
+        // Marks that a running conversion changed symbols or symbol tables,
+        // lookups walk the IR until `notify_conversion_finished`.
+        void notify_uncommitted_changes() { uncommitted = true; }
+
+        void notify_conversion_finished(logical_result result) {
+            if (mlir::failed(result)) {
+                invalidate();
+            }
+            uncommitted = false;
+        }
+
+        const statistics &stats() const { return counters; }
+
+        void notifyOperationInserted(operation op, mlir::OpBuilder::InsertPoint previous) override;
+        void notifyOperationErased(operation op) override;
+        void notifyOperationModified(operation op) override;
+
+      private:
+        symbol_table *materialize(operation table_op);
+
+        void index(symbol_table &table);
+        void unindex(operation op);
+        void reindex(operation op);
+
+        llvm::DenseMap< operation, symbol_table > tables;
+
+        // reverse index: symbol -> (owning table, name the symbol is registered under)
+        llvm::DenseMap< operation, std::pair< operation, string_ref > > indexed;
+
+        statistics counters;
+
+        bool uncommitted = false;
     };
 
 
     template< symbol_op_interface symbol_kind >
     operation symbol_table::lookup(operation from, string_ref symbol) {
+        if (auto cache = symbol_table_cache::active()) {
+            return cache->lookup(from, get_symbol_kind< symbol_kind >, symbol);
+        }
+
         auto table = get_effective_symbol_table_for< symbol_kind >(from);
         VAST_CHECK(table, "No effective symbol table found.");
 
@@ -222,19 +343,16 @@ namespace vast::core {
 
     template< symbol_op_interface symbol_kind >
     operation symbol_table::lookup(string_ref symbol_name) const {
-        auto it = symbol_tables.find(get_symbol_kind< symbol_kind >);
-        if (it == symbol_tables.end()) {
-            return {};
-        }
+        return lookup(get_symbol_kind< symbol_kind >, symbol_name);
+    }
 
-        auto &table = it->second;
-        auto symbol = table.find(symbol_name);
-        if (symbol == table.end()) {
-            return {};
-        }
+    // Returns the closest operation at or above `from` with a symbol table
+    // that can hold symbols of `kind`.
+    operation get_effective_symbol_table_op_for(operation from, symbol_kind kind);
 
-        // FIXME: resolve redeclarations
-        return symbol->second.back();
+    template< symbol_op_interface symbol_kind >
+    operation get_effective_symbol_table_op_for(operation from) {
+        return get_effective_symbol_table_op_for(from, get_symbol_kind< symbol_kind >);
     }
 
     std::optional< symbol_table > get_effective_symbol_table_for(operation from, symbol_kind kind);
@@ -0,0 +1,84 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/DenseMap.h>
+#include <mlir/Interfaces/DataLayoutInterfaces.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
+#include "vast/Dialect/Core/Interfaces/SymbolInterface.hpp"
+
+#include "vast/Util/Common.hpp"
+
+#include <gap/coro/generator.hpp>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace vast::hl {
+
+    struct field_layout {
+        mlir_type type;
+        std::size_t offset; // in bits, from the start of the record, see `has_field_offsets`
+        std::size_t size;   // in bits
+        std::size_t align;  // ABI alignment in bytes
+    };
+
+    struct record_layout {
+        core::aggregate_interface def;
+        std::vector< field_layout > fields;
+        std::size_t size;   // in bits
+        std::size_t align;  // ABI alignment in bytes
+        bool is_union;
+
+        // Records with bitfields or `packed` and `aligned` attributes take
+        // their size and alignment from the data layout given by the frontend,
+        // their fields are laid out one after another.
+        bool has_field_offsets;
+
+        gap::generator< mlir_type > field_types() const {
+            for (const auto &field : fields) {
+                co_yield field.type;
+            }
+        }
+    };
+
+    //
+    // Layouts of records computed once from the data layout of their
+    // definition. Definitions are resolved in the scope of the querying
+    // operation, as local declarations might shadow module level ones, and
+    // memoized per symbol table the scope resolves types in, layouts are
+    // shared by all scopes resolving to the same definition. Accesses to the
+    // cache are synchronized, so that it can be shared by parallel
+    // classifications of function signatures.
+    //
+    // The cache is an analysis of the module (`getAnalysis`), so that passes
+    // share it for as long as it is preserved, and it is dropped together
+    // with definitions it refers to.
+    //
+    struct record_layout_cache {
+        record_layout_cache() = default;
+        explicit record_layout_cache(operation /* root */) {}
+
+        record_layout_cache(const record_layout_cache &) = delete;
+        record_layout_cache &operator=(const record_layout_cache &) = delete;
+
+        // Returns `nullptr` if the symbol of `type` is not an aggregate.
+        const record_layout *lookup(hl::RecordType type, operation from);
+
+        const record_layout &get(hl::RecordType type, operation from);
+
+      private:
+        const record_layout *compute(core::aggregate_interface def);
+
+        std::mutex mutex;
+        llvm::DenseMap< std::pair< mlir_type, operation >, const record_layout * > resolved;
+        llvm::DenseMap< operation, std::unique_ptr< record_layout > > layouts;
+    };
+
+} // namespace vast::hl
@@ -24,6 +24,8 @@ namespace vast::hl {
 
     std::unique_ptr< mlir::Pass > createUDEPass();
 
+    std::unique_ptr< mlir::Pass > createPruneDataLayoutPass();
+
     std::unique_ptr< mlir::Pass > createLowerTypeDefsPass();
 
     std::unique_ptr< mlir::Pass > createLowerElaboratedTypesPass();
@@ -45,6 +47,8 @@ namespace vast::hl {
 
         pipeline_step_ptr simplify();
 
+        pipeline_step_ptr prune_data_layout();
+
         pipeline_step_ptr stdtypes();
     } // namespace pipeline
 
@@ -53,6 +53,10 @@ namespace vast::cc {
 
         void EndSourceFileAction() override;
 
+        // Input file with already generated module (`.mlir` or `.mlirbc`)
+        // skips clang parsing and codegen entirely.
+        void execute_mlir_input_action();
+
     private:
         friend struct vast_consumer;
 
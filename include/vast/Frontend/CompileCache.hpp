@@ -0,0 +1,90 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/Basic/SourceManager.h>
+#include <mlir/Pass/PassManager.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Frontend/Options.hpp"
+#include "vast/Util/Common.hpp"
+
+#include <filesystem>
+
+namespace vast::cc {
+
+    //
+    // Content-addressed on-disk cache of modules produced by the vast pipeline.
+    //
+    // Each entry is a MLIR bytecode of the module after some prefix of the
+    // scheduled pipeline. The key of the entry is derived from the input key
+    // (preprocessed translation unit, cc1 invocation, vast options) and the
+    // textual form of the pipeline prefix, so pipelines that share a prefix
+    // share cached steps as well.
+    //
+    // Entries are written atomically (temporary file and rename) and reading
+    // an entry evicted by a concurrent job is reported as a miss, so a single
+    // directory can be used by parallel builds. Least recently used entries
+    // are evicted when the directory exceeds its size limit.
+    //
+    struct compile_cache
+    {
+        using key_t = std::string;
+
+        // Default size limit of the cache directory in megabytes.
+        static constexpr std::uint64_t default_size_limit = 1024;
+
+        compile_cache(std::filesystem::path dir, std::uint64_t size_limit)
+            : dir(std::move(dir)), size_limit(size_limit)
+        {}
+
+        // Returns cache configured by `-vast-cache-dir` or `std::nullopt` if
+        // caching is disabled.
+        static std::optional< compile_cache > from_args(const vast_args &vargs);
+
+        // Hash of everything the generated module depends on except for the pipeline.
+        static key_t input_key(
+            const clang::SourceManager &src_mgr, const invocation_options &invocation,
+            const vast_args &vargs
+        );
+
+        // Key of a module produced by running `steps` on input given by `input`.
+        static key_t step_key(const key_t &input, llvm::ArrayRef< std::string > steps);
+
+        owning_mlir_module_ref load(const key_t &key, mcontext_t &mctx) const;
+
+        void store(const key_t &key, mlir_module mod) const;
+
+        // Removes least recently used entries until the cache fits its size limit.
+        void evict() const;
+
+      private:
+        std::filesystem::path entry(const key_t &key) const;
+
+        std::filesystem::path dir;
+        std::uint64_t size_limit;
+    };
+
+    // Textual form of top-level steps of the pass manager.
+    std::vector< std::string > pipeline_steps(mlir::OpPassManager &pm);
+
+    // Fills `pm` with steps in the textual form produced by `pipeline_steps`.
+    logical_result parse_pipeline_steps(
+        llvm::ArrayRef< std::string > steps, mlir::OpPassManager &pm
+    );
+
+    //
+    // Fills `pm` with `steps` that follow the first `done` ones, each of them
+    // followed by a pass that stores the module into the cache. The pass
+    // manager merges adjacent nested pipelines, the store keeps them apart, so
+    // each entry is the module after exactly the prefix its key is built from.
+    //
+    logical_result schedule_cached_steps(
+        const compile_cache &cache, const compile_cache::key_t &input,
+        llvm::ArrayRef< std::string > steps, std::size_t done, mlir::OpPassManager &pm
+    );
+
+} // namespace vast::cc
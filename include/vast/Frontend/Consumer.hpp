@@ -9,9 +9,13 @@ VAST_RELAX_WARNINGS
 #include <clang/CodeGen/BackendUtil.h>
 VAST_UNRELAX_WARNINGS
 
+#include "vast/Frontend/CompileCache.hpp"
 #include "vast/Frontend/Diagnostics.hpp"
 #include "vast/Frontend/FrontendAction.hpp"
 #include "vast/Frontend/Options.hpp"
+#include "vast/Frontend/PipelineStats.hpp"
+#include "vast/Frontend/Pipelines.hpp"
+#include "vast/Frontend/Streaming.hpp"
 #include "vast/Frontend/Targets.hpp"
 
 #include "vast/CodeGen/CodeGenDriver.hpp"
@@ -30,7 +34,14 @@ namespace vast::cc {
     {
         vast_consumer(action_options opts, const vast_args &vargs, mcontext_t &mctx)
             : opts(std::move(opts)), vargs(vargs), mctx(mctx)
-        {}
+        {
+            if (vargs.has_option(opt::pipeline_stats)) {
+                auto measure_at = vargs.get_options_list(opt::pipeline_stats_measure);
+                stats = std::make_unique< pipeline_stats >(
+                    measure_at.value_or(std::vector< string_ref >{})
+                );
+            }
+        }
 
         void Initialize(acontext_t &ctx) override;
 
@@ -74,10 +85,29 @@ namespace vast::cc {
         //
         mcontext_t &mctx;
 
+        //
+        // Clang AST context, available once the consumer is initialized.
+        //
+        acontext_t *actx = nullptr;
+
         //
         // vast driver
         //
         std::unique_ptr< cg::driver > driver = nullptr;
+
+        //
+        // Statistics requested by `-vast-pipeline-stats`.
+        //
+        std::unique_ptr< pipeline_stats > stats = nullptr;
+
+        void timed_codegen(string_ref phase, auto &&fn) {
+            if (stats) {
+                auto timer = stats->time_codegen(phase);
+                fn();
+            } else {
+                fn();
+            }
+        }
     };
 
     struct vast_stream_consumer : vast_consumer {
@@ -91,20 +121,61 @@ namespace vast::cc {
             : base(std::move(opts), vargs, mctx), action(act), output_stream(std::move(os))
         {}
 
+        void Initialize(acontext_t &acontext) override;
+
+        bool HandleTopLevelDecl(clang::DeclGroupRef decls) override;
+
         void HandleTranslationUnit(acontext_t &acontext) override;
 
+        // Processes already generated module instead of the translation unit.
+        void handle_mlir_input(acontext_t &acontext, owning_mlir_module_ref mod);
+
       private:
+        void emit(owning_mlir_module_ref mod);
+
         void emit_backend_output(backend backend_action, owning_mlir_module_ref mod);
 
+        // Function definitions are lowered one at a time for backend outputs
+        // with `-vast-stream-functions`, see `streamed_module`.
+        bool streams_functions() const;
+
+        void emit_streamed_backend_output(backend backend_action);
+
+        std::unique_ptr< llvm::Module > lower_to_llvm(
+            mlir_module mod, llvm::LLVMContext &llvm_context
+        );
+
         void emit_mlir_output(target_dialect target, owning_mlir_module_ref mod);
 
         void process_mlir_module(target_dialect target, mlir_module mod);
 
+        // Dialect the pipeline lowers to for the requested output.
+        std::optional< target_dialect > output_target() const;
+
+        // Result of the whole pipeline if it is already cached.
+        owning_mlir_module_ref load_cached_result(const compile_cache &cache);
+
+        // Runs the pipeline, but resumes from the deepest step cached in `cache`
+        // and stores results of the remaining steps.
+        logical_result run_cached_pipeline(
+            const compile_cache &cache, vast_pipeline &pipeline, mlir_module mod
+        );
+
         void print_mlir_bytecode(owning_mlir_module_ref mod);
         void print_mlir_string_format(owning_mlir_module_ref mod);
 
         output_type action;
         output_stream_ptr output_stream;
+
+        pipeline_source source = pipeline_source::ast;
+
+        // Cache given by `-vast-cache-dir`. Top-level declarations are emitted
+        // only once it is known that the result of the pipeline is not cached.
+        std::optional< compile_cache > cache;
+        std::vector< clang::DeclGroupRef > deferred_decls;
+
+        // The module is the cached result of the whole pipeline.
+        bool cached_result = false;
     };
 
 } // namespace vast::cc
@@ -23,6 +23,7 @@ namespace vast::cc {
             .target  = ci.getTargetOpts(),
             .lang    = ci.getLangOpts(),
             .front   = ci.getFrontendOpts(),
+            .invocation = ci.getInvocation(),
             .diags   = ci.getDiagnostics(),
             .vfs     = ci.getVirtualFileSystem()
         };
@@ -9,6 +9,7 @@ VAST_RELAX_WARNINGS
 #include <clang/Basic/CodeGenOptions.h>
 #include <clang/Basic/LangOptions.h>
 #include <clang/Basic/TargetInfo.h>
+#include <clang/Frontend/CompilerInvocation.h>
 #include <clang/Frontend/FrontendOptions.h>
 VAST_UNRELAX_WARNINGS
 
@@ -28,6 +29,7 @@ namespace vast::cc
     using target_options        = clang::TargetOptions;
     using language_options      = clang::LangOptions;
     using frontend_options      = clang::FrontendOptions;
+    using invocation_options    = clang::CompilerInvocation;
 
     using diagnostics_engine    = clang::DiagnosticsEngine;
 
@@ -39,6 +41,7 @@ namespace vast::cc
         const target_options &target;
         const language_options &lang;
         const frontend_options &front;
+        const invocation_options &invocation;
         diagnostics_engine &diags;
         virtual_file_system &vfs;
     };
@@ -79,23 +82,41 @@ namespace vast::cc
         constexpr option_t emit_mlir_bytecode = "emit-mlir-bytecode";
 
         constexpr option_t print_pipeline = "print-pipeline";
+        constexpr option_t pipeline_stats = "pipeline-stats";
+        constexpr option_t pipeline_stats_measure = "pipeline-stats-measure";
+        constexpr option_t profile_patterns = "profile-patterns";
+        constexpr option_t branch = "branch";
+
+        constexpr option_t batch = "batch";
+        constexpr option_t batch_jobs = "batch-jobs";
+        constexpr option_t batch_output = "batch-output";
+        constexpr option_t batch_report = "batch-report";
         constexpr option_t emit_crash_reproducer = "emit-crash-reproducer";
 
         constexpr option_t disable_multithreading = "disable-multithreading";
         constexpr option_t debug = "debug";
 
         constexpr option_t simplify = "simplify";
+        constexpr option_t prune_data_layout = "prune-data-layout";
         constexpr option_t canonicalize = "canonicalize";
 
         constexpr option_t snapshot_at = "snapshot-at";
+        constexpr option_t snapshot_format   = "snapshot-format";
+        constexpr option_t snapshot_async    = "snapshot-async";
+        constexpr option_t snapshot_archive  = "snapshot-archive";
+        constexpr option_t snapshot_compress = "snapshot-compress";
 
         llvm::Twine disable(string_ref pipeline_name);
 
         constexpr option_t show_locs        = "show-locs";
         constexpr option_t locs_as_meta_ids = "locs-as-meta-ids";
         constexpr option_t loc_attrs        = "loc-attrs";
+        constexpr option_t locs_granularity = "locs-granularity";
 
         constexpr option_t disable_unsupported = "disable-unsupported";
+        constexpr option_t dynamic_visitor_list = "dynamic-visitor-list";
+        constexpr option_t codegen_jobs = "codegen-jobs";
+        constexpr option_t stream_functions = "stream-functions";
 
         constexpr option_t disable_vast_verifier = "disable-verifier";
         constexpr option_t vast_verify_diags = "verify-diags";
@@ -103,6 +124,9 @@ namespace vast::cc
 
         constexpr option_t output_sarif = "output-sarif";
 
+        constexpr option_t cache_dir        = "cache-dir";
+        constexpr option_t cache_size_limit = "cache-size-limit";
+
         bool emit_only_mlir(const vast_args &vargs);
         bool emit_only_llvm(const vast_args &vargs);
     } // namespace opt
@@ -0,0 +1,94 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/MapVector.h>
+#include <llvm/ADT/StringSet.h>
+#include <mlir/Pass/PassInstrumentation.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+#include "vast/Util/Pipeline.hpp"
+
+#include <chrono>
+#include <mutex>
+
+namespace vast::cc {
+
+    //
+    // Performance statistics of a single compilation collected for
+    // `-vast-pipeline-stats=<file>`. Codegen phases are timed by the consumer,
+    // passes by the instrumentation returned from `instrument`.
+    //
+    // Measuring IR size walks the whole operation, hence it is done only
+    // around passes given by `-vast-pipeline-stats-measure=<name>;...`, where
+    // a name is either a pass argument or a compound step of the pipeline.
+    //
+    struct pipeline_stats
+    {
+        using clock    = std::chrono::steady_clock;
+        using duration = std::chrono::duration< double, std::milli >;
+
+        struct ir_size
+        {
+            std::uint64_t ops   = 0;
+            std::uint64_t types = 0;
+            std::uint64_t attrs = 0;
+        };
+
+        struct pass_record
+        {
+            std::string name;
+            std::vector< std::string > steps;
+            std::uint64_t runs = 0;
+            duration wall      = {};
+            bool measured = false;
+            ir_size before;
+            ir_size after;
+            std::int64_t peak_rss_delta_kb = 0;
+        };
+
+        struct phase_record
+        {
+            std::uint64_t calls = 0;
+            duration wall       = {};
+        };
+
+        explicit pipeline_stats(llvm::ArrayRef< string_ref > measure_at = {}) {
+            for (auto point : measure_at) {
+                measure_points.insert(point);
+            }
+        }
+
+        // Times the scope and accounts it to the codegen phase `name`.
+        auto time_codegen(string_ref name) {
+            struct timer
+            {
+                phase_record &record;
+                clock::time_point start = clock::now();
+
+                ~timer() {
+                    record.calls++;
+                    record.wall += clock::now() - start;
+                }
+            };
+
+            return timer{ codegen[name] };
+        }
+
+        std::unique_ptr< mlir::PassInstrumentation > instrument(const pipeline_t &pipeline);
+
+        void write(string_ref path) const;
+
+        llvm::StringSet<> measure_points;
+
+        llvm::MapVector< string_ref, phase_record > codegen;
+        llvm::MapVector< mlir::TypeID, pass_record > passes;
+        std::mutex mutex;
+    };
+
+} // namespace vast::cc
@@ -14,7 +14,7 @@ VAST_UNRELAX_WARNINGS
 
 namespace vast::cc {
 
-    enum class pipeline_source { ast };
+    enum class pipeline_source { ast, mlir };
 
     struct vast_pipeline : pipeline_t
     {
@@ -28,17 +28,24 @@ namespace vast::cc {
 
         schedule_result schedule(pipeline_step_ptr step) override;
 
+        std::unique_ptr< pipeline_t > make_empty_pipeline() const override;
+
         bool is_disabled(const pipeline_step_ptr &step) const;
         bool stop_after_step(const pipeline_step_ptr &step) const;
 
         const vast_args &vargs;
+
+        // Graph node of the step scheduled last, used to connect dependencies.
+        std::optional< step_graph::node_id > last_scheduled;
     };
 
 
     //
     // Create pipeline schedule from source `src` to target `trg`
     //
-    // Source can be either AST or MLIR dialect
+    // Source can be either AST or MLIR dialect. In case of MLIR source, the
+    // `input` module is inspected to find out which dialect it has already
+    // reached and only the remaining conversions are scheduled.
     //
     // Target can be either MLIR dialect, LLVM IR or other downstream target
     // (object file, assembly, etc.)
@@ -50,7 +57,15 @@ namespace vast::cc {
         pipeline_source src, target_dialect trg,
         mcontext_t &mctx,
         const vast_args &vargs,
-        string_ref snapshot_prefix = "snapshot"
+        string_ref snapshot_prefix = "snapshot",
+        mlir_module input = {}
     );
 
+    //
+    // Returns the last dialect of the default conversion path the module was
+    // already converted to. Dialects of the ops present decide first, types
+    // only break the tie between high level and standard types modules.
+    //
+    target_dialect reached_dialect(mlir_module mod);
+
 } // namespace vast::cc
@@ -0,0 +1,66 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringSet.h>
+#include <llvm/IR/GlobalValue.h>
+#include <llvm/IR/Module.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include "vast/Dialect/Core/CoreOps.hpp"
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+
+namespace vast::cc {
+
+    //
+    // Lowers function definitions of a translation unit one at a time for
+    // `-vast-stream-functions`. Each body is moved to a module of its own,
+    // together with declarations it might refer to, lowered and translated to
+    // LLVM IR, and linked with previously translated functions. What remains
+    // of the high-level module (globals and declarations) is linked last.
+    //
+    struct streamed_module
+    {
+        // Moves the body of `fn` into a new module with copies of the type
+        // declarations and declarations of functions and globals of `mod`
+        // that the body references. The function is left in `mod` as
+        // a declaration.
+        owning_mlir_module_ref extract(core::module mod, hl::FuncOp fn);
+
+        // Links translation of a module created by `extract`.
+        void link_function(std::unique_ptr< llvm::Module > part);
+
+        // Links translation of the remaining module, which defines globals.
+        void link_rest(std::unique_ptr< llvm::Module > rest);
+
+        // Restores linkage of local symbols and returns the linked module.
+        std::unique_ptr< llvm::Module > finish();
+
+      private:
+        // Declarations of `mod` transitively referenced by `fn`.
+        static llvm::DenseSet< operation > referenced_declarations(
+            core::module mod, hl::FuncOp fn
+        );
+
+        void link(std::unique_ptr< llvm::Module > part, bool defines_globals);
+
+        //
+        // Side table of module-level state. Symbols with local linkage are
+        // external while parts are linked, so that references between parts
+        // resolve.
+        //
+        llvm::StringSet<> symbols;
+        llvm::StringSet<> globals;
+        llvm::StringMap< llvm::GlobalValue::LinkageTypes > local_linkage;
+
+        std::unique_ptr< llvm::Module > linked;
+    };
+
+} // namespace vast::cc
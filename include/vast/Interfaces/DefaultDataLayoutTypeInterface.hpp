@@ -30,6 +30,13 @@ namespace vast
             entries.size() != 0, "Data layout query for: {0} did not match to any dl entry!",
             casted_self);
 
+        // `core::DataLayoutSpecAttr` answers with a single entry referring to
+        // its hashed table.
+        if (auto table = dl::as_layout_table(entries)) {
+            if (auto entry = table.lookup(casted_self))
+                return dl::DLEntry::cast< Out >(extract(dl::DLEntry(*entry)));
+        }
+
         std::optional< Out > out;
         auto handle_entry = [&](const auto &entry)
         {
@@ -42,6 +49,18 @@ namespace vast
                        *out, current, entries.size());
         };
 
+        if (auto table = dl::as_layout_table(entries)) {
+            for (const auto &entry : table.getLayouts())
+            {
+                if (mlir::isa< ConcreteType >(entry.type))
+                    handle_entry(dl::DLEntry(entry));
+            }
+
+            VAST_CHECK(out.has_value(), "Data layout query of {0} did not produce a value!",
+                       casted_self);
+            return *out;
+        }
+
         for (const auto &entry : entries)
         {
             auto raw = dl::DLEntry(entry);
@@ -23,4 +23,17 @@ namespace vast::tw {
         mlir_module mod;
     };
 
+    // Provides modules for handles whose modules are not kept alive by
+    // the storage, e.g., modules reconstructed from delta snapshots.
+    struct module_resolver
+    {
+        virtual ~module_resolver() = default;
+
+        virtual handle_t resolve(handle_id_t) = 0;
+
+        // Keeps the resolved module of the handle alive until it is unpinned.
+        virtual void pin(handle_t) = 0;
+        virtual void unpin(handle_t) = 0;
+    };
+
 } // namespace vast::tw
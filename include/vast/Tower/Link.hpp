@@ -11,6 +11,7 @@ VAST_RELAX_WARNINGS
 VAST_UNRELAX_WARNINGS
 
 #include <memory>
+#include <optional>
 #include <vector>
 
 namespace vast::tw {
@@ -64,12 +65,39 @@ namespace vast::tw {
         handle_t _parent;
         handle_t _child;
         location_info_t &_location_info;
+        // If present, modules are retrieved on each access as they may not
+        // be kept alive between queries.
+        module_resolver *_resolver;
+
+        // Operations of a module indexed by location, built on the first query.
+        // The indexed module stays pinned in the resolver for as long as the
+        // step lives, so the index survives evictions of the storage.
+        struct lazy_index
+        {
+            mlir_module mod = {};
+            llvm::DenseMap< loc_t, operations > ops;
+        };
+
+        // child operations by the location of their parent
+        lazy_index _by_prev;
+        // parent operations by their location
+        lazy_index _by_self;
+
+        const lazy_index &index(lazy_index &idx, handle_t handle, auto &&key);
 
       public:
-        explicit conversion_step(handle_t parent, handle_t child, location_info_t &location_info)
-            : _parent(parent), _child(child), _location_info(location_info)
+        explicit conversion_step(
+            handle_t parent, handle_t child, location_info_t &location_info,
+            module_resolver *resolver = nullptr
+        )
+            : _parent(parent), _child(child), _location_info(location_info), _resolver(resolver)
         {}
 
+        conversion_step(const conversion_step &) = delete;
+        conversion_step &operator=(const conversion_step &) = delete;
+
+        ~conversion_step() override;
+
         operations children(operation) override;
         operations children(operations) override;
 
@@ -95,8 +123,14 @@ namespace vast::tw {
       protected:
         link_vector _links;
 
-        op_mapping _to_children;
-        op_mapping _to_parents;
+        // Memoized answers of per-operation queries, computed by following
+        // only the chain of the queried operation.
+        op_mapping _children;
+        op_mapping _parents;
+
+        // Complete mappings are built only on request.
+        std::optional< op_mapping > _to_children;
+        std::optional< op_mapping > _to_parents;
 
       public:
         explicit fat_link(link_vector links);
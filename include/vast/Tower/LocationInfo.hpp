@@ -13,43 +13,61 @@ VAST_UNRELAX_WARNINGS
 
 namespace vast::tw {
 
-    // Is allowed to have state?
+    // Identifies an operation in the module produced by a conversion step.
+    struct provenance_t
+    {
+        std::uint32_t step;
+        std::uint32_t op;
+
+        friend bool operator==(const provenance_t &, const provenance_t &) = default;
+    };
+
+    // Hands out ids of conversion steps, so it has to outlive all towers using it.
     struct location_info_t
     {
       private:
-        // Encoded as `mlir::FusedLocation(original, mlir::OpaqueLocation(pointer_to_self))`
-        using raw_loc_t = mlir::FusedLoc;
+        // Encoded as `mlir::OpaqueLoc(provenance, prev)` where the provenance
+        // packs ids of the step and of the operation into a single integer and
+        // the fallback location is the location of the operation in the parent
+        // module (or its original location in the root). This way no strings
+        // are interned and each operation costs one uniqued location per step.
+        using raw_loc_t = mlir::OpaqueLoc;
 
         static raw_loc_t raw_loc(operation op) {
             auto raw = mlir::dyn_cast< raw_loc_t >(op->getLoc());
-            VAST_CHECK(raw, "{0} with loc: {1}", *op, op->getLoc());
+            VAST_CHECK(raw && raw.getUnderlyingTypeID() == tag(), "{0} with loc: {1}", *op, op->getLoc());
             return raw;
         }
 
-        template< std::size_t idx >
-            requires (idx < 2)
-        static loc_t get(raw_loc_t raw) {
-            auto locs = raw.getLocations();
-            VAST_ASSERT(locs.size() == 2);
-            return locs[idx];
+        static mlir::TypeID tag() { return mlir::TypeID::get< location_info_t >(); }
+
+        static std::uintptr_t encode(provenance_t id) {
+            return (static_cast< std::uintptr_t >(id.step) << 32) | id.op;
         }
 
-        static auto parse(operation op) { return std::make_tuple(prev(op), self(op)); }
+        static provenance_t decode(std::uintptr_t raw) {
+            return { static_cast< std::uint32_t >(raw >> 32), static_cast< std::uint32_t >(raw) };
+        }
 
-        // TODO: These are strictly not needed in this form, but help initial
-        //       debugging a lot.
-        std::string fingerprint(const conversion_path_t &);
-        loc_t mk_unique_loc(const conversion_path_t &, operation);
-        loc_t mk_linked_loc(loc_t self, loc_t prev);
+        std::uint32_t next_step = 0;
 
       public:
-        // For the given operation return location to be used in this module.
-        loc_t get_as_child(const conversion_path_t &, operation op);
-        loc_t get_root(operation op);
+        static_assert(sizeof(std::uintptr_t) >= 8, "provenance does not fit into a location");
+
+        // Every call starts a new step - operations of one module
+        // need to be assigned locations within the same step.
+        std::uint32_t mk_step() { return next_step++; }
+
+        // Location of an operation in the module of `step`, tied to `prev`.
+        static loc_t mk_linked_loc(provenance_t self, loc_t prev);
+
+        static provenance_t provenance(raw_loc_t raw) { return decode(raw.getUnderlyingLocation()); }
+
+        static provenance_t provenance(operation op) { return provenance(raw_loc(op)); }
 
-        static loc_t self(raw_loc_t raw) { return get< 1 >(raw); }
+        static loc_t self(raw_loc_t raw) { return raw; }
 
-        static loc_t prev(raw_loc_t raw) { return get< 0 >(raw); }
+        static loc_t prev(raw_loc_t raw) { return raw.getFallbackLocation(); }
 
         static loc_t self(operation op) { return self(raw_loc(op)); }
 
@@ -63,6 +81,6 @@ namespace vast::tw {
     // however require slightly different handling, so we are exposing a hook for that.
     void mk_root(location_info_t &, operation);
 
-    void transform_locations(location_info_t &, const conversion_path_t &, operation);
+    void transform_locations(location_info_t &, operation);
 
 } // namespace vast::tw
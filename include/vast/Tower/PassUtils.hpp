@@ -6,10 +6,14 @@
 
 VAST_RELAX_WARNINGS
 #include <mlir/Pass/PassManager.h>
+
+#include <llvm/ADT/Hashing.h>
 VAST_UNRELAX_WARNINGS
 
 #include "vast/Tower/Handle.hpp"
 
+#include <array>
+
 namespace vast::tw {
 
     // `mlir::Pass::printAsTextualPipeline` is not `const` so we cannot accept `const`
@@ -18,8 +22,39 @@ namespace vast::tw {
 
     std::string to_string(const conversion_passes_t &passes);
 
+    // Identifies a configured pass: the pass type together with a digest of its
+    // options. Option values are reachable only through the textual form of the
+    // pass, which is streamed into the digest instead of being kept.
+    struct pass_fingerprint_t
+    {
+        using digest_t = std::array< std::uint8_t, 20 >;
+
+        mlir::TypeID type;
+        digest_t options;
+
+        bool operator==(const pass_fingerprint_t &other) const = default;
+    };
+
+    struct pass_fingerprint_hash
+    {
+        std::size_t operator()(const pass_fingerprint_t &fp) const {
+            return llvm::hash_combine(
+                fp.type.getAsOpaquePointer(),
+                llvm::hash_combine_range(fp.options.begin(), fp.options.end())
+            );
+        }
+    };
+
+    using pass_fingerprints_t = std::vector< pass_fingerprint_t >;
+
+    pass_fingerprint_t fingerprint(pass_ptr pass);
+
+    pass_fingerprints_t fingerprint(const conversion_passes_t &passes);
+
     // `mlir::PassManager` is really hard to move around, so we instead fill an existing
-    // instance.
+    // instance with clones of the passes.
     void copy_passes(mlir::PassManager &pm, const conversion_passes_t &passes);
 
+    void copy_passes(mlir::PassManager &pm, mlir::OpPassManager::pass_range passes);
+
 } // namespace vast::tw
@@ -14,6 +14,7 @@ VAST_UNRELAX_WARNINGS
 
 #include <algorithm>
 #include <deque>
+#include <memory>
 #include <numeric>
 #include <optional>
 #include <unordered_map>
@@ -46,25 +47,17 @@ namespace vast::tw {
 
         struct node
         {
-            // So `mlir::Pass` does not expose an api to query its options. However,
-            // it should print them when we ask for textual repr. So for now we do compare
-            // those strings.
-            // TODO: Some other unique key that is cheaper?
-            using pass_key_t = std::string;
+            using pass_key_t = pass_fingerprint_t;
 
             // The user is responsible for being able to retrive the module using this
             // piece of data..
             module_key_t module_key;
 
-            std::unordered_map< pass_key_t, node_key_t > next;
+            std::unordered_map< pass_key_t, node_key_t, pass_fingerprint_hash > next;
 
             explicit node(module_key_t key) : module_key(std::move(key)) {}
 
-            void add_edge(pass_key_t pass_name, node_key_t idx) {
-                next.emplace(std::move(pass_name), idx);
-            }
-
-            void add_edge(pass_ptr pass, node_key_t idx) { add_edge(to_string(pass), idx); }
+            void add_edge(pass_key_t pass, node_key_t idx) { next.emplace(pass, idx); }
 
             maybe_node_key_t get_next(const pass_key_t &key) const {
                 if (auto it = next.find(key); it != next.end()) {
@@ -72,113 +65,136 @@ namespace vast::tw {
                 }
                 return std::nullopt;
             }
-
-            maybe_node_key_t get_next(pass_ptr pass) const { return get_next(to_string(pass)); }
         };
 
         // Using a `std::vector` leads to a weird bug caught by asan even though we do not use
         // pointers but indices instead.
         std::deque< node > nodes;
 
+        std::unordered_map< module_key_t, node_key_t > node_of_module;
+
       protected:
         maybe_node_key_t lookup_node(handle_t handle) const {
-            auto it = std::ranges::find_if(nodes, [&](const node &n) {
-                return n.module_key == handle.id;
-            });
-
-            if (it != nodes.end()) {
-                return maybe_node_key_t { std::distance(nodes.begin(), it) };
+            if (auto it = node_of_module.find(handle.id); it != node_of_module.end()) {
+                return it->second;
             }
             return std::nullopt;
         }
 
-        node_key_t lookup(
-            conversion_passes_t &prefix, conversion_passes_t &suffix,
-            node_key_t root, auto on_visit
-        ) const {
-            if (suffix.empty()) {
-                return root;
-            }
+        // Follows the longest stored prefix of `path` and returns the last reached node
+        // together with the length of the prefix.
+        auto lookup(const pass_fingerprints_t &path, node_key_t root, auto on_visit) const
+            -> std::tuple< node_key_t, std::size_t >
+        {
+            std::size_t matched = 0;
+            for (const auto &pass : path) {
+                auto maybe_next = nodes[root].get_next(pass);
+                // There is no outgoing edge, so we stop.
+                if (!maybe_next) {
+                    break;
+                }
 
-            const auto &top = suffix.back();
+                // Callback to current index
+                on_visit(nodes[root].module_key);
 
-            auto maybe_next = nodes[root].get_next(top);
-            // There is no outgoing edge, so we stop.
-            if (!maybe_next) {
-                return root;
+                root = *maybe_next;
+                ++matched;
             }
 
-            // Callback to current index
-            on_visit(root);
-
-            // We found a way forward, so we modify the paths and recurse
-            prefix.push_back(top);
-            suffix.pop_back();
-            return lookup(prefix, suffix, *maybe_next, on_visit);
-        }
-
-        auto lookup_prefix_(conversion_passes_t path, node_key_t start_at, auto on_visit) const
-            -> std::tuple< node_key_t, conversion_passes_t >
-        {
-            conversion_passes_t prefix;
-
-            // We will pop from front, so we reverse go get the cheaper `pop_back()`.
-            std::ranges::reverse(path);
-            auto last = lookup(prefix, path, start_at, on_visit);
-            std::ranges::reverse(path);
-
-            return std::make_tuple(last, std::move(path));
+            return { root, matched };
         }
 
         node_key_t mk_node(module_key_t key) {
-            nodes.emplace_back(std::move(key));
+            nodes.emplace_back(key);
+            node_of_module.emplace(std::move(key), nodes.size() - 1);
             return nodes.size() - 1;
         }
 
       public:
-        // Return key to the last module and the remainder of the path that needs to applied on
-        // it.
-        auto lookup_prefix(conversion_passes_t path, handle_t start_at_handle, auto on_visit)
-            const -> std::tuple< module_key_t, conversion_passes_t > {
+        // Return key to the last module and the length of the prefix of the path
+        // that is already stored, the rest needs to be applied on the module.
+        auto lookup_prefix(const pass_fingerprints_t &path, handle_t start_at_handle, auto on_visit)
+            const -> std::tuple< module_key_t, std::size_t > {
             auto maybe_start_idx = lookup_node(start_at_handle);
             auto start_idx       = maybe_start_idx ? *maybe_start_idx : 0;
-            auto [idx, suffix]   = lookup_prefix_(std::move(path), start_idx, on_visit);
-            return std::make_tuple(nodes[idx].module_key, std::move(suffix));
+            auto [idx, matched]  = lookup(path, start_idx, on_visit);
+            // Visit also the module the prefix ends in.
+            if (matched != 0) {
+                on_visit(nodes[idx].module_key);
+            }
+            return std::make_tuple(nodes[idx].module_key, matched);
         }
 
-        auto lookup_prefix(conversion_passes_t path, handle_t start_at_handle) const {
-            return lookup_prefix(std::move(path), start_at_handle, [](auto) {});
+        auto lookup_prefix(const pass_fingerprints_t &path, handle_t start_at_handle) const {
+            return lookup_prefix(path, start_at_handle, [](auto) {});
         }
 
-        void store(const conversion_passes_t &path, module_key_t key) {
-            auto [last, suffix] = lookup_prefix_(path, 0, [](auto) {});
-
-            // Root case
-            if (suffix.empty()) {
-                VAST_ASSERT(path.empty() && key == 0);
-                mk_node(key);
-                return;
-            }
+        void store_root(module_key_t key) {
+            VAST_ASSERT(nodes.empty() && key == 0);
+            mk_node(key);
+        }
 
-            // Currently each node has to have a module, so if a store is hapening, it is going
-            // to create exactly one new edge.
-            VAST_CHECK(
-                suffix.size() == 1,
-                "Trying to store module not exactly on edge, but: {0} away.", suffix.size()
-            );
-            nodes[last].add_edge(suffix.front(), mk_node(key));
+        // Currently each node has to have a module, so a store creates exactly one new
+        // edge from the node of the parent module.
+        void store(handle_t parent, const pass_fingerprint_t &pass, module_key_t key) {
+            auto maybe_parent = lookup_node(parent);
+            VAST_CHECK(maybe_parent, "Trying to store module of an unknown parent.");
+            auto idx = mk_node(key);
+            nodes[*maybe_parent].add_edge(pass, idx);
         }
 
-        bool present(const conversion_passes_t &path) const {
-            auto [_, suffix] = lookup_prefix(path);
-            return suffix.empty();
+        bool present(const pass_fingerprints_t &path) const {
+            auto [_, matched] = lookup(path, 0, [](auto) {});
+            return matched == path.size();
         }
     };
 
-    struct module_storage
+    // How modules produced by passes are kept in the storage.
+    enum class storage_mode {
+        // every module is a full copy
+        full_clone,
+        // only operations that changed since the previous module are copied,
+        // the rest is shared and the module is reconstructed on access
+        delta
+    };
+
+    //
+    // Module stored as a difference to the previously stored one. Each unit
+    // (operation directly nested in a module) is either owned by the snapshot
+    // or shared with an earlier snapshot. Shared units keep only their
+    // locations as those are updated after every pass.
+    //
+    struct module_snapshot
+    {
+        using locations_t = std::vector< loc_t >;
+
+        struct unit_t
+        {
+            // owned copy or the shared unit of an earlier snapshot,
+            // for nested modules a copy without regions
+            operation op;
+            // locations of a shared unit in pre-order, null if owned
+            std::shared_ptr< const locations_t > locations;
+            // units of a nested module
+            std::vector< unit_t > nested;
+            bool is_module = false;
+        };
+
+        // owns copies of modules and of owned units
+        owning_mlir_module_ref skeleton;
+        std::vector< unit_t > units;
+    };
+
+    // Units of a new module which did not change since the previous one,
+    // mapped to the operation they can be shared with.
+    using unchanged_units_t = llvm::DenseMap< operation, operation >;
+
+    struct module_storage : module_resolver
     {
         using module_key_t = handle_id_t;
 
+        explicit module_storage(storage_mode mode = storage_mode::full_clone) : mode(mode) {}
+
       protected:
         // TODO: API-wise, we probably want to accept any type that is `mlir::OwningOpRef< T >`?
         handle_t store_module(owning_mlir_module_ref mod) {
@@ -187,44 +203,91 @@ namespace vast::tw {
             return { id, it->second.get() };
         }
 
-        handle_t get(module_key_t module_key) const {
-            auto it = storage.find(module_key);
-            VAST_CHECK(it != storage.end(), "Required module not found in the storage!");
-            return { module_key, it->second.get() };
+        handle_t store_snapshot(module_snapshot snapshot) {
+            auto id = next_id++;
+            snapshots.insert({ id, std::move(snapshot) });
+            return { id, nullptr };
+        }
+
+        handle_t get(module_key_t module_key) const;
+
+        // In delta mode modules are not reconstructed until resolved.
+        handle_t get_lazy(module_key_t module_key) const {
+            return storage.count(module_key) ? get(module_key) : handle_t{ module_key, nullptr };
         }
 
       public:
-        std::optional< handle_t > get(const conversion_passes_t &path, handle_t root) {
-            if (auto [module_key, suffix] = trie.lookup_prefix(path, root); suffix.empty()) {
+        std::optional< handle_t > get(const pass_fingerprints_t &path, handle_t root) {
+            if (auto [module_key, matched] = trie.lookup_prefix(path, root); matched == path.size()) {
                 return { get(module_key) };
             }
             return std::nullopt;
         }
 
-        auto get_maximum_prefix_path(const conversion_passes_t &path, handle_t root) const
-            -> std::tuple< std::vector< handle_t >, conversion_passes_t >
+        // Returns handles along the longest stored prefix of the path and passes
+        // that remain to be applied. Returned handles need to be resolved before
+        // their module is accessed.
+        auto get_maximum_prefix_path(const pass_fingerprints_t &path, handle_t root) const
+            -> std::tuple< std::vector< handle_t >, pass_fingerprints_t >
         {
             std::vector< handle_t > handles;
-            auto yield = [&](module_key_t module_key) { handles.push_back(get(module_key)); };
+            auto yield = [&](module_key_t module_key) { handles.push_back(get_lazy(module_key)); };
 
-            auto [_, suffix] = trie.lookup_prefix(path, root, yield);
+            auto [_, matched] = trie.lookup_prefix(path, root, yield);
+            auto suffix = pass_fingerprints_t(path.begin() + matched, path.end());
             return std::make_tuple(std::move(handles), std::move(suffix));
         }
 
-        handle_t store(const conversion_passes_t &path, owning_mlir_module_ref mod) {
+        handle_t store_root(owning_mlir_module_ref mod) {
+            auto handle = store_module(std::move(mod));
+            trie.store_root(handle.id);
+            return handle;
+        }
+
+        handle_t store(
+            handle_t parent, const pass_fingerprint_t &pass, owning_mlir_module_ref mod
+        ) {
             // Just store the module, so it gets assigned id.
             auto handle = store_module(std::move(mod));
             // Now add it to the trie.
-            trie.store(path, handle.id);
+            trie.store(parent, pass, handle.id);
             return handle;
         }
 
+        // Must be queried before locations of `mod` are updated for the new step.
+        unchanged_units_t unchanged_units(handle_t from, mlir_module mod) const;
+
+        // Stores a snapshot of `mod` according to the storage mode. The returned
+        // handle needs to be resolved before its module is accessed.
+        handle_t store(
+            handle_t parent, const pass_fingerprint_t &pass, mlir_module mod,
+            const unchanged_units_t &unchanged
+        );
+
+        handle_t resolve(handle_id_t id) override { return get(id); }
+
+        // Keep reconstructed module of the handle alive across evictions until
+        // each of its pins is released.
+        void pin(handle_t handle) override { ++pinned[handle.id]; }
+
+        // Releases a pin of the handle, its reconstructed module is dropped
+        // once no pins remain.
+        void unpin(handle_t handle) override;
+
+        // Drop modules reconstructed from snapshots that are not pinned.
+        void evict_unpinned();
+
         // TODO: Does it even make sense to remove things explicitly by the user?
         void remove(handle_t) { VAST_UNIMPLEMENTED; }
 
       private:
+        storage_mode mode;
         module_key_t next_id = 0;
         llvm::DenseMap< handle_id_t, owning_mlir_module_ref > storage;
+        llvm::DenseMap< handle_id_t, module_snapshot > snapshots;
+        mutable llvm::DenseMap< handle_id_t, owning_mlir_module_ref > materialized;
+        // number of pins of each pinned module
+        llvm::DenseMap< handle_id_t, std::size_t > pinned;
         conversion_tree< module_key_t > trie;
     };
 } // namespace vast::tw
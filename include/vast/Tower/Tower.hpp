@@ -26,20 +26,27 @@ namespace vast::tw {
         handle_t top_handle;
 
       public:
-        tower(mcontext_t &mctx, location_info_t &li, owning_mlir_module_ref root) : mctx(mctx) {
+        tower(
+            mcontext_t &mctx, location_info_t &li, owning_mlir_module_ref root,
+            storage_mode mode = storage_mode::full_clone
+        )
+            : mctx(mctx), storage(mode)
+        {
             mk_root(li, root->getOperation());
-            top_handle = storage.store(root_conversion(), std::move(root));
+            top_handle = storage.store_root(std::move(root));
         }
 
       protected:
-        // TODO: Move somewhere else.
-        static conversion_passes_t root_conversion() { return {}; }
-
-        link_vector mk_full_path(handle_t, location_info_t &, mlir::PassManager &);
+        link_vector mk_full_path(
+            handle_t, location_info_t &, mlir::PassManager &, const pass_fingerprints_t &
+        );
+        link_vector mk_steps(handle_t, location_info_t &, mlir::PassManager &);
 
       public:
         handle_t top() const { return top_handle; }
 
+        // Endpoints of the returned link are kept alive until the link is
+        // released, the link must not outlive the tower.
         link_ptr apply(handle_t, location_info_t &, mlir::PassManager &);
     };
 
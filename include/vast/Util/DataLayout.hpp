@@ -6,6 +6,7 @@
 
 VAST_RELAX_WARNINGS
 #include <clang/AST/ASTContext.h>
+#include <llvm/ADT/MapVector.h>
 #include <mlir/Dialect/DLTI/DLTI.h>
 #include <mlir/IR/BuiltinTypes.h>
 #include <mlir/IR/Dialect.h>
@@ -15,16 +16,18 @@ VAST_RELAX_WARNINGS
 VAST_UNRELAX_WARNINGS
 
 #include "vast/Util/Common.hpp"
+#include "vast/Dialect/Core/CoreAttributes.hpp"
+#include "vast/Dialect/Core/CoreDialect.hpp"
 #include "vast/Dialect/Core/CoreOps.hpp"
 
 #include <type_traits>
 
 namespace vast::dl {
-    // We are currently using `DLTI` dialect to help encoding data layout information,
-    // however in the future custom attributes will be probably preferable.
-    // Each entry is mapping `hl::Type -> uint32_t` and in the IR it is encoded as
-    // attribute of `ModuleOp`.
-    // TODO(lukas): Add alignment information & possibly ABI lowering relevant info?
+    // Codegen encodes data layout of VAST types as `core::DataLayoutSpecAttr`
+    // of the module, lowerings to dialects that expect `DLTI` (e.g., LLVM)
+    // produce `DLTI` entries, where VAST types that are left are encoded as
+    // dictionaries.
+    // Each entry is mapping `hl::Type -> (bw, abi_align)`.
     struct DLEntry
     {
         using bitwidth_t = uint32_t;
@@ -42,6 +45,9 @@ namespace vast::dl {
             , bw(extract(dict_attr, bw_key()))
             , abi_align(extract(dict_attr, abi_align_key())) {}
 
+        DLEntry(const core::type_layout &entry)
+            : type(entry.type), bw(entry.bw), abi_align(entry.abi_align) {}
+
         DLEntry(const mlir::DataLayoutEntryInterface &attr)
             : DLEntry(
                 mlir::dyn_cast< mlir_type >(attr.getKey()),
@@ -107,14 +113,39 @@ namespace vast::dl {
             return mlir::DataLayoutEntryAttr::get(type, create_raw_attr(mctx));
         }
 
+        core::type_layout layout() const { return { type, bw, abi_align }; }
+
         bool operator==(const DLEntry &o) const = default;
     };
 
-    void filter_data_layout(core::module mod, auto &&filter) {
-        auto dl = mod.getDataLayoutSpec();
+    // Returns the table if `entries` were produced by `core::DataLayoutSpecAttr`.
+    static inline core::DataLayoutSpecAttr as_layout_table(mlir::DataLayoutEntryListRef entries) {
+        if (entries.size() != 1) {
+            return {};
+        }
+        return mlir::dyn_cast< core::DataLayoutSpecAttr >(entries.front().getValue());
+    }
+
+    // Keeps entries of types accepted by `keep`.
+    void filter_data_layout(core::module mod, auto &&keep) {
+        auto spec = mod.getDataLayoutSpec();
+        if (!spec) {
+            return;
+        }
+
+        if (auto table = mlir::dyn_cast< core::DataLayoutSpecAttr >(spec)) {
+            auto filtered = table.filter(std::forward< decltype(keep) >(keep));
+            if (filtered != table) {
+                mod->setAttr(core::CoreDialect::getDataLayoutAttrName(), filtered);
+            }
+            return;
+        }
 
         auto filtered_entries = llvm::to_vector(
-            llvm::make_filter_range(dl.getEntries(), std::forward< decltype(filter) >(filter))
+            llvm::make_filter_range(spec.getEntries(), [&] (const auto &entry) {
+                auto type = mlir::dyn_cast< mlir_type >(entry.getKey());
+                return !type || keep(type);
+            })
         );
 
         mod->setAttr(
@@ -128,10 +159,13 @@ namespace vast::dl {
     {
         bool try_emplace(mlir_type mty, const clang::Type *aty, const acontext_t &actx) {
             // For other types this should be good-enough for now
-            auto info      = actx.getTypeInfo(aty);
+            return try_emplace(mty, actx.getTypeInfo(aty));
+        }
+
+        bool try_emplace(mlir_type mty, const clang::TypeInfo &info) {
             auto bw        = static_cast< uint32_t >(info.Width);
             auto abi_align = static_cast< uint32_t >(info.Align);
-            return std::get< 1 >(entries.try_emplace(mty, dl::DLEntry{ mty, bw, abi_align }));
+            return entries.insert({ mty, dl::DLEntry{ mty, bw, abi_align } }).second;
         }
 
         void add(mlir_type type, dl::DLEntry entry) {
@@ -142,18 +176,20 @@ namespace vast::dl {
                     "Insertion of dl::DLEntry would make DLBlueprint inconsistent."
                 );
             }
-            entries.try_emplace(type, entry);
+            entries.insert({ type, entry });
         }
 
         auto wrap(mcontext_t &mctx) const {
-            std::vector< mlir::DataLayoutEntryInterface > flattened;
+            std::vector< core::type_layout > flattened;
+            flattened.reserve(entries.size());
             for (const auto &[_, e] : entries) {
-                flattened.push_back(e.wrap(mctx));
+                flattened.push_back(e.layout());
             }
-            return mlir::DataLayoutSpecAttr::get(&mctx, flattened);
+            return core::DataLayoutSpecAttr::get(&mctx, flattened);
         }
 
-        llvm::DenseMap< mlir_type, dl::DLEntry > entries;
+        // Entries are emitted in the order of insertion.
+        llvm::MapVector< mlir_type, dl::DLEntry > entries;
     };
 
     template< typename Stream >
@@ -0,0 +1,123 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/raw_ostream.h>
+#include <mlir/IR/MLIRContext.h>
+#include <mlir/IR/PatternMatch.h>
+#include <mlir/Rewrite/FrozenRewritePatternSet.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+namespace vast::util {
+
+    //
+    // Opt-in profiling of rewrite patterns applied by conversion passes. When
+    // enabled, every native pattern of a set is wrapped before the set is
+    // frozen, so patterns themselves are left untouched. Counters are atomic
+    // as frozen sets are shared by pass clones running in parallel.
+    //
+    struct pattern_counters
+    {
+        std::atomic< std::uint64_t > attempts  = 0;
+        std::atomic< std::uint64_t > successes = 0;
+        std::atomic< std::int64_t > nanoseconds = 0;
+    };
+
+    struct pattern_profile
+    {
+        using clock = std::chrono::steady_clock;
+
+        // Patterns are identified by their debug name, which defaults to the
+        // name of the pattern type.
+        pattern_counters &counters(string_ref pattern);
+
+        // Times the whole application of the conversion driver, i.e., the
+        // patterns together with legality checks and bookkeeping of the driver.
+        auto time_conversion() {
+            struct timer
+            {
+                pattern_profile &profile;
+                clock::time_point start = clock::now();
+
+                ~timer() {
+                    auto elapsed = clock::now() - start;
+                    profile.conversions++;
+                    profile.conversion_nanoseconds += std::chrono::duration_cast<
+                        std::chrono::nanoseconds
+                    >(elapsed).count();
+                }
+            };
+
+            return timer{ *this };
+        }
+
+        void print(string_ref pass, llvm::raw_ostream &os) const;
+
+        // Zeroes all counters in place, wrapped patterns keep their references.
+        void reset();
+
+        bool empty() const { return conversions == 0; }
+
+        std::atomic< std::uint64_t > conversions = 0;
+        std::atomic< std::int64_t > conversion_nanoseconds = 0;
+
+      private:
+        mutable std::mutex mutex;
+        llvm::StringMap< pattern_counters > patterns;
+    };
+
+    void enable_pattern_profiling(bool enable = true);
+    bool pattern_profiling_enabled();
+
+    // Profile shared by all instances of the pass with the given argument that
+    // run in the context. Profiles are kept per context so that compilations
+    // running concurrently (e.g., in batch mode) do not mix their counters.
+    pattern_profile &pattern_profile_of(mlir::MLIRContext *mctx, string_ref pass);
+
+    // Profile of the pass if profiling is enabled, null otherwise.
+    pattern_profile *active_pattern_profile(mlir::MLIRContext *mctx, string_ref pass);
+
+    // Wraps all native patterns of the set so that they report to `profile`.
+    void profile_patterns(mlir::RewritePatternSet &patterns, pattern_profile &profile);
+
+    // Freezes the patterns and runs the conversion driver `apply` on them. Used
+    // by passes that drive conversions themselves instead of through the
+    // conversion mixins, so that they are profiled the same way.
+    template< typename apply_t >
+    logical_result profile_conversion(
+        mlir::MLIRContext *mctx, string_ref pass, mlir::RewritePatternSet patterns,
+        apply_t &&apply
+    ) {
+        auto profile = active_pattern_profile(mctx, pass);
+        if (!profile) {
+            return apply(mlir::FrozenRewritePatternSet(std::move(patterns)));
+        }
+
+        profile_patterns(patterns, *profile);
+        auto frozen = mlir::FrozenRewritePatternSet(std::move(patterns));
+        auto timer  = profile->time_conversion();
+        return apply(frozen);
+    }
+
+    // Prints a table of patterns ranked by time for each pass profiled in the
+    // context since its profiles were last reset.
+    void print_pattern_profiles(mlir::MLIRContext *mctx, llvm::raw_ostream &os);
+
+    // Prints profiles of all contexts.
+    void print_pattern_profiles(llvm::raw_ostream &os);
+
+    // Starts a new profile of the compilation running in the context, contexts
+    // are reused by consecutive compilations of a batch.
+    void reset_pattern_profiles(mlir::MLIRContext *mctx);
+
+} // namespace vast::util
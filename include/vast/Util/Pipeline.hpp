@@ -5,7 +5,9 @@
 #include "vast/Util/Warnings.hpp"
 
 VAST_RELAX_WARNINGS
+#include <llvm/ADT/DenseMap.h>
 #include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/ScopeExit.h>
 #include <mlir/IR/DialectRegistry.h>
 #include <mlir/Pass/PassManager.h>
 #include <mlir/Pass/PassRegistry.h>
@@ -18,6 +20,8 @@ VAST_UNRELAX_WARNINGS
 
 #include <gap/coro/generator.hpp>
 
+#include <future>
+
 namespace vast {
 
 #if !defined(NDEBUG)
@@ -40,6 +44,66 @@ namespace vast {
 
     enum class schedule_result { stop, advance };
 
+    //
+    // Graph of scheduled steps kept for inspection of the schedule. Steps of
+    // the main pipeline belong to cluster 0, each branch has its own cluster.
+    //
+    struct step_graph
+    {
+        using node_id    = std::size_t;
+        using cluster_id = std::size_t;
+
+        enum class edge_kind { sequence, dependency, contains };
+
+        struct node
+        {
+            std::string name;
+            cluster_id cluster;
+        };
+
+        struct edge
+        {
+            node_id from;
+            node_id to;
+            edge_kind kind;
+        };
+
+        node_id add_node(string_ref name, cluster_id cluster);
+        void add_edge(node_id from, node_id to, edge_kind kind);
+        cluster_id add_cluster(string_ref name);
+
+        void print_dot(llvm::raw_ostream &os) const;
+
+        std::vector< node > nodes;
+        std::vector< edge > edges;
+        std::vector< std::string > clusters = { "main" };
+    };
+
+    struct pipeline_t;
+
+    //
+    // Independent pipeline forked from the main one. The branch runs on a
+    // clone of the module taken at the point it was scheduled, concurrently
+    // with the rest of the main pipeline if the context is multithreaded.
+    //
+    struct pipeline_branch
+    {
+        pipeline_branch(string_ref name, std::unique_ptr< pipeline_t > pipeline);
+        ~pipeline_branch();
+
+        void start(mlir_module mod);
+
+        // Waits for the branch, fails if it did not run or its pipeline failed.
+        logical_result join();
+
+        std::string name;
+        std::unique_ptr< pipeline_t > pipeline;
+        owning_mlir_module_ref module;
+
+      private:
+        std::future< logical_result > result;
+    };
+
     //
     // pipeline is a pass manager, which keeps track of duplicit passes and does
     // not schedule them twice
@@ -63,13 +127,35 @@ namespace vast {
             }
 
             seen.insert(id);
+            record_steps(id);
             VAST_PIPELINE_DEBUG("scheduling nested pass: {0}", pass->getArgument());
             auto &pm = this->nest< parent_t >();
             pm.addPass(std::move(pass));
         }
 
+        //
+        // Schedules `function_part` on every function of the vast module and
+        // `module_part` on the module itself. Function-level passes are run
+        // in parallel by the pass manager if multithreading is enabled.
+        //
+        void add_function_granular_pass(owning_pass_ptr function_part, owning_pass_ptr module_part);
+
         virtual schedule_result schedule(pipeline_step_ptr step) = 0;
 
+        //
+        // Schedules `branch` to be run on a clone of the module at the current
+        // point of the pipeline.
+        //
+        void fork(std::unique_ptr< pipeline_branch > branch);
+
+        // Creates a pipeline for a branch that records its steps into the
+        // graph of this pipeline.
+        std::unique_ptr< pipeline_t > make_branch(string_ref name);
+
+        virtual std::unique_ptr< pipeline_t > make_empty_pipeline() const = 0;
+
+        logical_result join_branches();
+
         void print_on_error(llvm::raw_ostream &os) {
             enableIRPrinting(
                 [](auto *, auto *) { return false; }, // before
@@ -81,7 +167,46 @@ namespace vast {
             );
         }
 
+        // Names of compound steps the pass was scheduled from, outermost first.
+        llvm::ArrayRef< std::string > steps_of(pass_id_t id) const {
+            if (auto it = pass_steps.find(id); it != pass_steps.end()) {
+                return it->second;
+            }
+            return {};
+        }
+
+        void record_steps(pass_id_t id) { pass_steps.try_emplace(id, compound_steps); }
+
+        //
+        // Step graph bookkeeping: a node is created once the dependencies of
+        // a step are scheduled, and stays open while its substeps are.
+        //
+        step_graph::node_id add_step_node(string_ref name);
+
+        auto open_step(step_graph::node_id node) {
+            open_steps.push_back({ node, std::nullopt });
+            return llvm::make_scope_exit([this] { open_steps.pop_back(); });
+        }
+
         llvm::DenseSet< pass_id_t > seen;
+
+        std::shared_ptr< step_graph > graph = std::make_shared< step_graph >();
+        step_graph::cluster_id cluster = 0;
+
+        struct open_step_t
+        {
+            std::optional< step_graph::node_id > node;
+            std::optional< step_graph::node_id > last_substep;
+        };
+
+        // Steps being scheduled, the first one stands for the whole pipeline.
+        std::vector< open_step_t > open_steps = { open_step_t{} };
+
+        std::vector< std::unique_ptr< pipeline_branch > > branches;
+
+        // Compound steps that are being scheduled.
+        std::vector< std::string > compound_steps;
+        llvm::DenseMap< pass_id_t, std::vector< std::string > > pass_steps;
     };
 
     using pipeline_step_builder = std::function< pipeline_step_ptr(void) >;
@@ -193,6 +318,49 @@ namespace vast {
         }
     };
 
+    //
+    // Pass split into a function-level part, scheduled on every isolated
+    // operation (function) of the module, and a module-level part, which
+    // converts the remaining operations. The pass needs to provide
+    // `skip-functions` option to restrict its module-level instance.
+    //
+    struct function_granular_pass_pipeline_step : pass_pipeline_step
+    {
+        explicit function_granular_pass_pipeline_step(pass_builder_t builder)
+            : pass_pipeline_step(builder)
+        {}
+
+        virtual ~function_granular_pass_pipeline_step() = default;
+
+        schedule_result schedule_on(pipeline_t &ppl) override;
+    };
+
+    //
+    // Steps without ordering constraint towards the rest of the pipeline. They
+    // are scheduled into a separate pipeline that runs on a clone of the
+    // module, e.g., analyses that produce their own results.
+    //
+    struct branch_pipeline_step : pipeline_step
+    {
+        template< typename... steps_t >
+        explicit branch_pipeline_step(string_ref name, steps_t &&...steps)
+            : branch_name(name), steps{ std::forward< steps_t >(steps)... }
+        {}
+
+        virtual ~branch_pipeline_step() = default;
+
+        schedule_result schedule_on(pipeline_t &ppl) override;
+
+        gap::generator< pipeline_step_ptr > substeps() const override;
+
+        string_ref name() const override;
+        string_ref cli_name() const override;
+
+    protected:
+        std::string branch_name;
+        std::vector< pipeline_step_builder > steps;
+    };
+
     // compound step represents subpipeline to be run
     struct compound_pipeline_step : pipeline_step
     {
@@ -236,6 +404,13 @@ namespace vast {
         );
     }
 
+    template< typename... args_t >
+    decltype(auto) function_granular_pass(args_t &&... args) {
+        return pipeline_step_init< function_granular_pass_pipeline_step >(
+            std::forward< args_t >(args)...
+        );
+    }
+
     template< typename... steps_t >
     decltype(auto) compose(string_ref name, steps_t &&...steps) {
         return pipeline_step_init< compound_pipeline_step >(
@@ -243,4 +418,11 @@ namespace vast {
         );
     }
 
+    template< typename... steps_t >
+    decltype(auto) branch(string_ref name, steps_t &&...steps) {
+        return pipeline_step_init< branch_pipeline_step >(
+            name, std::forward< steps_t >(steps)...
+        );
+    }
+
 } // namespace vast
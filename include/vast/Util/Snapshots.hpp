@@ -5,30 +5,160 @@
 #include "vast/Util/Warnings.hpp"
 
 VAST_RELAX_WARNINGS
+#include <llvm/Support/MemoryBuffer.h>
 #include <mlir/Pass/PassInstrumentation.h>
 #include <mlir/Pass/Pass.h>
 VAST_UNRELAX_WARNINGS
 
 #include "vast/Util/Common.hpp"
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
 namespace vast::util {
 
-    struct with_snapshots : mlir::PassInstrumentation
+    enum class snapshot_format { text, bytecode };
+
+    struct snapshot_config
     {
-        using output_stream_ptr = std::shared_ptr< llvm::raw_pwrite_stream >;
+        snapshot_format format = snapshot_format::text;
+        // Compress and write snapshots on a background thread.
+        bool async = false;
+        // Store all snapshots into a single indexed archive instead of one file per pass.
+        bool archive = false;
+        // Compress archive entries if a compression library is available.
+        bool compress = false;
+        // Number of serialized snapshots that can wait for the background writer.
+        std::size_t queue_size = 8;
+    };
 
-        explicit with_snapshots(string_ref file_prefix) : file_prefix(file_prefix) {}
+    //
+    // Destination of serialized snapshots.
+    //
+    struct snapshot_sink
+    {
+        virtual ~snapshot_sink() = default;
+        virtual void write(std::string name, std::string data) = 0;
+    };
 
-        // We return `shared_ptr` in case we may want to keep the stream open
-        // for longer in some derived class. Should not make a difference,
-        // snapshoting will be expensive anyway.
-        virtual output_stream_ptr make_output_stream(pass_ptr pass);
+    using snapshot_sink_ptr = std::unique_ptr< snapshot_sink >;
+
+    //
+    // Writes each snapshot into the file `prefix.name`.
+    //
+    struct snapshot_files : snapshot_sink
+    {
+        snapshot_files(string_ref prefix, string_ref extension)
+            : prefix(prefix), extension(extension)
+        {}
+
+        void write(std::string name, std::string data) override;
+
+        std::string prefix;
+        std::string extension;
+    };
+
+    //
+    // Writes all snapshots into a single archive `prefix.snapshots`:
+    //
+    //   magic "VASTSNAP", entry data..., index, index offset (u64), entry count (u32)
+    //
+    // Each index entry consists of the name (u32 length and bytes), the data
+    // offset and size (u64), the uncompressed size (u64) and the compression
+    // (u8, values of `llvm::compression::Format` + 1, 0 for uncompressed).
+    // All integers are little endian.
+    //
+    struct snapshot_archive_entry
+    {
+        std::string name;
+        std::uint64_t offset;
+        std::uint64_t size;
+        std::uint64_t uncompressed_size;
+        std::uint8_t compression;
+    };
+
+    struct snapshot_archive : snapshot_sink
+    {
+        snapshot_archive(string_ref prefix, bool compress);
+        ~snapshot_archive() override;
+
+        void write(std::string name, std::string data) override;
+
+      private:
+        std::unique_ptr< llvm::raw_fd_ostream > os;
+        std::vector< snapshot_archive_entry > index;
+        bool compress;
+    };
+
+    //
+    // Reads archives written by `snapshot_archive`.
+    //
+    struct snapshot_archive_reader
+    {
+        using entry = snapshot_archive_entry;
+
+        // Returns `std::nullopt` if `path` is not a readable snapshot archive.
+        static std::optional< snapshot_archive_reader > open(string_ref path);
+
+        // Entries in the order the snapshots were taken.
+        const std::vector< entry > &entries() const { return index; }
+
+        // Returns the first entry called `name`.
+        const entry *find(string_ref name) const;
+
+        // Returns the uncompressed data of `e` or `std::nullopt` if it is corrupted.
+        std::optional< std::string > read(const entry &e) const;
+
+      private:
+        std::unique_ptr< llvm::MemoryBuffer > buffer;
+        std::vector< entry > index;
+    };
+
+    //
+    // Hands snapshots over to a background thread that writes them into the
+    // underlying sink. The compiler thread blocks only if the queue is full.
+    //
+    struct async_snapshot_sink : snapshot_sink
+    {
+        async_snapshot_sink(snapshot_sink_ptr sink, std::size_t queue_size);
+        ~async_snapshot_sink() override;
+
+        void write(std::string name, std::string data) override;
+
+      private:
+        void run();
+
+        snapshot_sink_ptr sink;
+        std::size_t queue_size;
+
+        std::mutex mutex;
+        std::condition_variable not_empty;
+        std::condition_variable not_full;
+        std::deque< std::pair< std::string, std::string > > queue;
+        bool done = false;
+
+        std::thread writer;
+    };
+
+    struct with_snapshots : mlir::PassInstrumentation
+    {
+        explicit with_snapshots(string_ref file_prefix, snapshot_config config = {});
 
         virtual bool should_snapshot(pass_ptr pass) const = 0;
 
         void runAfterPass(pass_ptr pass, operation op) override;
 
         std::string file_prefix;
+        snapshot_config config;
+
+      private:
+        std::string serialize(operation op) const;
+
+        // Snapshots of passes running in parallel are written one at a time.
+        std::mutex sink_mutex;
+        snapshot_sink_ptr sink;
     };
 
 
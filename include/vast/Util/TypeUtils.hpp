@@ -5,6 +5,8 @@
 #include <vast/Util/Functions.hpp>
 #include <vast/Util/Common.hpp>
 
+#include <vast/Dialect/Core/CoreAttributes.hpp>
+
 namespace vast
 {
     template< template < typename T > class trait, typename... types >
@@ -57,7 +59,12 @@ namespace vast
         mlir::AttrTypeWalker walker;
         walker.addWalk([&](mlir::Attribute attr) -> mlir::WalkResult
         {
-            if (auto dl_entry = mlir::dyn_cast< mlir::DataLayoutSpecInterface >(attr))
+            if (auto table = mlir::dyn_cast< core::DataLayoutSpecAttr >(attr))
+            {
+                for (const auto &e : table.getLayouts())
+                    found |= accept(e.type);
+            }
+            else if (auto dl_entry = mlir::dyn_cast< mlir::DataLayoutSpecInterface >(attr))
             {
                 for (auto e : dl_entry.getEntries())
                     found |= contains_subtype(e, accept);
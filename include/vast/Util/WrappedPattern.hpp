@@ -0,0 +1,71 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#pragma once
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/SmallVector.h>
+#include <mlir/IR/PatternMatch.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Util/Common.hpp"
+
+namespace vast::util {
+
+    //
+    // Base of patterns that delegate to a wrapped pattern, so that its
+    // applications can be observed without touching the pattern itself.
+    //
+    struct wrapped_pattern : mlir::RewritePattern
+    {
+        template< typename... root_args_t >
+        explicit wrapped_pattern(
+            std::unique_ptr< mlir::RewritePattern > wrapped, root_args_t &&...root_args
+        )
+            : mlir::RewritePattern(std::forward< root_args_t >(root_args)...)
+            , pattern(std::move(wrapped))
+        {
+            setDebugName(pattern->getDebugName());
+            addDebugLabels(pattern->getDebugLabels());
+            setHasBoundedRewriteRecursion(pattern->hasBoundedRewriteRecursion());
+        }
+
+        // Constructs `wrapper_t` from the pattern, `args` and the root of the
+        // pattern. The wrapper has to match the same root as the wrapped
+        // pattern, the driver relies on it to order patterns and to build the
+        // legalization graph.
+        template< typename wrapper_t, typename... args_t >
+        static std::unique_ptr< mlir::RewritePattern > wrap(
+            std::unique_ptr< mlir::RewritePattern > pattern, args_t &&...args
+        ) {
+            auto benefit = pattern->getBenefit();
+            auto mctx    = pattern->getContext();
+
+            llvm::SmallVector< string_ref > generated;
+            for (auto name : pattern->getGeneratedOps()) {
+                generated.push_back(name.getStringRef());
+            }
+
+            auto make = [&](auto &&...root_args) {
+                return std::make_unique< wrapper_t >(
+                    std::move(pattern), args..., root_args..., benefit, mctx, generated
+                );
+            };
+
+            if (auto root = pattern->getRootKind()) {
+                return make(root->getStringRef());
+            }
+            if (auto interface = pattern->getRootInterfaceID()) {
+                return make(MatchInterfaceOpTypeTag(), *interface);
+            }
+            if (auto trait = pattern->getRootTraitID()) {
+                return make(MatchTraitOpTypeTag(), *trait);
+            }
+            return make(MatchAnyOpTypeTag());
+        }
+
+        std::unique_ptr< mlir::RewritePattern > pattern;
+    };
+
+} // namespace vast::util
@@ -66,6 +66,13 @@ namespace vast::repl
             throw_error("uknnown action kind: {0}", token.str());
         }
 
+        template< typename enum_type >
+        enum_type from_string(string_ref token) requires(std::is_same_v< enum_type, tw::storage_mode >) {
+            if (token == "full")  return enum_type::full_clone;
+            if (token == "delta") return enum_type::delta;
+            throw_error("uknnown storage mode: {0}", token.str());
+        }
+
         void analyze_reachable_code(state_t &);
         void analyze_uninitialized_variables(state_t &);
 
@@ -293,7 +300,30 @@ namespace vast::repl
 
         void add_sticky_command(string_ref cmd, state_t &state);
 
-        using command_list = util::type_list< exit, help, load, show, analyze, meta, raise, sticky >;
+        //
+        // storage command
+        //
+        struct storage : base {
+            static constexpr string_ref name() { return "storage"; }
+
+            static constexpr inline char mode_param[] = "storage_mode";
+
+            using command_params =
+                util::type_list< named_param< mode_param, tw::storage_mode > >;
+
+            using params_storage = command_params::as_tuple;
+
+            storage(const params_storage &params) : params(params) {}
+            storage(params_storage &&params) : params(std::move(params)) {}
+
+            void run(state_t &state) const override;
+
+            params_storage params;
+        };
+
+        using command_list = util::type_list<
+            exit, help, load, show, analyze, meta, raise, sticky, storage
+        >;
 
     } // namespace cmd
 
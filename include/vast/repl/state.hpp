@@ -35,6 +35,8 @@ namespace vast::repl {
         //
         tw::location_info_t location_info;
         std::optional< tw::tower > tower;
+        // keep only changes between modules raised by the tower
+        tw::storage_mode tower_storage = tw::storage_mode::delta;
 
         std::unordered_map< std::string, tw::link_ptr > links;
 
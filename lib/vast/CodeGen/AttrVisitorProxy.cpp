@@ -9,7 +9,7 @@
 
 namespace vast::cg
 {
-    operation attr_visitor_proxy::visit_decl_attrs(operation op, const clang_decl *decl, scope_context &scope) {
+    operation attr_visitor_layer::visit_decl_attrs(operation op, const clang_decl *decl, scope_context &scope) {
         if (!decl->hasAttrs()) {
             return op;
         }
@@ -40,11 +40,7 @@ namespace vast::cg
 
 
     operation attr_visitor_proxy::visit(const clang_decl *decl, scope_context &scope) {
-        if (auto op = next->visit(decl, scope)) {
-            return visit_decl_attrs(op, decl, scope);
-        }
-
-        return {};
+        return attr_visitor_layer::visit(decl, scope, next_visitor());
     }
 
 } // namespace vast::cg
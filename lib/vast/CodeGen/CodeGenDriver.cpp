@@ -6,6 +6,7 @@ VAST_RELAX_WARNINGS
 #include <clang/AST/GlobalDecl.h>
 #include <clang/Basic/SourceManager.h>
 #include <clang/Basic/TargetInfo.h>
+#include <llvm/Support/Threading.h>
 #include <mlir/IR/Verifier.h>
 VAST_UNRELAX_WARNINGS
 
@@ -13,6 +14,7 @@ VAST_UNRELAX_WARNINGS
 #include "vast/CodeGen/CodeGenDriver.hpp"
 #include "vast/CodeGen/CodeGenFunction.hpp"
 #include "vast/CodeGen/CodeGenModule.hpp"
+#include "vast/CodeGen/CodeGenVisitorChain.hpp"
 #include "vast/CodeGen/CodeGenVisitorList.hpp"
 #include "vast/CodeGen/DataLayout.hpp"
 #include "vast/CodeGen/DefaultCodeGenPolicy.hpp"
@@ -20,6 +22,7 @@ VAST_UNRELAX_WARNINGS
 #include "vast/CodeGen/DefaultVisitor.hpp"
 #include "vast/CodeGen/IdMetaGenerator.hpp"
 #include "vast/CodeGen/InvalidMetaGenerator.hpp"
+#include "vast/CodeGen/SynchronizedProxy.hpp"
 #include "vast/CodeGen/TypeCachingProxy.hpp"
 #include "vast/CodeGen/UnreachableVisitor.hpp"
 #include "vast/CodeGen/UnsupportedVisitor.hpp"
@@ -28,46 +31,43 @@ VAST_UNRELAX_WARNINGS
 
 namespace vast::cg {
 
+    // The common configuration of visitors, see `mk_visitors`.
+    template< typename... proxies_t >
+    using default_visitor_chain = visitor_chain<
+        attr_visitor_layer, proxies_t..., type_caching_layer,
+        default_visitor, unsup_visitor, unreach_visitor
+    >;
+
     void driver::emit(clang::DeclGroupRef decls) { generator.emit(decls); }
 
     void driver::emit(clang::Decl *decl) { generator.emit(decl); }
 
     owning_mlir_module_ref driver::freeze() { return std::move(top); }
 
-    // TODO this should not be needed the data layout should be emitted from cached types directly
-    dl::DataLayoutBlueprint emit_data_layout_blueprint(
-        const acontext_t &actx, const type_caching_proxy &types
-    ) {
-        dl::DataLayoutBlueprint dl;
-
-        auto store_layout = [&] (const clang_type *orig, mlir_type vast_type) {
-            if (orig->isFunctionType()) {
-                return;
-            }
-
-            // skip forward declared types
-            if (auto tag = orig->getAsTagDecl()) {
-                if (!tag->isThisDeclarationADefinition()) {
-                    return;
-                }
-            }
-
-            dl.try_emplace(vast_type, orig, actx);
-        };
+    void driver::enable_parallel_codegen(unsigned jobs, codegen_worker_factory factory) {
+        codegen_jobs = jobs;
+        mk_worker    = std::move(factory);
+        scope.collect_definitions = true;
+    }
 
-        for (auto [orig, vast_type] : types.cache) {
-            store_layout(orig, vast_type);
-        }
+    void driver::enable_streaming() { scope.collect_definitions = true; }
 
-        for (auto [qual_type, vast_type] : types.qual_cache) {
-            auto [orig, quals] = qual_type.split();
-            store_layout(orig, vast_type);
-        }
+    void driver::emit_definitions(llvm::function_ref< void(vast_function) > emitted) {
+        generator.emit_definitions(std::exchange(scope.definitions, {}), emitted);
+    }
 
-        return dl;
+    void driver::emit_definitions() {
+        // Workers record types to the layouts shared with the driver visitors.
+        generator.emit_definitions(
+            std::exchange(scope.definitions, {}), codegen_jobs, mk_worker
+        );
     }
 
     void driver::finalize() {
+        if (scope.collect_definitions) {
+            emit_definitions();
+        }
+
         generator.finalize();
 
         emit_data_layout();
@@ -79,14 +79,9 @@ namespace vast::cg {
         }
     }
 
-    void driver::emit_data_layout() {
-        auto list = std::dynamic_pointer_cast< visitor_list >(visitor);
-        for (auto node = list->head; node; node = node->next) {
-            if (auto types = std::dynamic_pointer_cast< type_caching_proxy >(node)) {
-                ::vast::cg::emit_data_layout(mctx, mod, emit_data_layout_blueprint(actx, *types));
-            }
-        }
-    }
+    void driver::emit_data_layout() { layouts->emit(mctx, mod); }
+
+    void driver::emit_data_layout(core::module part) { layouts->emit_referenced(mctx, part); }
 
     bool driver::verify() { return mlir::verify(mod).succeeded(); }
 
@@ -100,7 +95,15 @@ namespace vast::cg {
         if (vargs.has_option(cc::opt::locs_as_meta_ids)) {
             return std::make_shared< id_meta_gen >(actx, mctx);
         }
-        return std::make_shared< default_meta_gen >(actx, mctx);
+
+        auto granularity = location_granularity::column;
+        if (auto value = vargs.get_option(cc::opt::locs_granularity)) {
+            auto parsed = parse_location_granularity(*value);
+            VAST_CHECK(parsed, "invalid location granularity: {0}", *value);
+            granularity = *parsed;
+        }
+
+        return std::make_shared< default_meta_gen >(actx, mctx, granularity);
     }
 
     std::shared_ptr< meta_generator > mk_invalid_meta_generator(mcontext_t *mctx) {
@@ -115,6 +118,90 @@ namespace vast::cg {
         return std::make_shared< default_policy >(opts);
     }
 
+    visitor_list_ptr mk_visitor_list(
+        acontext_t &actx, mcontext_t &mctx, codegen_builder &bld, bool enable_unsupported,
+        std::shared_ptr< meta_generator > mg, std::shared_ptr< symbol_generator > sg,
+        std::shared_ptr< codegen_policy > policy, std::shared_ptr< type_layouts > layouts
+    ) {
+        auto invalid_mg = mk_invalid_meta_generator(&mctx);
+
+        return std::make_shared< visitor_list >()
+            | as_node_with_list_ref< attr_visitor_proxy >()
+            | optional(bool(bld.shared_mutex),
+                as_node< synchronized_proxy >(bld.shared_mutex)
+            )
+            | as_node< type_caching_proxy >(std::move(layouts))
+            | as_node_with_list_ref< default_visitor >(
+                mctx, actx, bld, std::move(mg), std::move(sg), std::move(policy)
+            )
+            | optional(enable_unsupported,
+                as_node_with_list_ref< unsup_visitor >(
+                    mctx, bld, std::move(invalid_mg)
+                )
+            )
+            | as_node< unreach_visitor >();
+    }
+
+    template< typename... proxies_t >
+    std::shared_ptr< visitor_base > mk_visitor_chain(
+        acontext_t &actx, mcontext_t &mctx, codegen_builder &bld,
+        std::shared_ptr< meta_generator > mg, std::shared_ptr< symbol_generator > sg,
+        std::shared_ptr< codegen_policy > policy, std::shared_ptr< type_layouts > layouts,
+        auto &&... proxies
+    ) {
+        auto invalid_mg = mk_invalid_meta_generator(&mctx);
+
+        return std::make_shared< default_visitor_chain< proxies_t... > >(
+              as_layer_with_list_ref< attr_visitor_layer >()
+            , proxies...
+            , as_layer< type_caching_layer >(std::move(layouts))
+            , as_layer_with_list_ref< default_visitor >(
+                mctx, actx, bld, std::move(mg), std::move(sg), std::move(policy)
+            )
+            , as_layer_with_list_ref< unsup_visitor >(mctx, bld, std::move(invalid_mg))
+            , as_layer< unreach_visitor >()
+        );
+    }
+
+    // The common configuration is composed at compile time, the visitor list
+    // serves the rest and can be requested to compare the two.
+    std::shared_ptr< visitor_base > mk_visitors(
+        acontext_t &actx, mcontext_t &mctx, codegen_builder &bld,
+        bool enable_unsupported, bool dynamic_list,
+        std::shared_ptr< meta_generator > mg, std::shared_ptr< symbol_generator > sg,
+        std::shared_ptr< codegen_policy > policy, std::shared_ptr< type_layouts > layouts
+    ) {
+        if (!enable_unsupported || dynamic_list) {
+            return mk_visitor_list(
+                actx, mctx, bld, enable_unsupported,
+                std::move(mg), std::move(sg), std::move(policy), std::move(layouts)
+            );
+        }
+
+        if (bld.shared_mutex) {
+            return mk_visitor_chain< synchronized_layer >(
+                actx, mctx, bld, std::move(mg), std::move(sg), std::move(policy),
+                std::move(layouts), as_layer< synchronized_layer >(bld.shared_mutex)
+            );
+        }
+
+        return mk_visitor_chain<>(
+            actx, mctx, bld, std::move(mg), std::move(sg), std::move(policy),
+            std::move(layouts)
+        );
+    }
+
+    unsigned get_codegen_jobs(const cc::vast_args &vargs) {
+        auto value = vargs.get_option(cc::opt::codegen_jobs);
+        if (!value) {
+            return 1;
+        }
+
+        unsigned jobs = 0;
+        VAST_CHECK(!value->getAsInteger(10, jobs), "invalid number of codegen jobs: {0}", *value);
+        return jobs ? jobs : llvm::hardware_concurrency().compute_thread_count();
+    }
+
     std::unique_ptr< driver > mk_default_driver(
         cc::action_options &opts, const cc::vast_args &vargs, acontext_t &actx, mcontext_t &mctx
     ) {
@@ -122,31 +209,40 @@ namespace vast::cg {
 
         // setup visitor list
         const bool enable_unsupported = !vargs.has_option(cc::opt::disable_unsupported);
+        const bool dynamic_list = vargs.has_option(cc::opt::dynamic_visitor_list);
 
         auto mg = mk_meta_generator(&actx, &mctx, vargs);
-        auto invalid_mg = mk_invalid_meta_generator(&mctx);
         auto sg = mk_symbol_generator(actx);
         auto policy = mk_codegen_policy(opts);
+        auto layouts = std::make_shared< type_layouts >(actx);
 
-        auto visitors = std::make_shared< visitor_list >()
-            | as_node_with_list_ref< attr_visitor_proxy >()
-            | as_node< type_caching_proxy >()
-            | as_node_with_list_ref< default_visitor >(
-                mctx, actx, *bld, std::move(mg), std::move(sg), std::move(policy)
-            )
-            | optional(enable_unsupported,
-                as_node_with_list_ref< unsup_visitor >(
-                    mctx, *bld, std::move(invalid_mg)
-                )
-            )
-            | as_node< unreach_visitor >();
+        auto visitors = mk_visitors(
+            actx, mctx, *bld, enable_unsupported, dynamic_list, mg, sg, policy, layouts
+        );
 
         // setup driver
         auto drv = std::make_unique< driver >(
-            actx, mctx, std::move(bld), visitors
+            actx, mctx, std::move(bld), visitors, layouts
         );
 
         drv->enable_verifier(!vargs.has_option(cc::opt::disable_vast_verifier));
+
+        // Workers share the generators, their queries are serialized.
+        auto threaded = mctx.isMultithreadingEnabled()
+            && !vargs.has_option(cc::opt::disable_multithreading);
+        if (auto jobs = get_codegen_jobs(vargs); jobs > 1 && threaded) {
+            auto shared_mutex = std::make_shared< std::recursive_mutex >();
+            drv->enable_parallel_codegen(jobs, [=, &actx, &mctx] {
+                auto worker_bld = mk_codegen_builder(mctx);
+                worker_bld->shared_mutex = shared_mutex;
+                auto worker_visitors = mk_visitors(
+                    actx, mctx, *worker_bld, enable_unsupported, dynamic_list,
+                    mg, sg, policy, layouts
+                );
+                return codegen_worker{ std::move(worker_bld), std::move(worker_visitors) };
+            });
+        }
+
         return drv;
     }
 
@@ -63,6 +63,11 @@ namespace vast::cg
 
     operation function_generator::emit(const clang_function *decl) {
         auto prototype = [&] {
+            // Codegen workers reach this for block scope declarations. The
+            // function lives in the shared module and the linkage queries
+            // fill lazy caches of the shared AST context.
+            auto lock = bld.lock_shared();
+
             if (auto symbol = visitor.symbol(decl)) {
                 if (auto op = visitor.scope.lookup_fun(decl)) {
                     auto fn        = mlir::cast< vast_function >(op);
@@ -116,33 +121,44 @@ namespace vast::cg
         if (decl->isThisDeclarationADefinition()) {
             // Unsupported functions might produce unsupported decl
             if (auto fn = mlir::dyn_cast< vast_function >(prototype)) {
-                defer([parent = *this, decl, fn]() mutable {
-                    // If the user implements a function that is also a builtin,
-                    // it might be visited multiple times
-                    if (fn.getBody().empty()) {
-                        if (!parent.policy->skip_function_body(decl)) {
-                            set_visibility(decl, fn);
-                            if (!decl->hasDefiningAttr()) {
-                                parent.declare_function_params(decl, fn);
-                                parent.emit_labels(decl, fn);
-                                parent.emit_body(decl, fn);
-                            }
-                        } else {
-                            // If we skip the function body, then we must set
-                            // the visibility to private because the verifier
-                            // will fail it it sees a public function
-                            // declaration without a body.
-                            auto visibility = mlir_visibility::Private;
-                            mlir::SymbolTable::setSymbolVisibility(fn, visibility);
-                        }
-                    }
-                });
+                auto mod = dynamic_cast< module_scope * >(&scope().root());
+                if (mod && mod->collect_definitions) {
+                    mod->definitions.push_back({ decl, fn, policy });
+                } else {
+                    defer([parent = *this, decl, fn]() mutable {
+                        parent.emit_definition(decl, fn);
+                    });
+                }
             }
         }
 
         return prototype;
     }
 
+    void function_generator::emit_definition(const clang_function *decl, vast_function fn) {
+        // If the user implements a function that is also a builtin,
+        // it might be visited multiple times
+        if (!fn.getBody().empty()) {
+            return;
+        }
+
+        if (!policy->skip_function_body(decl)) {
+            set_visibility(decl, fn);
+            if (!decl->hasDefiningAttr()) {
+                declare_function_params(decl, fn);
+                emit_labels(decl, fn);
+                emit_body(decl, fn);
+            }
+        } else {
+            // If we skip the function body, then we must set
+            // the visibility to private because the verifier
+            // will fail it it sees a public function
+            // declaration without a body.
+            auto visibility = mlir_visibility::Private;
+            mlir::SymbolTable::setSymbolVisibility(fn, visibility);
+        }
+    }
+
     void function_generator::declare_function_params(const clang_function *decl, vast_function fn) {
         auto *entry_block = fn.addEntryBlock();
         auto params = llvm::zip(decl->parameters(), entry_block->getArguments());
@@ -2,6 +2,13 @@
 
 #include "vast/CodeGen/CodeGenModule.hpp"
 
+VAST_RELAX_WARNINGS
+#include <clang/AST/ParentMapContext.h>
+#include <clang/AST/RecursiveASTVisitor.h>
+#include <llvm/ADT/DenseSet.h>
+#include <mlir/IR/Threading.h>
+VAST_UNRELAX_WARNINGS
+
 #include "vast/CodeGen/DataLayout.hpp"
 #include "vast/CodeGen/CodeGenFunction.hpp"
 
@@ -10,8 +17,56 @@
 
 #include "vast/Util/Common.hpp"
 
+#include <atomic>
+#include <tuple>
+
 namespace vast::cg
 {
+    namespace {
+
+        // Calls to builtins declare the builtin at the start of the module,
+        // uses of `va_list` declare its builtin typedef.
+        struct builtin_callees : clang::RecursiveASTVisitor< builtin_callees >
+        {
+            explicit builtin_callees(const clang::ASTContext &actx)
+                : va_list(actx.getBuiltinVaListType().getCanonicalType())
+            {}
+
+            bool VisitTypedefType(clang::TypedefType *ty) {
+                uses_va_list |= ty->getCanonicalTypeInternal() == va_list;
+                return true;
+            }
+
+            bool VisitCallExpr(clang::CallExpr *expr) {
+                if (auto callee = expr->getDirectCallee(); callee && callee->getBuiltinID()) {
+                    if (seen.insert(callee).second) {
+                        callees.push_back(callee);
+                    }
+                }
+                return true;
+            }
+
+            llvm::SmallPtrSet< const clang_function *, 8 > seen;
+            std::vector< const clang_function * > callees;
+
+            clang::QualType va_list;
+            bool uses_va_list = false;
+        };
+
+        bool emits_body(const deferred_definition &def) {
+            return !def.policy->skip_function_body(def.decl) && !def.decl->hasDefiningAttr();
+        }
+
+        // Functions visited multiple times are defined only once.
+        void remove_redefinitions(std::vector< deferred_definition > &definitions) {
+            llvm::DenseSet< operation > defined;
+            std::erase_if(definitions, [&] (const auto &def) {
+                return !defined.insert(def.fn).second;
+            });
+        }
+
+    } // namespace
+
     //
     // Module Generator
     //
@@ -25,4 +80,90 @@ namespace vast::cg
 
     void module_generator::finalize() { scope().finalize(); }
 
+    void module_generator::emit_definitions(
+        std::vector< deferred_definition > definitions,
+        unsigned jobs, const codegen_worker_factory &factory
+    ) {
+        remove_redefinitions(definitions);
+        if (definitions.empty()) {
+            return;
+        }
+
+        // Workers emit only into bodies of their functions. Builtins that the
+        // bodies call are declared upfront in the order of definitions, so
+        // the module does not depend on the scheduling of workers.
+        auto &actx = definitions.front().decl->getASTContext();
+
+        builtin_callees builtins(actx);
+        for (const auto &def : definitions) {
+            if (emits_body(def)) {
+                builtins.TraverseStmt(def.decl->getBody());
+            }
+        }
+
+        for (auto callee : builtins.callees) {
+            auto _ = bld.set_insertion_point_to_start_of_module();
+            visitor.visit(callee);
+        }
+
+        if (builtins.uses_va_list) {
+            auto _ = bld.set_insertion_point_to_start_of_module();
+            visitor.visit(actx.getBuiltinVaListDecl());
+        }
+
+        // The parent map is built by its first query, workers only read it.
+        std::ignore = actx.getParents(*definitions.front().decl);
+
+        std::vector< codegen_worker > workers;
+        auto count = std::min< std::size_t >(std::max(jobs, 1u), definitions.size());
+        for (std::size_t idx = 0; idx < count; ++idx) {
+            workers.push_back(factory());
+            workers.back().bld->module = bld.module;
+        }
+
+        std::atomic< std::size_t > next = 0;
+        mlir::parallelFor(bld.getContext(), 0, workers.size(), [&] (std::size_t idx) {
+            auto &worker = workers[idx];
+
+            // Function-local symbols are declared in tables of the worker,
+            // module symbols are only looked up.
+            symbol_tables symbols;
+            symbols.shared = &scope().symbols;
+            module_scope root(symbols);
+
+            for (auto def = next++; def < definitions.size(); def = next++) {
+                auto gen = mk_scoped_generator< function_generator >(
+                    root, *worker.bld, visitor_view(*worker.visitor)
+                );
+                gen.policy = definitions[def].policy;
+                gen.emit_definition(
+                    definitions[def].decl, mlir::cast< vast_function >(definitions[def].fn)
+                );
+
+                // Leave scopes of the function.
+                root.finalize();
+            }
+        });
+    }
+
+    void module_generator::emit_definitions(
+        std::vector< deferred_definition > definitions,
+        llvm::function_ref< void(vast_function) > emitted
+    ) {
+        remove_redefinitions(definitions);
+        for (const auto &def : definitions) {
+            auto fn  = mlir::cast< vast_function >(def.fn);
+            auto gen = mk_scoped_generator< function_generator >(*this);
+            gen.policy = def.policy;
+            gen.emit_definition(def.decl, fn);
+
+            // Leave scopes of the function.
+            scope().finalize();
+
+            if (!fn.getBody().empty()) {
+                emitted(fn);
+            }
+        }
+    }
+
 } // namespace vast::cg
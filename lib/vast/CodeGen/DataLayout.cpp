@@ -2,16 +2,127 @@
 
 #include "vast/CodeGen/DataLayout.hpp"
 
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/Support/raw_ostream.h>
+#include <mlir/IR/AttrTypeSubElements.h>
+VAST_UNRELAX_WARNINGS
+
+#include <string>
+#include <tuple>
+
 namespace vast::cg
 {
     void emit_data_layout(mcontext_t &ctx, core::module mod, const dl::DataLayoutBlueprint &dl) {
-        std::vector< mlir::DataLayoutEntryInterface > entries;
-        for (const auto &[_, e] : dl.entries) {
-            entries.push_back(e.wrap(ctx));
+        mod->setAttr(core::CoreDialect::getDataLayoutAttrName(), dl.wrap(ctx));
+    }
+
+    void type_layouts::record(const clang_type *type, mlir_type vast_type) {
+        if (type->isFunctionType()) {
+            return;
+        }
+
+        std::scoped_lock lock(mutex);
+        pending.emplace_back(type, vast_type);
+    }
+
+    void type_layouts::resolve() {
+        auto is_defined = [] (const clang_type *type) {
+            auto tag = type->getAsTagDecl();
+            return !tag || tag->isThisDeclarationADefinition();
+        };
+
+        // Types are recorded in the order codegen workers happen to generate
+        // them, entries are added ordered by the printed type and the layout,
+        // so that neither the emitted layout nor the entry kept for a type
+        // recorded several times depends on the scheduling.
+        std::vector< std::tuple< std::string, uint64_t, unsigned, mlir_type, clang::TypeInfo > > ordered;
+        std::vector< std::pair< const clang_type *, mlir_type > > undefined;
+        ordered.reserve(pending.size());
+        for (auto [type, vast_type] : pending) {
+            // Forward declared types wait for their definition.
+            if (!is_defined(type)) {
+                undefined.emplace_back(type, vast_type);
+                continue;
+            }
+
+            auto [it, inserted] = infos.try_emplace(type);
+            if (inserted) {
+                it->second = actx.getTypeInfo(type);
+            }
+
+            std::string key;
+            llvm::raw_string_ostream os(key);
+            vast_type.print(os);
+
+            const auto &info = it->second;
+            ordered.emplace_back(std::move(key), info.Width, info.Align, vast_type, info);
+        }
+
+        llvm::sort(ordered, [] (const auto &lhs, const auto &rhs) {
+            return std::tie(std::get< 0 >(lhs), std::get< 1 >(lhs), std::get< 2 >(lhs))
+                 < std::tie(std::get< 0 >(rhs), std::get< 1 >(rhs), std::get< 2 >(rhs));
+        });
+
+        for (const auto &[key, width, align, vast_type, info] : ordered) {
+            changed |= blueprint.try_emplace(vast_type, info);
+        }
+
+        pending = std::move(undefined);
+    }
+
+    void type_layouts::emit(mcontext_t &mctx, core::module mod) {
+        std::scoped_lock lock(mutex);
+        resolve();
+
+        if (changed || !mod->hasAttr(core::CoreDialect::getDataLayoutAttrName())) {
+            emit_data_layout(mctx, mod, blueprint);
+            changed = false;
+        }
+    }
+
+    void type_layouts::emit_referenced(mcontext_t &mctx, core::module mod) {
+        std::scoped_lock lock(mutex);
+        resolve();
+
+        llvm::DenseSet< mlir_type > referenced;
+        mlir::AttrTypeWalker walker;
+        walker.addWalk([&] (mlir_type type) { referenced.insert(type); });
+
+        // Operand types are results or block arguments of the walked operations.
+        mod->walk([&] (operation op) {
+            walker.walk(op->getAttrDictionary());
+            for (auto type : op->getResultTypes()) {
+                walker.walk(type);
+            }
+            for (auto &region : op->getRegions()) {
+                for (auto &block : region) {
+                    for (auto type : block.getArgumentTypes()) {
+                        walker.walk(type);
+                    }
+                }
+            }
+        });
+
+        // Entries keep the order of the full table.
+        std::vector< std::size_t > kept;
+        for (auto type : referenced) {
+            if (auto it = blueprint.entries.find(type); it != blueprint.entries.end()) {
+                kept.push_back(static_cast< std::size_t >(it - blueprint.entries.begin()));
+            }
+        }
+        llvm::sort(kept);
+
+        std::vector< core::type_layout > layouts;
+        layouts.reserve(kept.size());
+        for (auto idx : kept) {
+            layouts.push_back(blueprint.entries.begin()[idx].second.layout());
         }
 
         mod->setAttr(
-            mlir::DLTIDialect::kDataLayoutAttrName, mlir::DataLayoutSpecAttr::get(&ctx, entries)
+            core::CoreDialect::getDataLayoutAttrName(),
+            core::DataLayoutSpecAttr::get(&mctx, layouts)
         );
     }
 
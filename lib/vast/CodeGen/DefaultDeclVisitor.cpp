@@ -217,6 +217,8 @@ namespace vast::cg {
         };
 
         auto linkage_builder = [&](const clang::VarDecl *decl) {
+            // the query fills lazy caches of the AST context shared by codegen workers
+            auto lock = bld.lock_shared();
             auto gva_linkage = decl->getASTContext().GetGVALinkageForVariable(decl);
             return core::get_declarator_linkage(
                 decl,
@@ -226,6 +228,8 @@ namespace vast::cg {
             );
         };
 
+        auto linkage = is_global ? std::optional(linkage_builder(decl)) : std::nullopt;
+
         auto var = maybe_declare(decl, [&] {
             return bld.compose< hl::VarDeclOp >()
                 .bind(self.location(decl))
@@ -234,7 +238,7 @@ namespace vast::cg {
                 .bind_always(storage_class(decl))
                 .bind_always(thread_storage_class(decl))
                 .bind_always(decl->getType().isConstQualified())
-                .bind_choose(is_global, std::optional(linkage_builder(decl)), std::nullopt)
+                .bind_choose(is_global, linkage, std::nullopt)
                 // FIXME: The initializer region is filled later as it might
                 // have references to the VarDecl we are currently
                 // visiting - int *x = malloc(sizeof(*x))
@@ -0,0 +1,125 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/CodeGen/DefaultMetaGenerator.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/StringSwitch.h>
+VAST_UNRELAX_WARNINGS
+
+namespace vast::cg
+{
+    std::optional< location_granularity > parse_location_granularity(string_ref value) {
+        return llvm::StringSwitch< std::optional< location_granularity > >(value)
+            .Case("column", location_granularity::column)
+            .Case("line", location_granularity::line)
+            .Case("function", location_granularity::function)
+            .Default(std::nullopt);
+    }
+
+    loc_t default_meta_gen::location(const clang_decl *decl) const {
+        if (granularity == location_granularity::function) {
+            if (auto fn = enclosing_function(decl)) {
+                return location(fn->getLocation());
+            }
+        }
+        return location(decl->getLocation());
+    }
+
+    loc_t default_meta_gen::location(const clang_stmt *stmt) const {
+        if (granularity == location_granularity::function) {
+            if (auto fn = enclosing_function(stmt)) {
+                return location(fn->getLocation());
+            }
+        }
+        return location(stmt->getBeginLoc());
+    }
+
+    loc_t default_meta_gen::location(const clang_expr *expr) const {
+        if (granularity == location_granularity::function) {
+            if (auto fn = enclosing_function(expr)) {
+                return location(fn->getLocation());
+            }
+        }
+        return location(expr->getExprLoc());
+    }
+
+    loc_t default_meta_gen::location(clang::SourceLocation loc) const {
+        if (loc.isInvalid()) {
+            return mlir::UnknownLoc::get(mctx);
+        }
+
+        auto key = loc.getRawEncoding();
+        if (auto it = locations.find(key); it != locations.end()) {
+            return it->second;
+        }
+
+        auto result = make_location(loc);
+        locations.try_emplace(key, result);
+        return result;
+    }
+
+    loc_t default_meta_gen::make_location(clang::SourceLocation loc) const {
+        clang::FullSourceLoc full(loc, actx->getSourceManager());
+        auto file = filename(full.getFileID());
+        auto line = full.getLineNumber();
+        // Column lookup is skipped altogether for coarse locations.
+        auto col  = granularity == location_granularity::column ? full.getColumnNumber() : 0;
+        return { mlir::FileLineColLoc::get(file, line, col) };
+    }
+
+    mlir::StringAttr default_meta_gen::filename(clang::FileID id) const {
+        auto [it, inserted] = filenames.try_emplace(id, mlir::StringAttr());
+        if (inserted) {
+            auto entry = actx->getSourceManager().getFileEntryRefForID(id);
+            it->second = mlir::StringAttr::get(mctx, entry ? entry->getName() : "unknown");
+        }
+        return it->second;
+    }
+
+    const clang_decl *default_meta_gen::enclosing_function(const clang_decl *decl) const {
+        if (clang::isa< clang::FunctionDecl >(decl)) {
+            return decl;
+        }
+
+        if (auto ctx = decl->getParentFunctionOrMethod()) {
+            return clang_decl::castFromDeclContext(ctx);
+        }
+
+        return nullptr;
+    }
+
+    const clang_decl *default_meta_gen::enclosing_function(const clang_stmt *stmt) const {
+        // Walks up the parent map until the first declaration, statements on
+        // the way are resolved at once.
+        llvm::SmallVector< const clang_stmt * > path;
+        const clang_decl *result = nullptr;
+
+        for (auto node = stmt; node; ) {
+            if (auto it = functions.find(node); it != functions.end()) {
+                result = it->second;
+                break;
+            }
+
+            path.push_back(node);
+
+            auto parents = actx->getParents(*node);
+            if (parents.empty()) {
+                break;
+            }
+
+            if (auto decl = parents[0].get< clang_decl >()) {
+                result = enclosing_function(decl);
+                break;
+            }
+
+            node = parents[0].get< clang_stmt >();
+        }
+
+        for (auto node : path) {
+            functions[node] = result;
+        }
+
+        return result;
+    }
+
+} // namespace vast::cg
@@ -973,6 +973,7 @@ namespace vast::cg
     operation default_stmt_visitor::mk_direct_call(const clang::CallExpr *expr) {
         if (auto callee = expr->getDirectCallee()) {
             if (callee->getBuiltinID()) {
+                auto lock = bld.lock_shared();
                 auto _ = bld.set_insertion_point_to_start_of_module();
                 self.visit(callee);
             }
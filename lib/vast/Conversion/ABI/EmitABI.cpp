@@ -5,6 +5,7 @@
 VAST_RELAX_WARNINGS
 #include <mlir/Analysis/DataLayoutAnalysis.h>
 #include <mlir/IR/PatternMatch.h>
+#include <mlir/IR/Threading.h>
 #include <mlir/Transforms/GreedyPatternRewriteDriver.h>
 #include <mlir/Transforms/DialectConversion.h>
 #include <mlir/Dialect/LLVMIR/LLVMDialect.h>
@@ -14,6 +15,8 @@ VAST_RELAX_WARNINGS
 #include <mlir/Rewrite/PatternApplicator.h>
 
 #include <llvm/ADT/APFloat.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/MapVector.h>
 VAST_UNRELAX_WARNINGS
 
 #include "../PassesDetails.hpp"
@@ -26,6 +29,7 @@ VAST_UNRELAX_WARNINGS
 #include "vast/Dialect/HighLevel/HighLevelAttributes.hpp"
 #include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
 #include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Dialect/HighLevel/HighLevelRecordLayout.hpp"
 
 #include "vast/Dialect/Core/CoreOps.hpp"
 
@@ -44,6 +48,7 @@ VAST_UNRELAX_WARNINGS
 #include <gap/core/overloads.hpp>
 
 #include <iostream>
+#include <optional>
 #include <unordered_map>
 
 namespace vast
@@ -58,23 +63,75 @@ namespace vast
         return out;
     }
 
+    // Keyed by symbol names interned in the context.
     template< typename Op >
-    using abi_info_map_t = std::unordered_map< std::string, abi::func_info< Op > >;
+    using abi_info_map_t = llvm::DenseMap< mlir::StringAttr, abi::func_info< Op > >;
 
-    template< typename R, typename RootOp, typename DL >
-    auto collect_abi_info(RootOp root_op, const DL &dl)
+    static mlir::StringAttr symbol_name_attr(operation op)
+    {
+        auto name = mlir::cast< core::func_symbol >(op).getSymbolName();
+        return mlir::StringAttr::get(op->getContext(), name);
+    }
+
+    static mlir::DataLayout data_layout_at_or_above(operation op)
+    {
+        auto scope = mlir::dyn_cast< mlir::DataLayoutOpInterface >(op);
+        if (!scope)
+            scope = op->getParentOfType< mlir::DataLayoutOpInterface >();
+        return scope ? mlir::DataLayout(scope) : mlir::DataLayout();
+    }
+
+    // Record types of a signature are looked up from the function, local
+    // declarations of which might shadow them.
+    static bool resolves_types_locally(operation fn, mlir_type type)
+    {
+        bool has_records = false;
+        type.walk([&](hl::RecordType) { has_records = true; });
+        if (!has_records)
+            return false;
+
+        return fn->walk([](core::type_symbol) {
+            return mlir::WalkResult::interrupt();
+        }).wasInterrupted();
+    }
+
+    // Functions sharing a signature are classified once. The data layout is
+    // the same for all functions of the root, so the function type identifies
+    // the classification, unless the function resolves its types locally.
+    // Distinct signatures are classified in parallel.
+    template< typename R, typename RootOp >
+    auto collect_abi_info(RootOp root_op, hl::record_layout_cache &layouts)
         -> abi_info_map_t< R >
     {
-        abi_info_map_t< R > out;
-        auto gather = [&](R op, const mlir::WalkStage &)
-        {
-            auto name = mlir::cast< core::func_symbol >(op.getOperation()).getSymbolName();
-            out.emplace( name.str(), abi::make_x86_64(op, dl) );
+        using signature_t = std::pair< mlir_type, operation >;
+
+        llvm::MapVector< signature_t, llvm::SmallVector< R, 1 > > signatures;
+        root_op->walk([&](R op) {
+            auto type  = op.getFunctionType();
+            auto scope = resolves_types_locally(op, type) ? op.getOperation() : nullptr;
+            signatures[{ type, scope }].push_back(op);
+        });
 
-            return mlir::WalkResult::advance();
+        std::vector< std::optional< abi::func_info< R > > > classified(signatures.size());
+        auto classify = [&](std::size_t idx)
+        {
+            // `mlir::DataLayout` caches queries, each classification has its own.
+            auto dl = data_layout_at_or_above(root_op);
+            auto fn = (signatures.begin() + idx)->second.front();
+            classified[idx].emplace(abi::make_x86_64(fn, dl, layouts));
         };
 
-        root_op->walk(gather);
+        mlir::parallelFor(root_op->getContext(), 0, signatures.size(), classify);
+
+        abi_info_map_t< R > out;
+        for (const auto &[idx, signature] : llvm::enumerate(signatures)) {
+            for (auto fn : signature.second) {
+                auto info   = *classified[idx];
+                info.raw_fn = fn;
+                out.try_emplace(symbol_name_attr(fn), std::move(info));
+            }
+        }
+
         return out;
     }
 
@@ -82,6 +139,10 @@ namespace vast
 
     namespace
     {
+        // Rewrites are driven by `EmitABI` directly, not by the conversion driver.
+        template< typename op_t >
+        using rewrite_state = match_and_rewrite_state_capture< op_t, mlir::RewriterBase >;
+
         template< typename Self >
         struct abi_info_utils
         {
@@ -188,10 +249,10 @@ namespace vast
         };
 
         template< typename op_t >
-        struct abi_transform : match_and_rewrite_state_capture< op_t >,
+        struct abi_transform : rewrite_state< op_t >,
                                abi_info_utils< abi_transform< op_t > >
         {
-            using state_t = match_and_rewrite_state_capture< op_t >;
+            using state_t = rewrite_state< op_t >;
             using abi_utils = abi_info_utils< abi_transform< op_t > >;
             using abi_info_t = typename abi_utils::abi_info_t;
 
@@ -368,9 +429,9 @@ namespace vast
 
         template< typename op_t >
         struct call_wrapper : abi_info_utils< call_wrapper< op_t > >,
-                              match_and_rewrite_state_capture< op_t >
+                              rewrite_state< op_t >
         {
-            using state_t = match_and_rewrite_state_capture< op_t >;
+            using state_t = rewrite_state< op_t >;
 
             using abi_utils = abi_info_utils< call_wrapper< op_t > >;
             using abi_info_t = typename abi_utils::abi_info_t;
@@ -587,9 +648,9 @@ namespace vast
         template< typename op_t >
         struct return_wrapper
             : abi_info_utils< return_wrapper< op_t > >
-            , match_and_rewrite_state_capture< op_t >
+            , rewrite_state< op_t >
         {
-            using state_t = match_and_rewrite_state_capture< op_t >;
+            using state_t = rewrite_state< op_t >;
 
             using abi_utils = abi_info_utils< return_wrapper< op_t > >;
             using abi_info_t = typename abi_utils::abi_info_t;
@@ -684,198 +745,173 @@ namespace vast
 
         };
 
-        template< typename op_t >
-        struct func_type : mlir::OpConversionPattern< op_t >
-        {
-            using base = mlir::OpConversionPattern< op_t >;
-            using adaptor_t = typename op_t::Adaptor;
-
-            const func_abi_info_t &abi_info_map;
+        using abi_info_t = abi::func_info< core::function_op_interface >;
 
-            func_type(const func_abi_info_t &abi_info_map, mcontext_t &mctx)
-                : base(&mctx), abi_info_map(abi_info_map)
-            {}
-
-            logical_result matchAndRewrite(
-                op_t op, adaptor_t ops, conversion_rewriter &rewriter
-            ) const override {
-                auto abi_map_it = abi_info_map.find(op.getSymbolName().str());
-                if (abi_map_it == abi_info_map.end())
-                    return mlir::failure();
-
-                const auto &abi_info = abi_map_it->second;
-                abi_transform< op_t >({ op, ops, rewriter }, abi_info).make();
-                rewriter.eraseOp(op);
-                return mlir::success();
-            }
-        };
-
-        struct call_op : mlir::OpConversionPattern< hl::CallOp >
+        //
+        // Everything EmitABI rewrites, gathered by a single walk of the module.
+        // Calls and returns are rewritten before the functions, the bodies of
+        // which are cloned into the new `abi.func`.
+        //
+        struct abi_worklist
         {
-            using op_t = hl::CallOp;
-            using base = mlir::OpConversionPattern< op_t >;
-            using adaptor_t = typename op_t::Adaptor;
-
-            const func_abi_info_t &abi_info_map;
-
-            call_op(const func_abi_info_t &abi_info_map, mcontext_t &mctx)
-                : base(&mctx), abi_info_map(abi_info_map)
-            {}
-
-            logical_result matchAndRewrite(
-                op_t op, adaptor_t ops, conversion_rewriter &rewriter
-            ) const override {
-                auto abi_map_it = abi_info_map.find(op.getCallee().str());
-                if (abi_map_it == abi_info_map.end())
-                    return mlir::failure();
-
-                const auto &abi_info = abi_map_it->second;
-                auto call = call_wrapper< op_t >({op, ops, rewriter}, abi_info).make();
-                rewriter.replaceOp(op, call);
-                return mlir::success();
-            }
+            std::vector< hl::CallOp > calls;
+            std::vector< std::pair< operation, core::function_op_interface > > returns;
+            std::vector< core::function_op_interface > functions;
+            std::size_t visited = 0;
         };
 
-        template< typename op_t >
-        struct return_op : mlir::OpConversionPattern< op_t >
+        // TODO(conv:abi): We should always emit main with a fixed type.
+        bool keeps_signature(operation op)
         {
-            using base = mlir::OpConversionPattern< op_t >;
-            using adaptor_t = typename op_t::Adaptor;
-
-            const func_abi_info_t &abi_info_map;
-
-            return_op(const func_abi_info_t &abi_info_map, mcontext_t &mctx)
-                : base(&mctx), abi_info_map(abi_info_map)
-            {}
-
-            logical_result matchAndRewrite(
-                op_t op, adaptor_t ops, conversion_rewriter &rewriter
-            ) const override {
-                auto func = op->template getParentOfType< abi::FuncOp >();
-                if (!func)
-                    return mlir::failure();
+            if (mlir::isa< abi::FuncOp >(op))
+                return true;
+            auto fn = mlir::dyn_cast< core::func_symbol >(op);
+            return fn && fn.getSymbolName() == "main";
+        }
 
-                auto name = func.getSymbolName();
-                if (!name.consume_front(conv::abi::abi_func_name_prefix))
-                    return mlir::failure();
+        logical_result rewrite_call(
+            hl::CallOp op, const func_abi_info_t &abi_info_map, mlir::RewriterBase &rewriter
+        ) {
+            auto abi_map_it = abi_info_map.find(op.getCalleeAttr().getAttr());
+            if (abi_map_it == abi_info_map.end())
+                return op.emitError("no abi classification of the callee");
+
+            rewriter.setInsertionPoint(op);
+            auto call = call_wrapper< hl::CallOp >(
+                { op, hl::CallOp::Adaptor(op), rewriter }, abi_map_it->second
+            ).make();
+            rewriter.replaceOp(op, call);
+            return mlir::success();
+        }
 
-                auto abi_map_it = abi_info_map.find(name.str());
-                if (abi_map_it == abi_info_map.end())
-                    return mlir::failure();
+        logical_result rewrite_return(operation op, const abi_info_t &abi_info, mlir::RewriterBase &rewriter)
+        {
+            auto rewrite = [&]< typename op_t >(op_t ret) {
+                rewriter.setInsertionPoint(ret);
+                return_wrapper< op_t >({ ret, typename op_t::Adaptor(ret), rewriter }, abi_info).make();
+                rewriter.eraseOp(ret);
+                return mlir::success();
+            };
 
-                const auto &abi_info = abi_map_it->second;
-                return_wrapper< op_t >({op, ops, rewriter}, abi_info).make();
+            if (auto ret = mlir::dyn_cast< hl::ReturnOp >(op))
+                return rewrite(ret);
+            if (auto ret = mlir::dyn_cast< ll::ReturnOp >(op))
+                return rewrite(ret);
+            return op->emitError("unsupported return operation");
+        }
 
-                rewriter.eraseOp(op);
+        logical_result rewrite_function(
+            core::function_op_interface op, const abi_info_t &abi_info, mlir::RewriterBase &rewriter
+        ) {
+            auto rewrite = [&]< typename op_t >(op_t fn) {
+                rewriter.setInsertionPoint(fn);
+                abi_transform< op_t >({ fn, typename op_t::Adaptor(fn), rewriter }, abi_info).make();
+                rewriter.eraseOp(fn);
                 return mlir::success();
-            }
-        };
+            };
+
+            if (auto fn = mlir::dyn_cast< hl::FuncOp >(op.getOperation()))
+                return rewrite(fn);
+            if (auto fn = mlir::dyn_cast< ll::FuncOp >(op.getOperation()))
+                return rewrite(fn);
+            return op->emitError("unsupported function operation");
+        }
 
     } // namespace
 
 
     struct EmitABI : EmitABIBase< EmitABI >
     {
-        using target_t = mlir::ConversionTarget;
-        using patterns_t = mlir::RewritePatternSet;
-        using phase_t = std::tuple< target_t, patterns_t >;
+        using statistic = mlir::Pass::Statistic;
 
-        phase_t first_phase(const auto &abi_info_map)
-        {
-            auto &mctx = this->getContext();
+        statistic ops_visited{
+            this, "ops-visited", "Number of operations visited"
+        };
 
-            mlir::ConversionTarget target(mctx);
-            target.markUnknownOpDynamicallyLegal([](auto) { return true; });
-            target.addIllegalOp< hl::CallOp >();
+        statistic ops_rewritten{
+            this, "ops-rewritten", "Number of calls, returns and functions rewritten"
+        };
 
-            mlir::RewritePatternSet patterns(&mctx);
-            patterns.add< call_op >(abi_info_map, mctx);
+        EmitABI() = default;
 
-            return { std::move(target), std::move(patterns) };
-        }
+        // statistics are not copyable, the copy gets fresh counters
+        EmitABI(const EmitABI &other) : EmitABIBase< EmitABI >(other) {}
 
-        phase_t second_phase(const auto &abi_info_map)
+        // Functions (other than main) get the abi signature, their returns of
+        // values get epilogues and all calls are wrapped.
+        abi_worklist collect(operation root, const func_abi_info_t &abi_info_map)
         {
+            abi_worklist work;
+            root->walk< mlir::WalkOrder::PreOrder >([&](operation op) {
+                ++work.visited;
+
+                if (auto call = mlir::dyn_cast< hl::CallOp >(op)) {
+                    work.calls.push_back(call);
+                } else if (mlir::isa< hl::ReturnOp, ll::ReturnOp >(op)) {
+                    // Void returns have nothing to put into an epilogue.
+                    if (op->getNumOperands() == 0)
+                        return;
+                    auto fn = op->getParentOfType< core::function_op_interface >();
+                    if (fn && !keeps_signature(fn))
+                        work.returns.emplace_back(op, fn);
+                } else if (mlir::isa< core::func_symbol >(op) && !keeps_signature(op)) {
+                    work.functions.push_back(mlir::dyn_cast< core::function_op_interface >(op));
+                }
+            });
 
-            auto &mctx = this->getContext();
-
-            mlir::ConversionTarget target(mctx);
-            target.markUnknownOpDynamicallyLegal([](auto) { return true; });
-
-            auto should_transform = [&](operation op)
-            {
-                // TODO(conv:abi): We should always emit main with a fixed type.
-                if (auto fn = mlir::dyn_cast< core::func_symbol >(op))
-                    return fn.getSymbolName() == "main";
-                return true;
-            };
-
-            target.markUnknownOpDynamicallyLegal(should_transform);
-            target.addLegalOp< abi::FuncOp >();
-
-            mlir::RewritePatternSet patterns(&mctx);
-            patterns.add< func_type< hl::FuncOp > >(abi_info_map, mctx);
-            patterns.add< func_type< ll::FuncOp > >(abi_info_map, mctx);
-
-            return { std::move(target), std::move(patterns) };
-        }
-
-        template< typename ret_op_t >
-        auto get_is_legal_return() {
-            return [] (ret_op_t op) -> bool {
-                auto func = op->template getParentOfType< abi::FuncOp >();
-                if (!func)
-                    return true;
-
-                for (auto val : op.getResult())
-                    if (!val.template getDefiningOp< abi::EpilogueOp >())
-                        return false;
-                return true;
-            };
+            return work;
         }
 
-        phase_t third_phase(const auto &abi_info_map)
+        logical_result rewrite(abi_worklist &work, const func_abi_info_t &abi_info_map)
         {
-            auto &mctx = this->getContext();
+            mlir::IRRewriter rewriter(&getContext());
 
-            mlir::ConversionTarget target(mctx);
-            target.markUnknownOpDynamicallyLegal([](auto) { return true; });
+            auto abi_info_of = [&](core::function_op_interface fn) -> const abi_info_t * {
+                if (!fn)
+                    return nullptr;
+                auto it = abi_info_map.find(symbol_name_attr(fn));
+                return it != abi_info_map.end() ? &it->second : nullptr;
+            };
 
-            // Plan is to still leave `hl.return` but it should return values
-            // yielded by `abi.epilogue`.
-            // FIXME: use some return op interface
-            target.addDynamicallyLegalOp< hl::ReturnOp >(get_is_legal_return< hl::ReturnOp >());
-            target.addDynamicallyLegalOp< ll::ReturnOp >(get_is_legal_return< ll::ReturnOp >());
+            for (auto call : work.calls) {
+                if (mlir::failed(rewrite_call(call, abi_info_map, rewriter)))
+                    return mlir::failure();
+                ++ops_rewritten;
+            }
 
-            mlir::RewritePatternSet patterns(&mctx);
-            patterns.add< return_op< hl::ReturnOp > >(abi_info_map, mctx);
-            patterns.add< return_op< ll::ReturnOp > >(abi_info_map, mctx);
+            for (auto [ret, fn] : work.returns) {
+                auto abi_info = abi_info_of(fn);
+                if (!abi_info)
+                    return fn->emitError("no abi classification of the function");
+                if (mlir::failed(rewrite_return(ret, *abi_info, rewriter)))
+                    return mlir::failure();
+                ++ops_rewritten;
+            }
 
-            return { std::move(target), std::move(patterns) };
-        }
+            for (auto fn : work.functions) {
+                auto abi_info = abi_info_of(fn);
+                if (!abi_info)
+                    return mlir::emitError(getOperation().getLoc(), "no abi classification of a function");
+                if (mlir::failed(rewrite_function(fn, *abi_info, rewriter)))
+                    return mlir::failure();
+                ++ops_rewritten;
+            }
 
-        mlir::LogicalResult run(phase_t phase)
-        {
-            auto [trg, patterns] = std::move(phase);
-            return mlir::applyPartialConversion(this->getOperation(), trg, std::move(patterns));
+            return mlir::success();
         }
 
         void runOnOperation() override
         {
             auto op = this->getOperation();
 
-            const auto &dl = this->getAnalysis< mlir::DataLayoutAnalysis >();
-            auto abi_info_map = collect_abi_info< core::function_op_interface >(
-                op, dl.getAtOrAbove(op)
-            );
+            // Layouts of records are shared by all classifications.
+            auto &layouts     = this->getAnalysis< hl::record_layout_cache >();
+            auto abi_info_map = collect_abi_info< core::function_op_interface >(op, layouts);
 
-            if (mlir::failed(run(first_phase(abi_info_map))))
-                return signalPassFailure();
-
-            if (mlir::failed(run(second_phase(abi_info_map))))
-                return signalPassFailure();
+            auto work = collect(op, abi_info_map);
+            ops_visited += work.visited;
 
-            if (mlir::failed(run(third_phase(abi_info_map))))
+            if (mlir::failed(rewrite(work, abi_info_map)))
                 return signalPassFailure();
         }
     };
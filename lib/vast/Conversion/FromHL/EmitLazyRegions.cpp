@@ -129,6 +129,8 @@ namespace vast
     {
         using base = ConversionPassMixin< HLEmitLazyRegionsPass, HLEmitLazyRegionsBase >;
 
+        static constexpr bool freeze_config = true;
+
         static conversion_target create_conversion_target(mcontext_t &context) {
             conversion_target target(context);
             target.addLegalDialect< vast::core::CoreDialect >();
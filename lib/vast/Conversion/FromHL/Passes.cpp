@@ -14,12 +14,12 @@ VAST_UNRELAX_WARNINGS
 namespace vast::conv::pipeline {
 
     pipeline_step_ptr to_hlbi() {
-        return pass(createHLToHLBI);
+        return function_granular_pass(createHLToHLBI);
     }
 
     pipeline_step_ptr hl_to_ll_cf() {
         // TODO add dependencies
-        return pass(createHLToLLCFPass);
+        return function_granular_pass(createHLToLLCFPass);
     }
 
     pipeline_step_ptr hl_to_ll_geps() {
@@ -29,7 +29,7 @@ namespace vast::conv::pipeline {
 
     pipeline_step_ptr lazy_regions() {
         // TODO add dependencies
-        return pass(createHLEmitLazyRegionsPass);
+        return function_granular_pass(createHLEmitLazyRegionsPass);
     }
 
     pipeline_step_ptr hl_to_ll_func() {
@@ -39,7 +39,7 @@ namespace vast::conv::pipeline {
 
     // FIXME: move to ToMem/Passes.cpp eventually
     pipeline_step_ptr vars_to_cells() {
-        return pass(createVarsToCellsPass);
+        return function_granular_pass(createVarsToCellsPass);
     }
 
     pipeline_step_ptr evict_static_locals() {
@@ -51,9 +51,8 @@ namespace vast::conv::pipeline {
             .depends_on(vars_to_cells);
     }
 
-    // FIXME: run on hl.FuncOp. Once we remove graph regions ll::FuncOp is no longer needed
     pipeline_step_ptr strip_param_lvalues() {
-        return pass(createStripParamLValuesPass);
+        return function_granular_pass(createStripParamLValuesPass);
     }
 
     pipeline_step_ptr to_mem() {
@@ -67,7 +66,7 @@ namespace vast::conv::pipeline {
 
 
     pipeline_step_ptr lower_value_categories() {
-        return pass(createLowerValueCategoriesPass)
+        return function_granular_pass(createLowerValueCategoriesPass)
             .depends_on(to_mem);
     }
 
@@ -411,6 +411,8 @@ namespace vast::conv {
     {
         using base = ConversionPassMixin< HLToHLBIPass, HLToHLBIBase >;
 
+        static constexpr bool freeze_config = true;
+
         static conversion_target create_conversion_target(mcontext_t &context) {
             conversion_target target(context);
             target.addLegalDialect< hlbi::HLBuiltinDialect >();
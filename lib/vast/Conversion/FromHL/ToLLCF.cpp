@@ -477,6 +477,8 @@ namespace vast::conv {
     {
         using base = ConversionPassMixin< HLToLLCF, HLToLLCFBase >;
 
+        static constexpr bool freeze_config = true;
+
         static auto create_conversion_target(mcontext_t &mctx) {
             mlir::ConversionTarget trg(mctx);
             trg.addLegalDialect< ll::LowLevelDialect >();
@@ -503,14 +505,14 @@ namespace vast::conv {
                 // We really don't care if anything was removed or not.
                 std::ignore = mlir::eraseUnreachableBlocks(rewriter, scope.getBody());
             };
-            this->getOperation().walk(clean_scopes);
+            this->getOperation()->walk(clean_scopes);
 
             auto clean_functions = [&](hl::FuncOp fn) {
                 mlir::IRRewriter rewriter{ &this->getContext() };
                 // We really don't care if anything was removed or not.
                 std::ignore = mlir::eraseUnreachableBlocks(rewriter, fn.getBody());
             };
-            this->getOperation().walk(clean_functions);
+            this->getOperation()->walk(clean_functions);
         }
     };
 
@@ -12,12 +12,14 @@ VAST_UNRELAX_WARNINGS
 #include "PassesDetails.hpp"
 
 #include "vast/Dialect/Core/CoreOps.hpp"
+#include "vast/Dialect/Core/SymbolTable.hpp"
 
 #include "vast/Dialect/HighLevel/HighLevelOps.hpp"
 #include "vast/Dialect/HighLevel/HighLevelUtils.hpp"
 #include "vast/Dialect/LowLevel/LowLevelOps.hpp"
 
 #include "vast/Util/DialectConversion.hpp"
+#include "vast/Util/PatternProfiler.hpp"
 #include "vast/Util/Symbols.hpp"
 
 namespace vast {
@@ -119,7 +121,19 @@ namespace vast {
 
             patterns.add< record_member_op >(&mctx);
 
-            if (mlir::failed(mlir::applyPartialConversion(op, trg, std::move(patterns)))) {
+            core::symbol_table_cache cache;
+            core::symbol_table_cache::scope guard(cache);
+
+            mlir::ConversionConfig config;
+            config.listener = &cache;
+
+            auto result = util::profile_conversion(
+                &mctx, getArgument(), std::move(patterns), [&](const auto &frozen) {
+                    return mlir::applyPartialConversion(op, trg, frozen, config);
+                }
+            );
+
+            if (mlir::failed(result)) {
                 return signalPassFailure();
             }
         }
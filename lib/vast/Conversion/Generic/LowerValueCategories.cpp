@@ -477,7 +477,14 @@ namespace vast::conv {
             // This will never have correct types but we want to have it legal.
             trg.addLegalOp< mlir::UnrealizedConversionCastOp >();
 
-            if (mlir::failed(mlir::applyPartialConversion(root, trg, std::move(patterns)))) {
+            auto roots = conversion_roots(root, skip_functions);
+            auto result = util::profile_conversion(
+                &mctx, getArgument(), std::move(patterns), [&](const auto &frozen) {
+                    return mlir::applyPartialConversion(roots, trg, frozen);
+                }
+            );
+
+            if (mlir::failed(result)) {
                 return signalPassFailure();
             }
         }
@@ -44,11 +44,50 @@ namespace vast::conv::irstollvm
 {
     namespace LLVM = mlir::LLVM;
 
-    tc::lower_to_llvm_options mk_default_opts(mcontext_t *mctx) {
-        tc::lower_to_llvm_options opts(mctx);
-        opts.useBarePtrCallConv = true;
-        return opts;
-    }
+    //
+    // Data layout and type converter shared by all patterns and legality
+    // callbacks of a single pass run. Both used to be rebuilt for every
+    // converted type, while the shared converter also caches converted types.
+    //
+    struct llvm_conversion_state
+    {
+        llvm_conversion_state(operation root, hl::record_layout_cache &layouts)
+            : dla(root)
+            , tc(root->getContext(), dla, mk_opts(root), root, layouts)
+        {}
+
+        llvm_conversion_state(const llvm_conversion_state &) = delete;
+        llvm_conversion_state(llvm_conversion_state &&)      = delete;
+
+        llvm_conversion_state &operator=(const llvm_conversion_state &) = delete;
+        llvm_conversion_state &operator=(llvm_conversion_state &&)      = delete;
+
+        // Record definitions are resolved in the scope of the converted operation.
+        tc::llvm_type_converter &converter(operation scope) {
+            tc.set_scope(scope);
+            return tc;
+        }
+
+        const mlir::DataLayout &data_layout(operation from) const {
+            return dla.getAtOrAbove(from);
+        }
+
+      private:
+        // Use the layout of the first vast module, as patterns did before the
+        // converter was shared.
+        tc::lower_to_llvm_options mk_opts(operation root) const {
+            operation scope = root;
+            root->walk< mlir::WalkOrder::PreOrder >([&] (core::ModuleOp mod) {
+                scope = mod;
+                return walk_result::interrupt();
+            });
+
+            return tc::lower_to_llvm_options(root->getContext(), dla.getAtOrAbove(scope));
+        }
+
+        mlir::DataLayoutAnalysis dla;
+        tc::llvm_type_converter tc;
+    };
 
     template< typename op_t >
     struct llvm_conversion_pattern
@@ -56,19 +95,23 @@ namespace vast::conv::irstollvm
         , llvm_pattern_utils
     {
         using base = operation_conversion_pattern< op_t >;
-        using base::base;
 
-        // const mlir::DataLayoutAnalysis &dl;
+        llvm_conversion_pattern(mcontext_t *mctx, llvm_conversion_state &state)
+            : base(mctx), state(state)
+        {}
+
+        llvm_conversion_state &state;
 
-        tc::llvm_type_converter tc(operation from) const {
-            auto dl = mlir::DataLayoutAnalysis(from);
-            tc::lower_to_llvm_options opts(from->getContext(), dl.getAtOrAbove(from));
-            return tc::llvm_type_converter(from->getContext(), dl, opts, from);
+        tc::llvm_type_converter &tc(operation from) const {
+            return state.converter(from);
+        }
+
+        const mlir::DataLayout &data_layout(operation from) const {
+            return state.data_layout(from);
         }
 
         mlir_type convert_type_to_type(operation from, mlir_type type) const {
-            auto t = tc(from);
-            return t.convert_type_to_type(type).value();
+            return tc(from).convert_type_to_type(type).value();
         }
 
         mlir_type convert_element_type(operation from, mlir_type type) const {
@@ -232,7 +275,7 @@ namespace vast::conv::irstollvm
             auto ptr = mlir::dyn_cast< hl::PointerType >(op.getRecord().getType());
             VAST_CHECK(ptr, "{0} is not a pointer to record!", op.getRecord().getType());
 
-            auto tc = this->tc(op);
+            auto &tc = this->tc(op);
 
             auto gep = rewriter.create< mlir::LLVM::GEPOp >(
                 op.getLoc(),
@@ -284,8 +327,7 @@ namespace vast::conv::irstollvm
 
         std::size_t bw(operation op) const {
             VAST_ASSERT(op->getNumResults() == 1);
-            auto dl = mlir::DataLayoutAnalysis(op);
-            return dl.getAtOrAbove(op).getTypeSizeInBits(
+            return this->data_layout(op).getTypeSizeInBits(
                 convert_type_to_type(op, op->getResult(0).getType())
             );
         }
@@ -507,7 +549,7 @@ namespace vast::conv::irstollvm
         logical_result matchAndRewrite(
             op_t func_op, adaptor_t ops, conversion_rewriter &rewriter
         ) const override {
-            auto tc = this->tc(func_op);
+            auto &tc = this->tc(func_op);
             auto maybe_target_type = tc.convert_fn_t(func_op.getFunctionType());
             // TODO(irs-to-llvm): Handle varargs.
             auto maybe_signature = tc.get_conversion_signature(func_op, /* variadic */ true);
@@ -629,8 +671,7 @@ namespace vast::conv::irstollvm
             auto attr, auto op, conversion_rewriter &rewriter
         ) const {
             auto target_type = convert_type_to_type(op, attr.getType());
-            auto dla = mlir::DataLayoutAnalysis(op);
-            const auto &dl = dla.getAtOrAbove(op);
+            const auto &dl = this->data_layout(op);
             if (!target_type)
                 return {};
 
@@ -1400,8 +1441,7 @@ namespace vast::conv::irstollvm
             // TODO mimic: clang/lib/CodeGen/CGExprScalar.cpp:VisitUnaryExprOrTypeTraitExpr
             // This does not consider type alignment and VLA types
             auto target_type = convert_type_to_type(op, op.getType());
-            auto dla = mlir::DataLayoutAnalysis(op);
-            const auto &dl = dla.getAtOrAbove(op);
+            const auto &dl = this->data_layout(op);
             auto attr = rewriter.getIntegerAttr(
                 target_type, dl.getTypeSize(op.getArg())
             );
@@ -1459,7 +1499,7 @@ namespace vast::conv::irstollvm
             }
 
             // It does not have regions
-            auto tc = this->tc(op);
+            auto &tc = this->tc(op);
             return update_via_clone(rewriter, op, ops.getOperands(), tc);
         }
     };
@@ -1497,7 +1537,7 @@ namespace vast::conv::irstollvm
             }
 
             // TODO: What would it take to make this work `updateRootInPlace`?
-            auto tc = this->tc(op);
+            auto &tc = this->tc(op);
             return update_via_clone(rewriter, op, ops.getOperands(),tc);
         }
     };
@@ -1597,11 +1637,40 @@ namespace vast::conv::irstollvm
 
     using ll_memory_ops = util::type_list< ll_load, ll_store, ll_alloca >;
 
+    //
+    // Hands the shared conversion state to every pattern that can make use of it.
+    //
+    struct llvm_conversion_config : base_conversion_config
+    {
+        llvm_conversion_state &state;
+
+        llvm_conversion_config(
+            rewrite_pattern_set patterns,
+            conversion_target target,
+            llvm_conversion_state &state
+        )
+            : base_conversion_config{std::move(patterns), std::move(target)}, state(state)
+        {}
+
+        template< typename pattern >
+        void add_pattern() {
+            if constexpr (std::is_constructible_v< pattern, mcontext_t *, llvm_conversion_state & >) {
+                patterns.template add< pattern >(patterns.getContext(), state);
+            } else {
+                patterns.template add< pattern >(patterns.getContext());
+            }
+        }
+    };
+
     struct IRsToLLVMPass : ConversionPassMixin< IRsToLLVMPass, IRsToLLVMBase >
     {
         using base = ConversionPassMixin< IRsToLLVMPass, IRsToLLVMBase >;
 
-        static conversion_target create_conversion_target(mcontext_t &mctx) {
+        std::unique_ptr< llvm_conversion_state > state;
+
+        static conversion_target create_conversion_target(
+            mcontext_t &mctx, llvm_conversion_state &state
+        ) {
             conversion_target target(mctx);
 
             target.addIllegalDialect< hl::HighLevelDialect >();
@@ -1609,16 +1678,12 @@ namespace vast::conv::irstollvm
             target.addLegalDialect< core::CoreDialect >();
             target.addLegalDialect< mlir::LLVM::LLVMDialect >();
 
-            auto has_legal_return_type = [](auto op) {
-                auto dla = mlir::DataLayoutAnalysis(op);
-                auto opts = mk_default_opts(op->getContext());
-                return tc::llvm_type_converter(op->getContext(), dla, opts, op).has_legal_return_type(op);
+            auto has_legal_return_type = [&state](auto op) {
+                return state.converter(op).has_legal_return_type(op);
             };
 
-            auto has_legal_operand_types = [](auto op) {
-                auto dla = mlir::DataLayoutAnalysis(op);
-                auto opts = mk_default_opts(op->getContext());
-                return tc::llvm_type_converter(op->getContext(), dla, opts, op).has_legal_operand_types(op);
+            auto has_legal_operand_types = [&state](auto op) {
+                return state.converter(op).has_legal_operand_types(op);
             };
 
             target.addDynamicallyLegalOp< core::LazyOp    >(has_legal_return_type);
@@ -1626,23 +1691,30 @@ namespace vast::conv::irstollvm
             target.addDynamicallyLegalOp< core::BinLOrOp  >(has_legal_return_type);
             target.addDynamicallyLegalOp< core::SelectOp  >(has_legal_return_type);
 
-            target.addDynamicallyLegalOp< hl::ValueYieldOp >([&](hl::ValueYieldOp op) {
+            target.addDynamicallyLegalOp< hl::ValueYieldOp >([=](hl::ValueYieldOp op) {
                 return mlir::isa< core::LazyOp >(op->getParentOp()) && has_legal_operand_types(op);
             });
 
             target.addIllegalOp< mlir::func::FuncOp >();
 
-            target.markUnknownOpDynamicallyLegal([&] (auto op) {
-                auto dla = mlir::DataLayoutAnalysis(op);
-                auto opts = mk_default_opts(&mctx);
-                tc::llvm_type_converter tc(op->getContext(), dla, opts, op);
-                return tc.get_is_type_conversion_legal()(op);
+            target.markUnknownOpDynamicallyLegal([&state] (auto op) {
+                return state.converter(op).get_is_type_conversion_legal()(op);
             });
 
             return target;
         }
 
+        llvm_conversion_config make_config() {
+            auto &mctx = getContext();
+            state = std::make_unique< llvm_conversion_state >(
+                getOperation(), getAnalysis< hl::record_layout_cache >()
+            );
+            return { rewrite_pattern_set(&mctx), create_conversion_target(mctx, *state), *state };
+        }
+
         void run_after_conversion() {
+            state.reset();
+
             mcontext_t &mctx = getContext();
             conversion_target target(mctx);
 
@@ -1652,7 +1724,13 @@ namespace vast::conv::irstollvm
             rewrite_pattern_set patterns(&mctx);
             patterns.add< module_conversion >(&mctx);
 
-            if (mlir::failed(mlir::applyPartialConversion(getOperation(), target, std::move(patterns)))) {
+            auto result = util::profile_conversion(
+                &mctx, getArgument(), std::move(patterns), [&](const auto &frozen) {
+                    return mlir::applyPartialConversion(getOperation(), target, frozen);
+                }
+            );
+
+            if (mlir::failed(result)) {
                 return signalPassFailure();
             }
         }
@@ -61,6 +61,8 @@ namespace vast::conv {
             StripParamLValuesPass, StripParamLValuesBase, StripParamLValueTypeConverter
         >;
 
+        static constexpr bool freeze_config = true;
+
         static bool is_not_lvalue_type(mlir_type ty) {
             return !mlir::isa< hl::LValueType >(ty);
         }
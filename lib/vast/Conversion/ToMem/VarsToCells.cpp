@@ -101,6 +101,8 @@ namespace vast::conv {
     {
         using base = ConversionPassMixin< VarsToCellsPass, VarsToCellsBase >;
 
+        static constexpr bool freeze_config = true;
+
         static conversion_target create_conversion_target(mcontext_t &mctx) {
             auto trg = conversion_target(mctx);
             // Block inlining might trigger legalization on some operations
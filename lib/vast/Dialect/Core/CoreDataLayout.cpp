@@ -0,0 +1,206 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/Core/CoreAttributes.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/DenseMapInfo.h>
+#include <llvm/Support/MathExtras.h>
+#include <mlir/Dialect/DLTI/DLTI.h>
+#include <mlir/IR/Builders.h>
+#include <mlir/IR/DialectImplementation.h>
+VAST_UNRELAX_WARNINGS
+
+namespace vast::core {
+
+    namespace detail {
+
+        static std::uint32_t bucket_of(mlir::Type type, std::size_t capacity) {
+            auto hash = llvm::DenseMapInfo< mlir::Type >::getHashValue(type);
+            return static_cast< std::uint32_t >(hash & (capacity - 1));
+        }
+
+        DataLayoutSpecAttrStorage *DataLayoutSpecAttrStorage::construct(
+            mlir::AttributeStorageAllocator &allocator, const KeyTy &key
+        ) {
+            auto layouts = allocator.copyInto(key);
+
+            // Keep the load factor at most one half.
+            std::size_t capacity = key.empty() ? 0 : llvm::PowerOf2Ceil(key.size() * 2);
+            llvm::SmallVector< std::uint32_t > buckets(capacity, 0);
+            llvm::SmallVector< mlir::TypeID > kinds;
+
+            for (const auto &[idx, entry] : llvm::enumerate(layouts)) {
+                auto bucket = bucket_of(entry.type, capacity);
+                while (buckets[bucket] && layouts[buckets[bucket] - 1].type != entry.type) {
+                    bucket = (bucket + 1) & (capacity - 1);
+                }
+
+                // Duplicate entries are resolved by the first one.
+                if (!buckets[bucket]) {
+                    buckets[bucket] = static_cast< std::uint32_t >(idx + 1);
+                }
+
+                if (!llvm::is_contained(kinds, entry.type.getTypeID())) {
+                    kinds.push_back(entry.type.getTypeID());
+                }
+            }
+
+            return new (allocator.allocate< DataLayoutSpecAttrStorage >())
+                DataLayoutSpecAttrStorage(
+                    layouts, allocator.copyInto(llvm::ArrayRef(buckets)),
+                    allocator.copyInto(llvm::ArrayRef(kinds))
+                );
+        }
+
+        const type_layout *DataLayoutSpecAttrStorage::lookup(mlir::Type type) const {
+            if (buckets.empty()) {
+                return nullptr;
+            }
+
+            auto bucket = bucket_of(type, buckets.size());
+            while (auto idx = buckets[bucket]) {
+                if (layouts[idx - 1].type == type) {
+                    return &layouts[idx - 1];
+                }
+                bucket = (bucket + 1) & (buckets.size() - 1);
+            }
+
+            return nullptr;
+        }
+
+        bool DataLayoutSpecAttrStorage::contains_kind(mlir::TypeID kind) const {
+            return llvm::is_contained(kinds, kind);
+        }
+
+    } // namespace detail
+
+    const type_layout *DataLayoutSpecAttr::lookup(mlir::Type type) const {
+        return getImpl()->lookup(type);
+    }
+
+    DataLayoutSpecAttr DataLayoutSpecAttr::filter(llvm::function_ref< bool(mlir::Type) > keep) const {
+        llvm::SmallVector< type_layout > kept;
+        for (const auto &entry : getLayouts()) {
+            if (keep(entry.type)) {
+                kept.push_back(entry);
+            }
+        }
+
+        if (kept.size() == getLayouts().size()) {
+            return *this;
+        }
+
+        return DataLayoutSpecAttr::get(getContext(), kept);
+    }
+
+    //
+    // DataLayoutSpecInterface
+    //
+
+    // Nested specifications take precedence, specifications of other kinds
+    // (e.g., `dlti.dl_spec` of the enclosing builtin module) do not describe
+    // VAST types and are left out.
+    mlir::DataLayoutSpecInterface DataLayoutSpecAttr::combineWith(
+        llvm::ArrayRef< mlir::DataLayoutSpecInterface > specs
+    ) const {
+        llvm::SmallVector< type_layout > combined(getLayouts());
+        for (auto spec : specs) {
+            auto outer = mlir::dyn_cast< DataLayoutSpecAttr >(spec);
+            if (!outer) {
+                continue;
+            }
+
+            for (const auto &entry : outer.getLayouts()) {
+                if (!lookup(entry.type)) {
+                    combined.push_back(entry);
+                }
+            }
+        }
+
+        if (combined.size() == getLayouts().size()) {
+            return *this;
+        }
+
+        return DataLayoutSpecAttr::get(getContext(), combined);
+    }
+
+    // Entries are not materialized as `DataLayoutEntryInterface`, queries go
+    // through `getSpecForType`.
+    mlir::DataLayoutEntryListRef DataLayoutSpecAttr::getEntries() const {
+        return {};
+    }
+
+    mlir::DataLayoutEntryList DataLayoutSpecAttr::getSpecForType(mlir::TypeID kind) const {
+        if (!getImpl()->contains_kind(kind)) {
+            return {};
+        }
+
+        auto id = mlir::StringAttr::get(getContext(), getTableIdentifier());
+        return { mlir::DataLayoutEntryAttr::get(id, *this) };
+    }
+
+    mlir::StringAttr DataLayoutSpecAttr::getEndiannessIdentifier(mcontext_t *mctx) const {
+        return mlir::Builder(mctx).getStringAttr(mlir::DLTIDialect::kDataLayoutEndiannessKey);
+    }
+
+    mlir::StringAttr DataLayoutSpecAttr::getAllocaMemorySpaceIdentifier(mcontext_t *mctx) const {
+        return mlir::Builder(mctx).getStringAttr(
+            mlir::DLTIDialect::kDataLayoutAllocaMemorySpaceKey
+        );
+    }
+
+    mlir::StringAttr DataLayoutSpecAttr::getProgramMemorySpaceIdentifier(mcontext_t *mctx) const {
+        return mlir::Builder(mctx).getStringAttr(
+            mlir::DLTIDialect::kDataLayoutProgramMemorySpaceKey
+        );
+    }
+
+    mlir::StringAttr DataLayoutSpecAttr::getGlobalMemorySpaceIdentifier(mcontext_t *mctx) const {
+        return mlir::Builder(mctx).getStringAttr(
+            mlir::DLTIDialect::kDataLayoutGlobalMemorySpaceKey
+        );
+    }
+
+    mlir::StringAttr DataLayoutSpecAttr::getStackAlignmentIdentifier(mcontext_t *mctx) const {
+        return mlir::Builder(mctx).getStringAttr(mlir::DLTIDialect::kDataLayoutStackAlignmentKey);
+    }
+
+    //
+    // #core.data_layout<[type = bw : abi_align, ...]>
+    //
+    void DataLayoutSpecAttr::print(mlir::AsmPrinter &printer) const {
+        printer << "<[";
+        llvm::interleaveComma(getLayouts(), printer, [&](const type_layout &entry) {
+            printer << entry.type << " = " << entry.bw << " : " << entry.abi_align;
+        });
+        printer << "]>";
+    }
+
+    mlir_attr DataLayoutSpecAttr::parse(mlir::AsmParser &parser, mlir_type) {
+        llvm::SmallVector< type_layout > layouts;
+
+        auto parse_entry = [&]() -> logical_result {
+            type_layout entry;
+            if (parser.parseType(entry.type)
+                || parser.parseEqual()
+                || parser.parseInteger(entry.bw)
+                || parser.parseColon()
+                || parser.parseInteger(entry.abi_align)
+            ) {
+                return mlir::failure();
+            }
+            layouts.push_back(entry);
+            return mlir::success();
+        };
+
+        if (parser.parseLess()
+            || parser.parseCommaSeparatedList(mlir::AsmParser::Delimiter::Square, parse_entry)
+            || parser.parseGreater()
+        ) {
+            return {};
+        }
+
+        return DataLayoutSpecAttr::get(parser.getContext(), layouts);
+    }
+
+} // namespace vast::core
@@ -7,6 +7,7 @@
 
 #include "vast/Interfaces/AliasTypeInterface.hpp"
 
+#include <mlir/Bytecode/BytecodeImplementation.h>
 #include <mlir/IR/TypeSupport.h>
 #include <mlir/IR/Builders.h>
 #include <mlir/IR/DialectImplementation.h>
@@ -52,6 +53,67 @@ namespace vast::core
         }
     };
 
+    //
+    // Data layouts hold an entry for every type of the translation unit, they
+    // are encoded as a list of types (referenced by their index in the
+    // bytecode) with sizes and alignments. Other attributes use the textual
+    // fallback.
+    //
+    struct CoreBytecodeDialectInterface : mlir::BytecodeDialectInterface
+    {
+        using mlir::BytecodeDialectInterface::BytecodeDialectInterface;
+
+        enum class attr_code : std::uint64_t { data_layout = 0 };
+
+        mlir_attr readAttribute(mlir::DialectBytecodeReader &reader) const final {
+            std::uint64_t code;
+            if (mlir::failed(reader.readVarInt(code))) {
+                return {};
+            }
+
+            if (code != std::uint64_t(attr_code::data_layout)) {
+                reader.emitError() << "unknown core attribute code: " << code;
+                return {};
+            }
+
+            auto read_entry = [&]() -> mlir::FailureOr< type_layout > {
+                type_layout entry;
+                std::uint64_t bw, abi_align;
+                if (mlir::failed(reader.readType(entry.type))
+                    || mlir::failed(reader.readVarInt(bw))
+                    || mlir::failed(reader.readVarInt(abi_align))
+                ) {
+                    return mlir::failure();
+                }
+                entry.bw        = static_cast< std::uint32_t >(bw);
+                entry.abi_align = static_cast< std::uint32_t >(abi_align);
+                return entry;
+            };
+
+            llvm::SmallVector< type_layout > layouts;
+            if (mlir::failed(reader.readList(layouts, read_entry))) {
+                return {};
+            }
+
+            return DataLayoutSpecAttr::get(getContext(), layouts);
+        }
+
+        logical_result writeAttribute(mlir_attr attr, mlir::DialectBytecodeWriter &writer) const final {
+            auto layout = mlir::dyn_cast< DataLayoutSpecAttr >(attr);
+            if (!layout) {
+                return mlir::failure();
+            }
+
+            writer.writeVarInt(std::uint64_t(attr_code::data_layout));
+            writer.writeList(layout.getLayouts(), [&](const type_layout &entry) {
+                writer.writeType(entry.type);
+                writer.writeVarInt(entry.bw);
+                writer.writeVarInt(entry.abi_align);
+            });
+            return mlir::success();
+        }
+    };
+
     void CoreDialect::initialize()
     {
         registerTypes();
@@ -62,7 +124,7 @@ namespace vast::core
             #include "vast/Dialect/Core/Core.cpp.inc"
         >();
 
-        addInterfaces< CoreOpAsmDialectInterface >();
+        addInterfaces< CoreOpAsmDialectInterface, CoreBytecodeDialectInterface >();
     }
 
     using OpBuilder = mlir::OpBuilder;
@@ -70,23 +70,268 @@ namespace vast::core {
         symbol_tables[kind][symbol_name].push_back(op);
     }
 
+    bool symbol_table::try_insert_dynamic(operation op) {
+        for (auto kind : ordered_kinds) {
+            if (op->getName().hasInterface(kind)) {
+                insert(kind, op);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool symbol_table::erase(operation op, string_ref name) {
+        for (auto &[kind, table] : symbol_tables) {
+            auto it = table.find(name);
+            if (it == table.end()) {
+                continue;
+            }
+
+            auto &ops = it->second;
+            if (auto pos = llvm::find(ops, op); pos != ops.end()) {
+                ops.erase(pos);
+                if (ops.empty()) {
+                    table.erase(it);
+                }
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    std::size_t symbol_table::size() const {
+        std::size_t result = 0;
+        for_each_symbol([&] (auto, auto) { ++result; });
+        return result;
+    }
+
+    operation symbol_table::lookup(symbol_kind kind, string_ref symbol_name) const {
+        auto it = symbol_tables.find(kind);
+        if (it == symbol_tables.end()) {
+            return {};
+        }
+
+        auto &table = it->second;
+        auto symbol = table.find(symbol_name);
+        if (symbol == table.end()) {
+            return {};
+        }
+
+        // FIXME: resolve redeclarations
+        return symbol->second.back();
+    }
+
     string_ref symbol_attr_name() {
         return mlir::SymbolTable::getSymbolAttrName();
     }
 
-    std::optional< symbol_table > get_effective_symbol_table_for(
-        operation from, symbol_kind kind
-    ) {
+    operation get_effective_symbol_table_op_for(operation from, symbol_kind kind) {
         while (from) {
             if (auto table = mlir::dyn_cast_if_present< SymbolTableOpInterface >(from)) {
                 if (table.can_hold_symbol_kind(kind)) {
-                    return table.materialize();
+                    return from;
                 }
             }
             from = from->getParentOp();
         }
 
+        return {};
+    }
+
+    // Returns the closest symbol table which recognizes the given symbol.
+    static operation get_owning_symbol_table_op_for(operation symbol_op) {
+        for (auto from = symbol_op->getParentOp(); from; from = from->getParentOp()) {
+            if (auto table = mlir::dyn_cast< SymbolTableOpInterface >(from)) {
+                if (table.can_hold_operation(symbol_op)) {
+                    return from;
+                }
+            }
+        }
+
+        return {};
+    }
+
+    std::optional< symbol_table > get_effective_symbol_table_for(
+        operation from, symbol_kind kind
+    ) {
+        if (auto table = get_effective_symbol_table_op_for(from, kind)) {
+            return mlir::cast< SymbolTableOpInterface >(table).materialize();
+        }
+
         return std::nullopt;
     }
 
+    //
+    // symbol_table_cache
+    //
+    static thread_local symbol_table_cache *active_symbol_table_cache = nullptr;
+
+    symbol_table_cache::scope::scope(symbol_table_cache &cache)
+        : previous(active_symbol_table_cache)
+    {
+        active_symbol_table_cache = &cache;
+    }
+
+    symbol_table_cache::scope::~scope() {
+        active_symbol_table_cache = previous;
+    }
+
+    symbol_table_cache *symbol_table_cache::active() {
+        return active_symbol_table_cache;
+    }
+
+    symbol_table *symbol_table_cache::materialize(operation table_op) {
+        auto table = mlir::cast< SymbolTableOpInterface >(table_op).materialize();
+        auto [it, _] = tables.try_emplace(table_op, std::move(table));
+
+        ++counters.materializations;
+        index(it->second);
+        return &it->second;
+    }
+
+    void symbol_table_cache::invalidate(operation table_op) {
+        auto it = tables.find(table_op);
+        if (it == tables.end()) {
+            return;
+        }
+
+        it->second.for_each_symbol([&] (auto, operation op) { indexed.erase(op); });
+        tables.erase(it);
+    }
+
+    void symbol_table_cache::index(symbol_table &table) {
+        auto owner = table.get_defining_operation();
+        table.for_each_symbol([&] (string_ref name, operation op) {
+            // count each indexed symbol once
+            auto [_, inserted] = indexed.insert_or_assign(op, std::pair{ owner, name });
+            if (inserted) {
+                ++counters.indexed_symbols;
+            }
+        });
+    }
+
+    void symbol_table_cache::unindex(operation op) {
+        auto it = indexed.find(op);
+        if (it == indexed.end()) {
+            return;
+        }
+
+        auto [owner, name] = it->second;
+        if (auto table = tables.find(owner); table != tables.end()) {
+            table->second.erase(op, name);
+        }
+
+        indexed.erase(it);
+    }
+
+    operation symbol_table_cache::lookup(operation from, symbol_kind kind, string_ref symbol) {
+        ++counters.lookups;
+
+        auto table_op = get_effective_symbol_table_op_for(from, kind);
+        VAST_CHECK(table_op, "No effective symbol table found.");
+
+        // cached tables may miss symbols of a running conversion
+        if (uncommitted) {
+            while (table_op) {
+                auto table = mlir::cast< SymbolTableOpInterface >(table_op).materialize();
+                if (auto result = table.lookup(kind, symbol)) {
+                    return result;
+                }
+
+                table_op = get_effective_symbol_table_op_for(table_op->getParentOp(), kind);
+            }
+
+            return {};
+        }
+
+        while (table_op) {
+            auto it = tables.find(table_op);
+            auto table = it != tables.end() ? &it->second : materialize(table_op);
+
+            if (auto result = table->lookup(kind, symbol)) {
+                return result;
+            }
+
+            table_op = get_effective_symbol_table_op_for(table_op->getParentOp(), kind);
+        }
+
+        return {};
+    }
+
+    void symbol_table_cache::reindex(operation op) {
+        auto was_indexed = indexed.contains(op);
+        unindex(op);
+
+        auto owner = get_owning_symbol_table_op_for(op);
+        if (!owner) {
+            return;
+        }
+
+        // tables are materialized lazily, nothing to update yet
+        auto it = tables.find(owner);
+        if (it == tables.end()) {
+            return;
+        }
+
+        if (it->second.try_insert_dynamic(op)) {
+            indexed[op] = { owner, mlir::cast< symbol >(op).getSymbolName() };
+            if (!was_indexed) {
+                ++counters.indexed_symbols;
+            }
+        } else {
+            invalidate(owner);
+        }
+    }
+
+    void symbol_table_cache::notifyOperationInserted(
+        operation op, mlir::OpBuilder::InsertPoint /* previous */
+    ) {
+        if (auto inserted = mlir::dyn_cast< SymbolTableOpInterface >(op)) {
+            invalidate(op);
+
+            // Symbols of an inserted symbol table that it does not recognize
+            // belong to enclosing tables.
+            auto has_nested_symbols = op->walk([&] (operation nested) {
+                return nested != op && mlir::isa< symbol >(nested)
+                    ? walk_result::interrupt() : walk_result::advance();
+            }).wasInterrupted();
+
+            if (has_nested_symbols) {
+                for (auto from = op->getParentOp(); from; from = from->getParentOp()) {
+                    auto table = mlir::dyn_cast< SymbolTableOpInterface >(from);
+                    if (table && !subsumes(inserted, table)) {
+                        invalidate(from);
+                    }
+                }
+            }
+        }
+
+        if (mlir::isa< symbol >(op)) {
+            reindex(op);
+        }
+    }
+
+    void symbol_table_cache::notifyOperationErased(operation op) {
+        unindex(op);
+        invalidate(op);
+    }
+
+    void symbol_table_cache::notifyOperationModified(operation op) {
+        auto sym = mlir::dyn_cast< symbol >(op);
+        if (!sym) {
+            return;
+        }
+
+        // reindex only renamed symbols
+        if (auto it = indexed.find(op); it != indexed.end()) {
+            if (it->second.second == sym.getSymbolName()) {
+                return;
+            }
+        }
+
+        reindex(op);
+    }
+
 } // namespace vast::core
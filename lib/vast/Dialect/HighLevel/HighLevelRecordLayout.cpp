@@ -0,0 +1,124 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/HighLevel/HighLevelRecordLayout.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/Support/MathExtras.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Dialect/Core/SymbolTable.hpp"
+
+namespace vast::hl {
+
+    namespace {
+
+        bool has_layout_attr(operation op) {
+            return llvm::any_of(op->getAttrs(), [] (auto attr) {
+                return mlir::isa< hl::PackedAttr, hl::AlignedAttr >(attr.getValue());
+            });
+        }
+
+        // Bitfields and `packed` and `aligned` attributes change the layout
+        // in ways the field types do not describe.
+        bool has_frontend_layout(core::aggregate_interface def) {
+            if (has_layout_attr(def.getOperation())) {
+                return true;
+            }
+
+            for (auto &region : def->getRegions()) {
+                for (auto field : region.getOps< hl::FieldDeclOp >()) {
+                    if (field.getBits() || has_layout_attr(field)) {
+                        return true;
+                    }
+                }
+            }
+
+            return false;
+        }
+
+    } // namespace
+
+    const record_layout *record_layout_cache::lookup(hl::RecordType type, operation from) {
+        // Lookups from the same symbol table resolve to the same definition.
+        auto scope = core::get_effective_symbol_table_op_for< core::type_symbol >(from);
+        VAST_CHECK(scope, "No symbol table to resolve record type {0} in.", type.getName());
+
+        {
+            std::scoped_lock lock(mutex);
+            if (auto it = resolved.find({ type, scope }); it != resolved.end()) {
+                return it->second;
+            }
+        }
+
+        auto def = core::symbol_table::lookup< core::type_symbol >(scope, type.getName());
+        VAST_CHECK(def, "Record type {0} not present in the symbol table.", type.getName());
+
+        const record_layout *layout = nullptr;
+        if (auto agg = mlir::dyn_cast_if_present< core::aggregate_interface >(def)) {
+            layout = compute(agg);
+        }
+
+        std::scoped_lock lock(mutex);
+        return resolved.try_emplace({ type, scope }, layout).first->second;
+    }
+
+    const record_layout &record_layout_cache::get(hl::RecordType type, operation from) {
+        auto layout = lookup(type, from);
+        VAST_CHECK(layout, "Record type symbol is not an aggregate.");
+        return *layout;
+    }
+
+    const record_layout *record_layout_cache::compute(core::aggregate_interface def) {
+        {
+            std::scoped_lock lock(mutex);
+            if (auto it = layouts.find(def.getOperation()); it != layouts.end()) {
+                return it->second.get();
+            }
+        }
+
+        auto layout = std::make_unique< record_layout >();
+        layout->def      = def;
+        layout->is_union = mlir::isa< hl::UnionDeclOp >(def);
+        layout->has_field_offsets = !has_frontend_layout(def);
+
+        // `mlir::DataLayout` caches queries, each computation has its own.
+        auto scope = def->getParentOfType< mlir::DataLayoutOpInterface >();
+        auto dl    = scope ? mlir::DataLayout(scope) : mlir::DataLayout();
+
+        std::size_t offset = 0;
+        std::size_t align  = 1;
+        for (auto type : def.getFieldTypes()) {
+            std::size_t field_size  = dl.getTypeSizeInBits(type);
+            std::size_t field_align = dl.getTypeABIAlignment(type);
+
+            auto field_offset = offset;
+            if (layout->is_union) {
+                field_offset = 0;
+            } else if (layout->has_field_offsets) {
+                field_offset = llvm::alignTo(offset, field_align * 8);
+            }
+
+            layout->fields.push_back({ type, field_offset, field_size, field_align });
+
+            offset = std::max(offset, field_offset + field_size);
+            align  = std::max(align, field_align);
+        }
+
+        if (layout->has_field_offsets) {
+            layout->size  = llvm::alignTo(offset, align * 8);
+            layout->align = align;
+        } else {
+            // The frontend recorded the layout of the record itself.
+            auto type     = def.getDefinedType();
+            layout->size  = dl.getTypeSizeInBits(type);
+            layout->align = dl.getTypeABIAlignment(type);
+        }
+
+        // Concurrent queries might have computed the same layout.
+        std::scoped_lock lock(mutex);
+        return layouts.try_emplace(def.getOperation(), std::move(layout)).first->second.get();
+    }
+
+} // namespace vast::hl
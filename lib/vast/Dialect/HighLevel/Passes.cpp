@@ -71,6 +71,10 @@ namespace vast::hl::pipeline {
         );
     }
 
+    pipeline_step_ptr prune_data_layout() {
+        return pass(hl::createPruneDataLayoutPass);
+    }
+
     //
     // stdtypes passes
     //
@@ -14,6 +14,7 @@ VAST_UNRELAX_WARNINGS
 
 #include <vast/Dialect/HighLevel/HighLevelDialect.hpp>
 #include <vast/Dialect/HighLevel/HighLevelOps.hpp>
+#include <vast/Dialect/HighLevel/HighLevelRecordLayout.hpp>
 #include <vast/Util/Symbols.hpp>
 #include <vast/Util/TypeSwitch.hpp>
 
@@ -188,6 +189,27 @@ namespace vast::hl
         }
     };
 
+    //
+    // record entry names the record, its fields are listed among records
+    // of the function
+    //
+    template< typename DialectType >
+    struct RecordTypeEntry : DialectTypeEntry< DialectType > {
+        using Base = DialectTypeEntry< DialectType >;
+        RecordTypeEntry(DialectType t) : Base(t) {}
+
+        using Base::raw;
+        using Base::in_dialect;
+
+        TypeEntryBase &emit(const mlir::DataLayout &dl) {
+            raw["name"] = in_dialect().getName().str();
+            return Base::emit().size(dl);
+        }
+    };
+
+    template< typename DialectType >
+    RecordTypeEntry(DialectType) -> RecordTypeEntry< DialectType >;
+
     //
     // type entry dispatcher
     //
@@ -196,8 +218,14 @@ namespace vast::hl
         auto lvalue_entry = [&](auto ty) { return LValueTypeEntry(ty).emit(dl); };
         auto void_entry   = [&](auto ty) { return VoidTypeEntry(ty).emit(); };
         auto scalar_entry = [&](auto ty) { return ScalarTypeEntry(ty).emit(dl); };
+        auto record_entry = [&](auto ty) { return RecordTypeEntry(ty).emit(dl); };
+        auto array_entry  = [&](auto ty) { return WithElementType(ty).emit(dl).size(dl); };
+        auto elab_entry   = [&](auto ty) { return type_entry(dl, ty.getElementType()); };
 
         return TypeSwitch< mlir::Type, TypeEntryBase >(type)
+            .Case< hl::ElaboratedType >(elab_entry)
+            .Case< hl::RecordType >(record_entry)
+            .Case< hl::ArrayType >(array_entry)
             .Case< hl::LValueType >(lvalue_entry)
             .Case< hl::PointerType >(ptr_entry)
             .Case< hl::VoidType >(void_entry)
@@ -208,12 +236,68 @@ namespace vast::hl
         return type_entry(dl, type).take();
     }
 
+    //
+    // layouts of records reachable from the signature of `fn`
+    //
+    llvm::json::Object json_record_entries(
+        const mlir::DataLayout &dl, record_layout_cache &layouts, FuncOp fn
+    ) {
+        llvm::SmallVector< hl::RecordType > worklist;
+        auto enqueue = [&](mlir::Type type) {
+            type.walk([&](hl::RecordType record) { worklist.push_back(record); });
+        };
+
+        for (auto type : fn.getArgumentTypes()) {
+            enqueue(type);
+        }
+        for (auto type : fn.getResultTypes()) {
+            enqueue(type);
+        }
+
+        llvm::json::Object records;
+        while (!worklist.empty()) {
+            auto record = worklist.pop_back_val();
+            auto name   = record.getName().str();
+            if (records.get(name)) {
+                continue;
+            }
+
+            auto layout = layouts.lookup(record, fn);
+            if (!layout) {
+                continue;
+            }
+
+            llvm::json::Array fields;
+            for (const auto &field : layout->fields) {
+                llvm::json::Object entry;
+                if (layout->has_field_offsets) {
+                    entry["offset"] = field.offset;
+                }
+                entry["size"]   = field.size;
+                entry["type"]   = json_type_entry(dl, field.type);
+                fields.push_back(std::move(entry));
+                enqueue(field.type);
+            }
+
+            llvm::json::Object entry;
+            entry["size"]   = layout->size;
+            entry["align"]  = layout->align;
+            entry["fields"] = std::move(fields);
+            records[name]   = std::move(entry);
+        }
+
+        return records;
+    }
+
     struct ExportFnInfo : ExportFnInfoBase< ExportFnInfo > {
         void runOnOperation() override {
             auto mod = this->getOperation();
 
             llvm::json::Object top;
 
+            // Records are shared by signatures, their layouts are computed once.
+            auto &layouts = this->getAnalysis< record_layout_cache >();
+
             // TODO use core::function_op_interface instead of specific operation
             util::functions(mod, [&](FuncOp fn) {
                 const auto &dl_analysis = this->getAnalysis< mlir::DataLayoutAnalysis >();
@@ -233,6 +317,10 @@ namespace vast::hl
                 current["rets"] = std::move(rets);
                 current["args"] = std::move(args);
 
+                if (auto records = json_record_entries(dl, layouts, fn); !records.empty()) {
+                    current["records"] = std::move(records);
+                }
+
                 top[fn.getSymName().str()] = std::move(current);
             });
 
@@ -247,6 +335,9 @@ namespace vast::hl
             } else {
                 llvm::outs() << std::move(value);
             }
+
+            // The module is only inspected, computed layouts stay valid.
+            this->markAllAnalysesPreserved();
         }
     };
 
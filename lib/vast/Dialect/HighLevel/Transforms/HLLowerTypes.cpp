@@ -23,6 +23,7 @@ VAST_UNRELAX_WARNINGS
 #include "vast/Conversion/Common/Types.hpp"
 
 #include "vast/Util/Maybe.hpp"
+#include "vast/Util/PatternProfiler.hpp"
 #include "vast/Util/TypeUtils.hpp"
 
 #include "vast/Conversion/TypeConverters/DataLayout.hpp"
@@ -57,7 +58,13 @@ namespace vast::hl
 
             patterns.add< pattern::lower_type >(tc, mctx);
 
-            if (mlir::failed(mlir::applyPartialConversion(op, trg, std::move(patterns)))) {
+            auto result = util::profile_conversion(
+                &mctx, getArgument(), std::move(patterns), [&](const auto &frozen) {
+                    return mlir::applyPartialConversion(op, trg, frozen);
+                }
+            );
+
+            if (mlir::failed(result)) {
                 return signalPassFailure();
             }
         }
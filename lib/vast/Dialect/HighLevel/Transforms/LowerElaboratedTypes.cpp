@@ -20,6 +20,7 @@ VAST_UNRELAX_WARNINGS
 
 #include "vast/Util/Common.hpp"
 #include "vast/Util/DialectConversion.hpp"
+#include "vast/Util/PatternProfiler.hpp"
 #include "vast/Util/TypeUtils.hpp"
 
 #include "vast/Dialect/Core/CoreOps.hpp"
@@ -91,7 +92,13 @@ namespace vast::hl {
             auto tc = pattern::type_converter(mctx, op);
             patterns.template add< pattern::lower_elaborated >(tc, mctx);
 
-            if (mlir::failed(mlir::applyPartialConversion(op, target, std::move(patterns)))) {
+            auto result = util::profile_conversion(
+                &mctx, getArgument(), std::move(patterns), [&](const auto &frozen) {
+                    return mlir::applyPartialConversion(op, target, frozen);
+                }
+            );
+
+            if (mlir::failed(result)) {
                 return signalPassFailure();
             }
         }
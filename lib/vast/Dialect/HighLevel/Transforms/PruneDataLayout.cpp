@@ -0,0 +1,50 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Dialect/HighLevel/Passes.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/DenseSet.h>
+VAST_UNRELAX_WARNINGS
+
+#include <vast/Util/DataLayout.hpp>
+#include <vast/Util/TypeUtils.hpp>
+
+#include "PassesDetails.hpp"
+
+namespace vast::hl {
+
+    struct PruneDataLayout : PruneDataLayoutBase< PruneDataLayout >
+    {
+        void runOnOperation() override {
+            auto mod = getOperation();
+
+            llvm::DenseSet< mlir_type > referenced;
+            auto collect = [&] (mlir_type type) {
+                referenced.insert(type);
+                return false;
+            };
+
+            mod->walk([&] (operation op) {
+                // Skip the data layout of the module itself.
+                if (op != mod) {
+                    has_type_somewhere(op, collect);
+                }
+
+                for (auto &region : op->getRegions()) {
+                    for (auto &block : region) {
+                        contains_subtype(block.getArgumentTypes(), collect);
+                    }
+                }
+            });
+
+            dl::filter_data_layout(mod, [&] (mlir_type type) {
+                return referenced.contains(type);
+            });
+        }
+    };
+
+    std::unique_ptr< mlir::Pass > createPruneDataLayoutPass() {
+        return std::make_unique< PruneDataLayout >();
+    }
+
+} // namespace vast::hl
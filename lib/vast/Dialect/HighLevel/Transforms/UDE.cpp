@@ -9,6 +9,9 @@ VAST_RELAX_WARNINGS
 #include <mlir/Rewrite/FrozenRewritePatternSet.h>
 #include <mlir/Transforms/DialectConversion.h>
 #include <mlir/Transforms/GreedyPatternRewriteDriver.h>
+
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/TypeSwitch.h>
 VAST_UNRELAX_WARNINGS
 
 #include <gap/coro/generator.hpp>
@@ -23,8 +26,6 @@ VAST_UNRELAX_WARNINGS
 
 #include "PassesDetails.hpp"
 
-#include <unordered_set>
-
 namespace vast::hl {
 
 #if !defined(NDEBUG)
@@ -36,109 +37,241 @@ namespace vast::hl {
 
     constexpr bool keep_only_if_used = false;
 
-    template< typename yield_t >
-    walk_result users(hl::FieldDeclOp decl, auto scope, yield_t &&yield) {
-        return hl::users(decl.getAggregate(), scope, std::forward< yield_t >(yield));
-    }
-
-    struct UDE : UDEBase< UDE >
+    //
+    // Definition-use graph of a module built by a single walk. Every operation
+    // that references a definition (by a symbol or by a named type) is a user
+    // whose references become live once the operations it depends on are
+    // live: the user itself, if it is a definition that is not kept
+    // unconditionally, and its enclosing function.
+    //
+    struct use_graph
     {
-        using base = UDEBase< UDE >;
+        enum class ref_kind { var, func, type_def, record };
+
+        struct reference {
+            ref_kind kind;
+            string_ref name;
+        };
+
+        struct user_node {
+            llvm::SmallVector< operation, 2 > conditions;
+            llvm::SmallVector< reference, 2 > refs;
+            unsigned pending = 0;
+        };
+
+        std::vector< user_node > users;
+
+        llvm::StringMap< llvm::SmallVector< operation, 1 > > vars;
+        llvm::StringMap< llvm::SmallVector< operation, 1 > > funcs;
+        llvm::StringMap< llvm::SmallVector< operation, 1 > > type_defs;
+        llvm::StringMap< llvm::SmallVector< operation, 1 > > records;
+
+        // definitions kept regardless of their users
+        std::vector< operation > roots;
+
+        llvm::DenseMap< operation, llvm::SmallVector< unsigned, 2 > > waiting;
+        llvm::DenseSet< operation > live;
+
+        auto &definitions(ref_kind kind) {
+            switch (kind) {
+                case ref_kind::var:      return vars;
+                case ref_kind::func:     return funcs;
+                case ref_kind::type_def: return type_defs;
+                case ref_kind::record:   return records;
+            }
+            VAST_UNREACHABLE("unknown reference kind");
+        }
 
-        std::unordered_set< operation > unused_cached;
+        static void collect_type_refs(operation op, auto &refs) {
+            mlir::AttrTypeWalker walker;
+            walker.addWalk([&](mlir_type t) {
+                if (auto td = mlir::dyn_cast< TypedefType >(t)) {
+                    refs.push_back({ ref_kind::type_def, td.getName() });
+                } else if (auto rt = mlir::dyn_cast< RecordType >(t)) {
+                    refs.push_back({ ref_kind::record, rt.getName() });
+                }
+            });
 
-        bool keep(core::aggregate_interface op, auto scope) const {
-            return keep_only_if_used;
-        }
+            for (auto t : op->getResultTypes()) {
+                walker.walk(t);
+            }
 
-        bool keep(hl::TypeDefOp op, auto scope)       const { return keep_only_if_used; }
-        bool keep(hl::TypeDeclOp op, auto scope)      const { return keep_only_if_used; }
+            for (auto t : op->getOperandTypes()) {
+                walker.walk(t);
+            }
 
-        // Mark field to be kept if the parent aggregate is kept
-        bool keep(hl::FieldDeclOp op, auto scope) const { return keep(op.getAggregate(), scope); }
+            walker.walk(op->getAttrDictionary());
 
-        bool keep(hl::FuncOp op, auto scope) const {
-            return !op.isDeclaration() && !util::has_attr< hl::AlwaysInlineAttr >(op);
+            if (auto fn = mlir::dyn_cast< core::function_op_interface >(op)) {
+                for (auto t : fn.getResultTypes()) {
+                    walker.walk(t);
+                }
+
+                for (auto t : fn.getArgumentTypes()) {
+                    walker.walk(t);
+                }
+            }
         }
 
-        bool keep(hl::VarDeclOp op, auto scope) const {
-            VAST_CHECK(!op.hasExternalStorage() || op.getInitializer().empty(), "extern variable with initializer");
-            return !op.hasExternalStorage();
+        static void collect_symbol_refs(operation op, auto &refs) {
+            if (auto ref = mlir::dyn_cast< DeclRefOp >(op)) {
+                refs.push_back({ ref_kind::var, ref.getName() });
+            } else if (auto call = mlir::dyn_cast< CallOp >(op)) {
+                refs.push_back({ ref_kind::func, call.getCallee() });
+            } else if (auto ref = mlir::dyn_cast< FuncRefOp >(op)) {
+                refs.push_back({ ref_kind::func, ref.getFunction() });
+            }
         }
 
-        bool is_unused_impl(auto op, auto scope, auto &seen) {
-            if (keep(op, scope)) {
-                VAST_UDE_DEBUG("keep: {0}", *op);
-                return false;
+        void add_definition(operation op) {
+            llvm::TypeSwitch< operation >(op)
+                .Case([&](core::aggregate_interface agg) {
+                    records[agg.getDefinedName()].push_back(op);
+                })
+                .Case([&](TypeDefOp td)  { type_defs[td.getSymName()].push_back(op); })
+                .Case([&](TypeDeclOp td) { records[td.getSymName()].push_back(op); })
+                .Case([&](FuncOp fn)     { funcs[fn.getSymbolName()].push_back(op); })
+                .Case([&](VarDeclOp var) { vars[var.getSymbolName()].push_back(op); });
+        }
+
+        void add_user(operation op, operation definition) {
+            user_node node;
+            collect_type_refs(op, node.refs);
+            collect_symbol_refs(op, node.refs);
+
+            if (node.refs.empty()) {
+                return;
             }
 
-            auto result = hl::users(op, scope, [&](operation user) -> walk_result {
-                VAST_UDE_DEBUG("user: {0} of {1}", *user, *op);
-                // Ignore top-level use
-                if (user == scope) {
-                    return walk_result::advance();
+            if (definition) {
+                node.conditions.push_back(definition);
+            }
+
+            if (auto parent = op->getParentOfType< FuncOp >()) {
+                node.conditions.push_back(parent);
+            }
+
+            users.push_back(std::move(node));
+        }
+
+        void mark(operation def, std::vector< unsigned > &activated) {
+            if (!live.insert(def).second) {
+                return;
+            }
+
+            if (auto it = waiting.find(def); it != waiting.end()) {
+                for (auto idx : it->second) {
+                    if (--users[idx].pending == 0) {
+                        activated.push_back(idx);
+                    }
+                }
+            }
+        }
+
+        // Marks everything reachable from the roots through active users.
+        void mark_live() {
+            std::vector< unsigned > activated;
+            for (auto &&[idx, user] : llvm::enumerate(users)) {
+                user.pending = user.conditions.size();
+                if (user.pending == 0) {
+                    activated.push_back(idx);
                 }
 
-                if (is_unused(user, scope, seen)) {
-                    VAST_UDE_DEBUG("unused user: {0}", *user);
-                    return walk_result::advance();
+                for (auto cond : user.conditions) {
+                    waiting[cond].push_back(idx);
                 }
+            }
+
+            for (auto root : roots) {
+                mark(root, activated);
+            }
+
+            while (!activated.empty()) {
+                auto idx = activated.back();
+                activated.pop_back();
 
-                // If the user is an always inlined function that is not used,
-                // we mark it as unused.
-                if (auto parent = user->template getParentOfType< hl::FuncOp >()) {
-                    if (is_unused(parent, scope, seen)) {
-                        VAST_UDE_DEBUG("user in always inlined function: {0}", *user);
-                        return walk_result::advance();
+                for (const auto &ref : users[idx].refs) {
+                    auto &defs = definitions(ref.kind);
+                    if (auto it = defs.find(ref.name); it != defs.end()) {
+                        for (auto def : it->second) {
+                            mark(def, activated);
+                        }
                     }
                 }
+            }
+        }
 
-                // We interrupt the walk if the operation is used
-                return walk_result::interrupt();
-            });
+        bool is_live(operation op) const { return live.contains(op); }
+    };
 
-            // Operation is used if the walk was interrupted so we need to keep it.
-            return !result.wasInterrupted();
+    struct UDE : UDEBase< UDE >
+    {
+        using base = UDEBase< UDE >;
+
+        bool keep(core::aggregate_interface op) const { return keep_only_if_used; }
+
+        bool keep(hl::TypeDefOp op)  const { return keep_only_if_used; }
+        bool keep(hl::TypeDeclOp op) const { return keep_only_if_used; }
+
+        bool keep(hl::FuncOp op) const {
+            return !op.isDeclaration() && !util::has_attr< hl::AlwaysInlineAttr >(op);
         }
 
-        bool is_unused(operation op, auto scope, auto &seen) {
-            if (unused_cached.contains(op)) {
-                VAST_UDE_DEBUG("cached: {0}", *op);
-                return true;
-            }
+        bool keep(hl::VarDeclOp op) const {
+            VAST_CHECK(!op.hasExternalStorage() || op.getInitializer().empty(), "extern variable with initializer");
+            return !op.hasExternalStorage();
+        }
 
-            if (const auto [_, inserted] = seen.insert(op); !inserted) {
-                VAST_UDE_DEBUG("recursive: {0}", *op);
-                // Already processed, the operation has recursive dependency.
-                // We can safely return true here, as some other user
-                // needs to determine if the operation is to be kept.
-                return true;
-            }
+        // Returns the definition whose liveness conditions uses made by the
+        // operation or null if the operation is not a definition or is kept.
+        // Fields are alive together with their parent aggregate.
+        operation definition_of(operation op, use_graph &graph) const {
+            auto conditional = [&](auto def) -> operation {
+                if (keep(def)) {
+                    VAST_UDE_DEBUG("keep: {0}", *op);
+                    graph.roots.push_back(def.getOperation());
+                    return nullptr;
+                }
+                return def.getOperation();
+            };
 
-            VAST_UDE_DEBUG("processing: {0}", *op);
-            bool result = llvm::TypeSwitch< operation, bool >(op)
-                .Case([&](core::aggregate_interface op) {
-                    return is_unused_impl(op, scope, seen);
+            return llvm::TypeSwitch< operation, operation >(op)
+                .Case([&](core::aggregate_interface op) { return conditional(op); })
+                .Case([&](hl::FieldDeclOp op) -> operation {
+                    return op.getAggregate().getOperation();
                 })
-                .Case([&](hl::FieldDeclOp op)     { return is_unused_impl(op, scope, seen); })
-                .Case([&](hl::TypeDefOp op)       { return is_unused_impl(op, scope, seen); })
-                .Case([&](hl::TypeDeclOp op)      { return is_unused_impl(op, scope, seen); })
-                .Case([&](hl::FuncOp op)          { return is_unused_impl(op, scope, seen); })
-                .Case([&](hl::VarDeclOp op)       { return is_unused_impl(op, scope, seen); })
-                .Default([&](operation)           { return false; });
+                .Case([&](hl::TypeDefOp op)  { return conditional(op); })
+                .Case([&](hl::TypeDeclOp op) { return conditional(op); })
+                .Case([&](hl::FuncOp op)     { return conditional(op); })
+                .Case([&](hl::VarDeclOp op)  { return conditional(op); })
+                .Default([&](operation)      { return nullptr; });
+        }
 
-            if (result) {
-                unused_cached.insert(op);
-            }
+        use_graph build_use_graph(operation scope) const {
+            use_graph graph;
+            scope->walk([&](operation op) {
+                // Ignore top-level use
+                if (op == scope) {
+                    return;
+                }
+
+                graph.add_definition(op);
+                graph.add_user(op, definition_of(op, graph));
+            });
 
-            return result;
+            return graph;
         }
 
-        std::vector< operation > gather_unused(auto scope) {
+        std::vector< operation > gather_unused(auto scope, const use_graph &graph) const {
             std::vector< operation > unused_operations;
             for (auto &op : scope.getOps()) {
-                std::unordered_set< operation > seen;
-                if (is_unused(&op, scope, seen)) {
+                auto is_definition = mlir::isa<
+                    core::aggregate_interface, hl::TypeDefOp, hl::TypeDeclOp,
+                    hl::FuncOp, hl::VarDeclOp
+                >(op);
+
+                if (is_definition && !graph.is_live(&op)) {
+                    VAST_UDE_DEBUG("unused: {0}", op);
                     unused_operations.push_back(&op);
                 }
             }
@@ -148,7 +281,11 @@ namespace vast::hl {
 
         void runOnOperation() override {
             auto mod = getOperation();
-            auto unused = gather_unused(mod);
+
+            auto graph = build_use_graph(mod);
+            graph.mark_live();
+
+            auto unused = gather_unused(mod, graph);
 
             llvm::DenseSet< mlir_type > unused_types;
             for (auto &op : unused) {
@@ -165,16 +302,23 @@ namespace vast::hl {
                 }
             }
 
+            llvm::DenseMap< mlir_type, bool > contains_unused_cache;
             auto contains_unused_subtype = [&] (mlir_type type) {
-                return contains_subtype(type, [&] (mlir_type sub) {
+                if (auto it = contains_unused_cache.find(type); it != contains_unused_cache.end()) {
+                    return it->second;
+                }
+
+                auto result = contains_subtype(type, [&] (mlir_type sub) {
                     return unused_types.contains(sub);
                 });
+                return contains_unused_cache[type] = result;
             };
 
-            dl::filter_data_layout(mod, [&] (const auto &entry) {
-                auto type = entry.getKey().template get< mlir_type >();
-                return !contains_unused_subtype(type);
-            });
+            if (!unused_types.empty()) {
+                dl::filter_data_layout(mod, [&] (mlir_type type) {
+                    return !contains_unused_subtype(type);
+                });
+            }
 
             for (auto op : unused) {
                 op->erase();
@@ -16,6 +16,7 @@ VAST_UNRELAX_WARNINGS
 
 #include "vast/Dialect/LowLevel/LowLevelOps.hpp"
 
+#include "vast/Util/PatternProfiler.hpp"
 #include "vast/Util/Symbols.hpp"
 
 #include <iostream>
@@ -44,7 +45,13 @@ namespace vast::ll
 
         mlir::RewritePatternSet patterns(&mctx);
 
-        if (mlir::failed(mlir::applyPartialConversion(op, target, std::move(patterns))))
+        auto result = util::profile_conversion(
+            &mctx, getArgument(), std::move(patterns), [&](const auto &frozen) {
+                return mlir::applyPartialConversion(op, target, frozen);
+            }
+        );
+
+        if (mlir::failed(result))
             return signalPassFailure();
     }
 } // namespace vast::ll
@@ -2,6 +2,12 @@
 
 #include "vast/Frontend/Action.hpp"
 
+VAST_RELAX_WARNINGS
+#include <llvm/Support/Path.h>
+#include <llvm/Support/SourceMgr.h>
+#include <mlir/Parser/Parser.h>
+VAST_UNRELAX_WARNINGS
+
 #include "vast/Util/Common.hpp"
 #include "vast/Frontend/Consumer.hpp"
 
@@ -71,11 +77,42 @@ namespace vast::cc {
         : action(act), vargs(vargs), mctx(mctx)
     {}
 
+    static bool is_mlir_input(string_ref file) {
+        auto ext = llvm::sys::path::extension(file);
+        return ext == ".mlir" || ext == ".mlirbc";
+    }
+
     void vast_stream_action::ExecuteAction() {
-        // FIXME: if (getCurrentFileKind().getLanguage() != Language::CIR)
+        if (is_mlir_input(getCurrentFileOrBufferName())) {
+            return execute_mlir_input_action();
+        }
+
         frontend_action::ExecuteAction();
     }
 
+    void vast_stream_action::execute_mlir_input_action() {
+        auto &ci      = getCompilerInstance();
+        auto &src_mgr = ci.getSourceManager();
+
+        // Clang only sets up the main file, the input is parsed as MLIR text or
+        // bytecode instead.
+        llvm::SourceMgr mlir_src_mgr;
+        mlir_src_mgr.AddNewSourceBuffer(
+            llvm::MemoryBuffer::getMemBuffer(
+                src_mgr.getBufferOrFake(src_mgr.getMainFileID()),
+                /* RequiresNullTerminator */ false
+            ),
+            llvm::SMLoc()
+        );
+
+        auto mod = mlir::parseSourceFile< mlir_module >(mlir_src_mgr, mlir::ParserConfig(&mctx));
+        if (!mod) {
+            VAST_FATAL("failed to parse MLIR input: {0}", getCurrentFileOrBufferName());
+        }
+
+        consumer->handle_mlir_input(ci.getASTContext(), std::move(mod));
+    }
+
     auto vast_stream_action::CreateASTConsumer(compiler_instance &ci, string_ref input)
         -> std::unique_ptr< clang::ASTConsumer >
     {
@@ -0,0 +1,303 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Frontend/CompileCache.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/SHA256.h>
+#include <llvm/Support/SourceMgr.h>
+
+#include <mlir/Bytecode/BytecodeWriter.h>
+#include <mlir/Dialect/LLVMIR/Transforms/Passes.h>
+#include <mlir/Parser/Parser.h>
+#include <mlir/Pass/Pass.h>
+#include <mlir/Pass/PassRegistry.h>
+#include <mlir/Transforms/Passes.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Config/config.h"
+
+#include "vast/Conversion/Passes.hpp"
+#include "vast/Dialect/HighLevel/Passes.hpp"
+
+#include <array>
+#include <mutex>
+
+namespace vast::cc {
+
+    namespace fs = std::filesystem;
+
+    namespace {
+
+        constexpr string_ref entry_extension = ".mlirbc";
+
+        struct hasher
+        {
+            llvm::SHA256 sha;
+
+            // Separate updates so that concatenation of parts is not ambiguous.
+            void update(string_ref part) {
+                sha.update(part);
+                sha.update(llvm::ArrayRef< uint8_t >{ 0 });
+            }
+
+            compile_cache::key_t final() { return llvm::toHex(sha.final(), /* lower */ true); }
+        };
+
+        // Stores the module it runs on as the result of a pipeline prefix.
+        struct store_step_pass
+            : mlir::PassWrapper< store_step_pass, mlir::OperationPass< mlir_module > >
+        {
+            MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(store_step_pass)
+
+            store_step_pass(const compile_cache &cache, compile_cache::key_t key)
+                : cache(cache), key(std::move(key))
+            {}
+
+            void runOnOperation() override {
+                cache.store(key, getOperation());
+                markAllAnalysesPreserved();
+            }
+
+            const compile_cache &cache;
+            compile_cache::key_t key;
+        };
+
+        // Options known not to change the generated module: they select the
+        // output (the pipeline they imply is hashed separately for each step),
+        // configure the cache, or only change how the compilation is reported
+        // and scheduled. Any other option is part of the key.
+        constexpr std::array< option_t, 21 > keyless_options = {
+            opt::emit_llvm, opt::emit_obj, opt::emit_asm, opt::emit_mlir,
+            opt::emit_mlir_after, opt::emit_mlir_bytecode,
+            opt::cache_dir, opt::cache_size_limit,
+            opt::batch, opt::batch_jobs, opt::batch_output, opt::batch_report,
+            opt::print_pipeline, opt::pipeline_stats, opt::pipeline_stats_measure,
+            opt::profile_patterns,
+            opt::output_sarif, opt::disable_multithreading, opt::codegen_jobs,
+            opt::dynamic_visitor_list, opt::debug
+        };
+
+        bool affects_generated_module(string_ref arg) {
+            auto name = arg.drop_front(vast_option_prefix.size()).split('=').first;
+            return !llvm::is_contained(keyless_options, name);
+        }
+
+    } // namespace
+
+    std::optional< compile_cache > compile_cache::from_args(const vast_args &vargs) {
+        auto dir = vargs.get_option(opt::cache_dir);
+        if (!dir) {
+            return std::nullopt;
+        }
+
+        // These options need the pipeline to actually run.
+        if (vargs.has_option(opt::snapshot_at) || vargs.has_option(opt::emit_crash_reproducer)
+            || vargs.has_option(opt::vast_verify_diags) || vargs.has_option(opt::output_sarif)
+            || vargs.has_option(opt::branch))
+        {
+            return std::nullopt;
+        }
+
+        std::uint64_t size_limit = default_size_limit;
+        if (auto limit = vargs.get_option(opt::cache_size_limit)) {
+            VAST_CHECK(
+                !limit->getAsInteger(10, size_limit), "invalid cache size limit: {0}", *limit
+            );
+        }
+
+        std::error_code ec;
+        fs::create_directories(dir->str(), ec);
+        VAST_CHECK(!ec, "failed to create cache directory {0}: {1}", *dir, ec.message());
+
+        return compile_cache(dir->str(), size_limit);
+    }
+
+    compile_cache::key_t compile_cache::input_key(
+        const clang::SourceManager &src_mgr, const invocation_options &invocation,
+        const vast_args &vargs
+    ) {
+        hasher h;
+        h.update(vast::version);
+
+        // Language, target, preprocessor and codegen options that change
+        // the meaning of the translation unit.
+        h.update(invocation.getModuleHash());
+
+        for (auto arg : vargs.args) {
+            if (affects_generated_module(arg)) {
+                h.update(arg);
+            }
+        }
+
+        // Buffers of all entered files in the order of inclusion, including
+        // predefines, amount to the preprocessed translation unit.
+        for (unsigned idx = 0; idx < src_mgr.local_sloc_entry_size(); ++idx) {
+            const auto &entry = src_mgr.getLocalSLocEntry(idx);
+            if (!entry.isFile()) {
+                continue;
+            }
+
+            if (auto buffer = entry.getFile().getContentCache().getBufferIfLoaded()) {
+                h.update(buffer->getBufferIdentifier());
+                h.update(buffer->getBuffer());
+            }
+        }
+
+        return h.final();
+    }
+
+    compile_cache::key_t compile_cache::step_key(
+        const key_t &input, llvm::ArrayRef< std::string > steps
+    ) {
+        hasher h;
+        h.update(input);
+        for (const auto &step : steps) {
+            h.update(step);
+        }
+        return h.final();
+    }
+
+    fs::path compile_cache::entry(const key_t &key) const {
+        return dir / (key + entry_extension.str());
+    }
+
+    owning_mlir_module_ref compile_cache::load(const key_t &key, mcontext_t &mctx) const {
+        auto path = entry(key);
+
+        // The entry might have been evicted by a concurrent job in the meantime,
+        // which is just a miss.
+        auto buffer = llvm::MemoryBuffer::getFile(path.string());
+        if (!buffer) {
+            return nullptr;
+        }
+
+        llvm::SourceMgr src_mgr;
+        src_mgr.AddNewSourceBuffer(std::move(*buffer), llvm::SMLoc());
+        auto mod = mlir::parseSourceFile< mlir_module >(src_mgr, mlir::ParserConfig(&mctx));
+
+        // Mark the entry as recently used.
+        std::error_code ec;
+        fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+        return mod;
+    }
+
+    void compile_cache::store(const key_t &key, mlir_module mod) const {
+        int fd;
+        llvm::SmallString< 128 > tmp;
+        auto model = (dir / ("tmp-%%%%%%%%%%%%" + entry_extension.str() + ".part")).string();
+        if (llvm::sys::fs::createUniqueFile(model, fd, tmp)) {
+            return;
+        }
+
+        bool written = [&] {
+            llvm::raw_fd_ostream os(fd, /* shouldClose */ true);
+            mlir::BytecodeWriterConfig config("VAST");
+            auto result = mlir::writeBytecodeToFile(mod, os, config);
+            os.close();
+            return mlir::succeeded(result) && !os.has_error();
+        } ();
+
+        // Rename is atomic, readers never see a partially written entry.
+        std::error_code ec;
+        if (written) {
+            fs::rename(tmp.str().str(), entry(key), ec);
+        }
+
+        if (!written || ec) {
+            fs::remove(tmp.str().str(), ec);
+        }
+    }
+
+    void compile_cache::evict() const {
+        struct entry_info
+        {
+            fs::path path;
+            std::uintmax_t size;
+            fs::file_time_type used;
+        };
+
+        std::vector< entry_info > entries;
+        std::uintmax_t total = 0;
+
+        std::error_code ec;
+        for (const auto &file : fs::directory_iterator(dir, ec)) {
+            if (file.path().extension() != entry_extension.str()) {
+                continue;
+            }
+
+            std::error_code file_ec;
+            auto size = file.file_size(file_ec);
+            auto used = file.last_write_time(file_ec);
+            if (file_ec) {
+                continue;
+            }
+
+            entries.push_back({ file.path(), size, used });
+            total += size;
+        }
+
+        auto limit = size_limit * 1024 * 1024;
+        if (total <= limit) {
+            return;
+        }
+
+        std::ranges::sort(entries, {}, &entry_info::used);
+        for (const auto &[path, size, _] : entries) {
+            if (total <= limit) {
+                break;
+            }
+
+            // Entries removed by concurrent jobs are gone either way.
+            fs::remove(path, ec);
+            total -= size;
+        }
+    }
+
+    logical_result parse_pipeline_steps(
+        llvm::ArrayRef< std::string > steps, mlir::OpPassManager &pm
+    ) {
+        // Resumed pipelines are reconstructed from their textual form, so the
+        // passes that can be scheduled by the frontend need to be registered.
+        static std::once_flag registered;
+        std::call_once(registered, [] {
+            mlir::LLVM::registerLLVMPasses();
+            mlir::registerTransformsPasses();
+            hl::registerHighLevelPasses();
+            registerConversionPasses();
+        });
+
+        return mlir::parsePassPipeline(llvm::join(steps, ","), pm, llvm::nulls());
+    }
+
+    std::vector< std::string > pipeline_steps(mlir::OpPassManager &pm) {
+        std::vector< std::string > steps;
+        for (auto &pass : pm.getPasses()) {
+            std::string step;
+            llvm::raw_string_ostream os(step);
+            pass.printAsTextualPipeline(os);
+            steps.push_back(std::move(step));
+        }
+        return steps;
+    }
+
+    logical_result schedule_cached_steps(
+        const compile_cache &cache, const compile_cache::key_t &input,
+        llvm::ArrayRef< std::string > steps, std::size_t done, mlir::OpPassManager &pm
+    ) {
+        for (auto step = done; step < steps.size(); ++step) {
+            if (mlir::failed(parse_pipeline_steps(steps[step], pm))) {
+                return mlir::failure();
+            }
+
+            auto key = compile_cache::step_key(input, steps.take_front(step + 1));
+            pm.addPass(std::make_unique< store_step_pass >(cache, std::move(key)));
+        }
+
+        return mlir::success();
+    }
+
+} // namespace vast::cc
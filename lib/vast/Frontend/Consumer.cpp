@@ -24,7 +24,9 @@ VAST_UNRELAX_WARNINGS
 #include "vast/CodeGen/CodeGenDriver.hpp"
 
 #include "vast/Util/Common.hpp"
+#include "vast/Util/PatternProfiler.hpp"
 
+#include "vast/Frontend/CompileCache.hpp"
 #include "vast/Frontend/Pipelines.hpp"
 #include "vast/Frontend/Sarif.hpp"
 #include "vast/Frontend/Targets.hpp"
@@ -43,7 +45,10 @@ namespace vast::cc {
 
     void vast_consumer::Initialize(acontext_t &actx) {
         VAST_CHECK(!driver, "initialized multiple times");
-        driver = cg::mk_default_driver(opts, vargs, actx, mctx);
+        this->actx = &actx;
+        timed_codegen("init", [&] {
+            driver = cg::mk_default_driver(opts, vargs, actx, mctx);
+        });
     }
 
     bool vast_consumer::HandleTopLevelDecl(clang::DeclGroupRef decls) {
@@ -51,7 +56,7 @@ namespace vast::cc {
             return true;
         }
 
-        driver->emit(decls);
+        timed_codegen("emit", [&] { driver->emit(decls); });
         return true;
     }
 
@@ -71,7 +76,7 @@ namespace vast::cc {
         // Note that this method is called after `HandleTopLevelDecl` has already
         // ran all over the top level decls. Here clang mostly wraps defered and
         // global codegen, followed by running vast passes.
-        driver->finalize();
+        timed_codegen("finalize", [&] { driver->finalize(); });
     }
 
     void vast_consumer::HandleTagDeclDefinition(clang::TagDecl *decl) {
@@ -125,10 +130,97 @@ namespace vast::cc {
         return std::nullopt;
     }
 
+    void vast_stream_consumer::Initialize(acontext_t &actx) {
+        base::Initialize(actx);
+        cache = compile_cache::from_args(vargs);
+        if (streams_functions()) {
+            driver->enable_streaming();
+        }
+    }
+
+    bool vast_stream_consumer::HandleTopLevelDecl(clang::DeclGroupRef decls) {
+        // MLIR input has no codegen driver, the module is processed as a whole
+        // by `handle_mlir_input`.
+        if (source == pipeline_source::mlir) {
+            return true;
+        }
+
+        if (cache) {
+            deferred_decls.push_back(decls);
+            return true;
+        }
+        return base::HandleTopLevelDecl(decls);
+    }
+
     void vast_stream_consumer::HandleTranslationUnit(acontext_t &actx) {
+        if (source == pipeline_source::mlir) {
+            return;
+        }
+
+        if (cache) {
+            // Codegen is skipped entirely if the whole pipeline is cached.
+            if (!opts.diags.hasErrorOccurred()) {
+                if (auto mod = load_cached_result(*cache)) {
+                    cached_result = true;
+                    return emit(std::move(mod));
+                }
+            }
+
+            for (auto decls : deferred_decls) {
+                base::HandleTopLevelDecl(decls);
+            }
+            deferred_decls.clear();
+        }
+
+        if (streams_functions()) {
+            switch (action) {
+                case output_type::emit_assembly:
+                    return emit_streamed_backend_output(backend::Backend_EmitAssembly);
+                case output_type::emit_llvm:
+                    return emit_streamed_backend_output(backend::Backend_EmitLL);
+                case output_type::emit_obj:
+                    return emit_streamed_backend_output(backend::Backend_EmitObj);
+                default:
+                    VAST_UNREACHABLE("unexpected streamed output");
+            }
+        }
+
         base::HandleTranslationUnit(actx);
-        auto mod = result();
+        emit(result());
+    }
+
+    bool vast_stream_consumer::streams_functions() const {
+        // Functions are streamed as the driver generates them.
+        if (source == pipeline_source::mlir) {
+            return false;
+        }
+
+        if (!vargs.has_option(opt::stream_functions)) {
+            return false;
+        }
 
+        // These options need the whole module at once.
+        for (auto option : {
+            opt::snapshot_at, opt::branch, opt::cache_dir, opt::vast_verify_diags,
+            opt::output_sarif, opt::emit_crash_reproducer
+        }) {
+            if (vargs.has_option(option)) {
+                return false;
+            }
+        }
+
+        return action == output_type::emit_assembly
+            || action == output_type::emit_llvm
+            || action == output_type::emit_obj;
+    }
+
+    void vast_stream_consumer::handle_mlir_input(acontext_t &actx, owning_mlir_module_ref mod) {
+        this->actx = &actx;
+        source     = pipeline_source::mlir;
+        emit(std::move(mod));
+    }
+
+    void vast_stream_consumer::emit(owning_mlir_module_ref mod) {
         switch (action) {
             case output_type::emit_assembly:
                 return emit_backend_output(backend::Backend_EmitAssembly, std::move(mod));
@@ -156,7 +248,51 @@ namespace vast::cc {
 
         auto final_mlir_module = mlir::cast< mlir_module >(mod->getBody()->front());
         auto llvm_mod          = target::llvmir::translate(final_mlir_module, llvm_context);
-        auto dl                = driver->acontext().getTargetInfo().getDataLayoutString();
+        auto dl                = actx->getTargetInfo().getDataLayoutString();
+
+        clang::EmitBackendOutput(
+            opts.diags, opts.headers, opts.codegen, opts.target, opts.lang, dl, llvm_mod.get(),
+            backend_action, &opts.vfs, std::move(output_stream)
+        );
+    }
+
+    void vast_stream_consumer::emit_streamed_backend_output(backend backend_action) {
+        VAST_CHECK(driver, "streaming requires the codegen driver");
+
+        llvm::LLVMContext llvm_context;
+        streamed_module streamed;
+
+        bool profile_patterns = vargs.has_option(opt::profile_patterns);
+        if (profile_patterns) {
+            util::enable_pattern_profiling();
+            // the context may have been used by a previous unit of a batch
+            util::reset_pattern_profiles(&mctx);
+        }
+
+        timed_codegen("stream", [&] {
+            driver->emit_definitions([&] (hl::FuncOp fn) {
+                auto part = streamed.extract(driver->module(), fn);
+                // Lowering needs layout of types the part refers to, the full
+                // table is attached to the remaining module only.
+                driver->emit_data_layout(mlir::cast< core::module >(part->getBody()->front()));
+                streamed.link_function(lower_to_llvm(part.get(), llvm_context));
+            });
+        });
+
+        base::HandleTranslationUnit(*actx);
+        auto rest = result();
+        streamed.link_rest(lower_to_llvm(rest.get(), llvm_context));
+
+        if (auto path = vargs.get_option(opt::pipeline_stats); path && stats) {
+            stats->write(path.value());
+        }
+
+        if (profile_patterns) {
+            util::print_pattern_profiles(&mctx, llvm::errs());
+        }
+
+        auto llvm_mod = streamed.finish();
+        auto dl       = actx->getTargetInfo().getDataLayoutString();
 
         clang::EmitBackendOutput(
             opts.diags, opts.headers, opts.codegen, opts.target, opts.lang, dl, llvm_mod.get(),
@@ -164,6 +300,24 @@ namespace vast::cc {
         );
     }
 
+    std::unique_ptr< llvm::Module > vast_stream_consumer::lower_to_llvm(
+        mlir_module mod, llvm::LLVMContext &llvm_context
+    ) {
+        auto pipeline = setup_pipeline(source, target_dialect::llvm, mctx, vargs);
+        VAST_CHECK(pipeline, "failed to setup pipeline");
+
+        if (stats) {
+            pipeline->addInstrumentation(stats->instrument(*pipeline));
+        }
+
+        VAST_CHECK(
+            mlir::succeeded(pipeline->run(mod)), "MLIR pass manager failed when running vast passes"
+        );
+
+        auto final_mlir_module = mlir::cast< mlir_module >(mod.getBody()->front());
+        return target::llvmir::translate(final_mlir_module, llvm_context);
+    }
+
     namespace sarif {
         struct diagnostics;
     } // namespace sarif
@@ -202,8 +356,7 @@ namespace vast::cc {
     void vast_stream_consumer::process_mlir_module(target_dialect target, mlir_module mod) {
         // Handle source manager properly given that lifetime analysis
         // might emit warnings and remarks.
-        auto &src_mgr     = driver->acontext().getSourceManager();
-        auto &mctx        = driver->mcontext();
+        auto &src_mgr     = actx->getSourceManager();
         auto main_file_id = src_mgr.getMainFileID();
 
         auto file_buff = llvm::MemoryBuffer::getMemBuffer(
@@ -228,19 +381,58 @@ namespace vast::cc {
         VAST_CHECK(file_entry, "failed to recover file entry ref");
         auto snapshot_prefix = std::filesystem::path(file_entry->getName().str()).stem().string();
 
-        auto pipeline = setup_pipeline(pipeline_source::ast, target, mctx, vargs, snapshot_prefix);
+        auto pipeline = setup_pipeline(source, target, mctx, vargs, snapshot_prefix, mod);
         VAST_CHECK(pipeline, "failed to setup pipeline");
 
+        if (stats) {
+            pipeline->addInstrumentation(stats->instrument(*pipeline));
+        }
+
+        bool profile_patterns = vargs.has_option(opt::profile_patterns);
+        if (profile_patterns) {
+            util::enable_pattern_profiling();
+            // the context may have been used by a previous unit of a batch
+            util::reset_pattern_profiles(&mctx);
+        }
+
         #ifdef VAST_ENABLE_SARIF
         auto sarif_diagnostics = setup_sarif_diagnostics(vargs, mctx);
         #endif // VAST_ENABLE_SARIF
 
-        auto result = pipeline->run(mod);
+        // MLIR input does not initialize the consumer.
+        if (!cache) {
+            cache = compile_cache::from_args(vargs);
+        }
+
+        auto result = mlir::success();
+        if (!cached_result) {
+            result = cache ? run_cached_pipeline(*cache, *pipeline, mod) : pipeline->run(mod);
+        }
 
         VAST_CHECK(
             mlir::succeeded(result), "MLIR pass manager failed when running vast passes"
         );
 
+        VAST_CHECK(
+            mlir::succeeded(pipeline->join_branches()),
+            "MLIR pass manager failed when running vast pipeline branches"
+        );
+
+        for (const auto &branch : pipeline->branches) {
+            std::error_code ec;
+            llvm::raw_fd_ostream os(snapshot_prefix + "." + branch->name + ".mlir", ec);
+            VAST_CHECK(!ec, "Cannot open file to store branch result: {0}", ec.message());
+            branch->module->print(os);
+        }
+
+        if (auto path = vargs.get_option(opt::pipeline_stats); path && stats) {
+            stats->write(path.value());
+        }
+
+        if (profile_patterns) {
+            util::print_pattern_profiles(&mctx, llvm::errs());
+        }
+
         // Verify the diagnostic handler to make sure that each of the
         // diagnostics matched.
         if (verify_diagnostics && src_mgr_handler.verify().failed()) {
@@ -268,6 +460,77 @@ namespace vast::cc {
         // }
     }
 
+    std::optional< target_dialect > vast_stream_consumer::output_target() const {
+        switch (action) {
+            case output_type::emit_mlir:
+                return get_target_dialect(vargs);
+            case output_type::emit_assembly:
+            case output_type::emit_llvm:
+            case output_type::emit_obj:
+                return target_dialect::llvm;
+            case output_type::none:
+                return std::nullopt;
+        }
+        VAST_UNREACHABLE("unknown output type");
+    }
+
+    owning_mlir_module_ref vast_stream_consumer::load_cached_result(const compile_cache &cache) {
+        auto target = output_target();
+        if (!target) {
+            return nullptr;
+        }
+
+        auto pipeline = setup_pipeline(source, *target, mctx, vargs);
+        VAST_CHECK(pipeline, "failed to setup pipeline");
+
+        auto input = compile_cache::input_key(actx->getSourceManager(), opts.invocation, vargs);
+        return cache.load(compile_cache::step_key(input, pipeline_steps(*pipeline)), mctx);
+    }
+
+    logical_result vast_stream_consumer::run_cached_pipeline(
+        const compile_cache &cache, vast_pipeline &pipeline, mlir_module mod
+    ) {
+        auto input = compile_cache::input_key(actx->getSourceManager(), opts.invocation, vargs);
+        auto steps = pipeline_steps(pipeline);
+
+        auto finish = [&] (logical_result result) {
+            cache.evict();
+            return result;
+        };
+
+        // Resume from the deepest cached step of the pipeline.
+        auto done = steps.size();
+        owning_mlir_module_ref cached;
+        for (; done > 0; --done) {
+            auto prefix = llvm::ArrayRef(steps).take_front(done);
+            if ((cached = cache.load(compile_cache::step_key(input, prefix), mctx))) {
+                break;
+            }
+        }
+
+        // Each remaining step is followed by a store of its result.
+        auto rest = std::make_unique< vast_pipeline >(mctx, vargs);
+        if (mlir::failed(schedule_cached_steps(cache, input, steps, done, *rest))) {
+            return finish(pipeline.run(mod));
+        }
+
+        if (cached) {
+            mod->setAttrs(cached->getOperation()->getAttrDictionary());
+            mod.getBodyRegion().takeBody(cached->getBodyRegion());
+        }
+
+        if (done == steps.size()) {
+            return finish(mlir::success());
+        }
+
+        rest->print_on_error(llvm::errs());
+        rest->enableVerifier(!vargs.has_option(cc::opt::disable_vast_verifier));
+        if (stats) {
+            rest->addInstrumentation(stats->instrument(*rest));
+        }
+        return finish(rest->run(mod));
+    }
+
     void vast_stream_consumer::emit_mlir_output(
         target_dialect target, owning_mlir_module_ref mod
     ) {
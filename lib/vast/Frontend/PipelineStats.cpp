@@ -0,0 +1,258 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Frontend/PipelineStats.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/Config/llvm-config.h>
+#include <llvm/Support/FormatVariadic.h>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/raw_ostream.h>
+#include <mlir/IR/AttrTypeSubElements.h>
+#include <mlir/IR/BuiltinOps.h>
+VAST_UNRELAX_WARNINGS
+
+#include <optional>
+
+#ifdef LLVM_ON_UNIX
+    #include <sys/resource.h>
+#endif
+
+namespace vast::cc {
+
+    namespace {
+
+        std::int64_t peak_rss_kb() {
+        #ifdef LLVM_ON_UNIX
+            struct rusage usage;
+            if (getrusage(RUSAGE_SELF, &usage) == 0) {
+                return usage.ru_maxrss;
+            }
+        #endif
+            return 0;
+        }
+
+        // Operations that are transformed by a single thread at a time, nested
+        // passes may run in parallel on their children.
+        bool is_module_level(operation op) {
+            auto parent = op->getParentOp();
+            return !parent || mlir::isa< mlir::ModuleOp >(parent);
+        }
+
+        // Distinct types and attributes are counted only for module-level runs,
+        // they are not additive over parallel runs on functions.
+        pipeline_stats::ir_size measure(operation op) {
+            pipeline_stats::ir_size size;
+
+            if (!is_module_level(op)) {
+                op->walk([&](operation) { ++size.ops; });
+                return size;
+            }
+
+            llvm::DenseSet< mlir_type > types;
+            llvm::DenseSet< mlir_attr > attrs;
+
+            mlir::AttrTypeWalker walker;
+            walker.addWalk([&](mlir_type type) { types.insert(type); });
+            walker.addWalk([&](mlir_attr attr) { attrs.insert(attr); });
+
+            op->walk([&](operation nested) {
+                ++size.ops;
+                walker.walk(nested->getAttrDictionary());
+                for (auto type : nested->getResultTypes()) {
+                    walker.walk(type);
+                }
+                for (auto &region : nested->getRegions()) {
+                    for (auto &block : region) {
+                        for (auto arg : block.getArguments()) {
+                            walker.walk(arg.getType());
+                        }
+                    }
+                }
+            });
+
+            size.types = types.size();
+            size.attrs = attrs.size();
+            return size;
+        }
+
+        pipeline_stats::ir_size &operator+=(
+            pipeline_stats::ir_size &lhs, const pipeline_stats::ir_size &rhs
+        ) {
+            lhs.ops   += rhs.ops;
+            lhs.types += rhs.types;
+            lhs.attrs += rhs.attrs;
+            return lhs;
+        }
+
+        struct stats_instrumentation : mlir::PassInstrumentation
+        {
+            struct run
+            {
+                pipeline_stats::clock::time_point start;
+                std::optional< pipeline_stats::ir_size > before;
+                std::int64_t rss;
+            };
+
+            stats_instrumentation(pipeline_stats &stats, const pipeline_t &pipeline)
+                : stats(stats), pipeline(pipeline)
+            {}
+
+            // Adaptors of nested pass managers have no argument and are not scheduled passes.
+            bool is_scheduled(pass_ptr pass) const { return !pass->getArgument().empty(); }
+
+            bool is_measured(pass_ptr pass) const {
+                const auto &points = stats.measure_points;
+                if (points.empty()) {
+                    return false;
+                }
+
+                if (points.contains(pass->getArgument())) {
+                    return true;
+                }
+
+                return llvm::any_of(pipeline.steps_of(pass->getTypeID()), [&](const auto &step) {
+                    return points.contains(step);
+                });
+            }
+
+            std::optional< pipeline_stats::ir_size > measure_if_requested(
+                pass_ptr pass, operation op
+            ) const {
+                if (!is_measured(pass)) {
+                    return std::nullopt;
+                }
+                return measure(op);
+            }
+
+            void runBeforePass(pass_ptr pass, operation op) override {
+                if (!is_scheduled(pass)) {
+                    return;
+                }
+
+                auto before = measure_if_requested(pass, op);
+                auto rss    = is_module_level(op) ? peak_rss_kb() : 0;
+
+                std::lock_guard lock(stats.mutex);
+                running[{ pass, op }] = { pipeline_stats::clock::now(), before, rss };
+            }
+
+            void runAfterPass(pass_ptr pass, operation op) override { finish(pass, op); }
+
+            void runAfterPassFailed(pass_ptr pass, operation op) override { finish(pass, op); }
+
+            void finish(pass_ptr pass, operation op) {
+                if (!is_scheduled(pass)) {
+                    return;
+                }
+
+                auto end   = pipeline_stats::clock::now();
+                auto after = measure_if_requested(pass, op);
+                auto rss   = is_module_level(op) ? peak_rss_kb() : 0;
+
+                std::lock_guard lock(stats.mutex);
+                auto it = running.find({ pass, op });
+                VAST_ASSERT(it != running.end());
+                auto started = it->second;
+                running.erase(it);
+
+                auto [rec, inserted] = stats.passes.insert({ pass->getTypeID(), {} });
+                auto &record = rec->second;
+                if (inserted) {
+                    record.name  = pass->getArgument().str();
+                    record.steps = pipeline.steps_of(pass->getTypeID()).vec();
+                }
+
+                record.runs++;
+                record.wall += end - started.start;
+                if (started.before && after) {
+                    record.measured = true;
+                    record.before += *started.before;
+                    record.after += *after;
+                }
+                record.peak_rss_delta_kb += rss - started.rss;
+            }
+
+            pipeline_stats &stats;
+            const pipeline_t &pipeline;
+            llvm::DenseMap< std::pair< pass_ptr, operation >, run > running;
+        };
+
+        llvm::json::Object to_json(const pipeline_stats::ir_size &size) {
+            return llvm::json::Object{
+                { "ops", size.ops }, { "types", size.types }, { "attributes", size.attrs }
+            };
+        }
+
+    } // namespace
+
+    std::unique_ptr< mlir::PassInstrumentation > pipeline_stats::instrument(
+        const pipeline_t &pipeline
+    ) {
+        return std::make_unique< stats_instrumentation >(*this, pipeline);
+    }
+
+    void pipeline_stats::write(string_ref path) const {
+        llvm::json::Object codegen_json;
+        for (const auto &[name, record] : codegen) {
+            codegen_json[name] = llvm::json::Object{
+                { "calls", record.calls }, { "wall_ms", record.wall.count() }
+            };
+        }
+
+        struct step_record
+        {
+            std::uint64_t passes = 0;
+            duration wall        = {};
+            std::int64_t peak_rss_delta_kb = 0;
+        };
+
+        llvm::MapVector< string_ref, step_record > steps;
+
+        llvm::json::Array passes_json;
+        for (const auto &[_, record] : passes) {
+            llvm::json::Object pass_json{
+                { "name", record.name },
+                { "steps", llvm::json::Array(record.steps) },
+                { "runs", record.runs },
+                { "wall_ms", record.wall.count() },
+                { "peak_rss_delta_kb", record.peak_rss_delta_kb }
+            };
+
+            if (record.measured) {
+                pass_json["before"] = to_json(record.before);
+                pass_json["after"]  = to_json(record.after);
+            }
+
+            passes_json.push_back(std::move(pass_json));
+
+            // Each enclosing compound step accounts for the pass.
+            for (const auto &step : record.steps) {
+                auto &aggregate = steps[step];
+                aggregate.passes++;
+                aggregate.wall += record.wall;
+                aggregate.peak_rss_delta_kb += record.peak_rss_delta_kb;
+            }
+        }
+
+        llvm::json::Object steps_json;
+        for (const auto &[name, record] : steps) {
+            steps_json[name] = llvm::json::Object{
+                { "passes", record.passes },
+                { "wall_ms", record.wall.count() },
+                { "peak_rss_delta_kb", record.peak_rss_delta_kb }
+            };
+        }
+
+        std::error_code ec;
+        llvm::raw_fd_ostream os(path, ec);
+        VAST_CHECK(!ec, "Cannot open pipeline stats file: {0}", ec.message());
+
+        os << llvm::formatv("{0:2}", llvm::json::Value(llvm::json::Object{
+            { "codegen", std::move(codegen_json) },
+            { "steps", std::move(steps_json) },
+            { "passes", std::move(passes_json) }
+        }));
+    }
+
+} // namespace vast::cc
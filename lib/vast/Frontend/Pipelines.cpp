@@ -2,9 +2,20 @@
 
 #include "vast/Frontend/Pipelines.hpp"
 
+VAST_RELAX_WARNINGS
+#include <mlir/Dialect/LLVMIR/LLVMDialect.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/ABI/ABIDialect.hpp"
+#include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
+#include "vast/Dialect/HighLevel/HighLevelOps.hpp"
+#include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
 #include "vast/Dialect/HighLevel/Passes.hpp"
+#include "vast/Dialect/LowLevel/LowLevelDialect.hpp"
 #include "vast/Conversion/Passes.hpp"
+#include "vast/Frontend/CompileCache.hpp"
 #include "vast/Util/Snapshots.hpp"
+#include "vast/Util/TypeUtils.hpp"
 
 #include <gap/core/overloads.hpp>
 
@@ -40,6 +51,33 @@ namespace vast::cc {
             return conv::pipeline::to_llvm();
         }
 
+        // Passes given in the textual pass pipeline format, nested on vast modules.
+        struct textual_pipeline_step : pipeline_step
+        {
+            explicit textual_pipeline_step(string_ref pipeline) : pipeline(pipeline.str()) {}
+
+            schedule_result schedule_on(pipeline_t &ppl) override {
+                auto result = parse_pipeline_steps(pipeline, ppl.nest< core::module >());
+                VAST_CHECK(mlir::succeeded(result), "invalid branch pipeline: {0}", pipeline);
+                return schedule_result::advance;
+            }
+
+            gap::generator< pipeline_step_ptr > substeps() const override { co_return; }
+
+            string_ref name() const override { return pipeline; }
+            string_ref cli_name() const override { return pipeline; }
+
+            std::string pipeline;
+        };
+
+        // Independent pipeline requested by `-vast-branch`, named after its first pass.
+        pipeline_step_ptr detached(string_ref pipeline) {
+            auto name = pipeline.take_until([] (char c) { return c == '{' || c == ','; });
+            return branch(name.trim(), [pipeline] () -> pipeline_step_ptr {
+                return std::make_unique< textual_pipeline_step >(pipeline);
+            });
+        }
+
         gap::generator< pipeline_step_ptr > codegen() {
             // TODO: pass further options to augment high level MLIR
             co_yield high_level();
@@ -76,25 +114,52 @@ namespace vast::cc {
             { target_dialect::llvm, noguard, { llvm } }
         };
 
+        std::size_t position(target_dialect dialect) {
+            auto it = std::ranges::find_if(default_conversion_path, [&] (const auto &step) {
+                return std::get< target_dialect >(step) == dialect;
+            });
+            VAST_CHECK(
+                it != default_conversion_path.end(),
+                "dialect {0} is not on the conversion path", to_string(dialect)
+            );
+            return std::size_t(std::distance(default_conversion_path.begin(), it));
+        }
+
         gap::generator< pipeline_step_ptr > conversion(
             pipeline_source src,
             target_dialect trg,
-            const vast_args &vargs
+            const vast_args &vargs,
+            std::optional< target_dialect > reached
         ) {
             // TODO: add support for custom conversion paths
             // deduced from source, target and vargs
             const auto path = default_conversion_path;
 
+            // Conversions up to the reached dialect were already applied. High
+            // level module can be still simplified.
+            bool skip = reached && reached != target_dialect::high_level;
+
             for (const auto &[dialect, guard, steps] : path) {
-                if (check_step_guard(guard, vargs)) {
+                if (!skip && check_step_guard(guard, vargs)) {
                     for (auto &step : steps) {
                         co_yield step();
                     }
                 }
 
+                // Layout is kept only for types that high level steps left.
+                bool prune = dialect == target_dialect::high_level
+                    && vargs.has_option(opt::prune_data_layout);
+                if (!skip && prune) {
+                    co_yield hl::pipeline::prune_data_layout();
+                }
+
                 if (trg == dialect) {
                     break;
                 }
+
+                if (reached == dialect) {
+                    skip = false;
+                }
             }
 
             if (vargs.has_option(opt::canonicalize)) {
@@ -104,6 +169,81 @@ namespace vast::cc {
 
     } // namespace pipeline
 
+    static util::snapshot_config get_snapshot_config(const vast_args &vargs) {
+        util::snapshot_config config;
+
+        if (auto format = vargs.get_option(opt::snapshot_format)) {
+            if (format.value() == "bytecode") {
+                config.format = util::snapshot_format::bytecode;
+            } else {
+                VAST_CHECK(format.value() == "text", "unknown snapshot format: {0}", format.value());
+            }
+        }
+
+        config.async    = vargs.has_option(opt::snapshot_async);
+        config.archive  = vargs.has_option(opt::snapshot_archive);
+        config.compress = vargs.has_option(opt::snapshot_compress);
+        return config;
+    }
+
+    target_dialect reached_dialect(mlir_module mod) {
+        bool hl_ops = false, hl_funcs = false, hl_typedefs = false;
+        bool ll_ops = false, abi_ops = false, llvm_ops = false;
+        bool hl_types = false, std_types = false, lvalues = false;
+
+        // Types that are gone once the module is in standard types.
+        auto is_hl_only_type = [] (mlir_type type) {
+            return hl::isBoolType(type) || hl::isIntegerType(type) || hl::isFloatingType(type)
+                || mlir::isa< hl::TypedefType, hl::ElaboratedType, hl::EnumType >(type);
+        };
+
+        // Types that only the conversion to standard types introduces.
+        auto is_std_type = [] (mlir_type type) {
+            return mlir::isa< mlir::IntegerType, mlir::FloatType >(type);
+        };
+
+        auto is_lvalue_type = [] (mlir_type type) { return mlir::isa< hl::LValueType >(type); };
+
+        mod->walk([&] (operation op) {
+            auto dialect = op->getDialect();
+            hl_ops      |= mlir::isa_and_present< hl::HighLevelDialect >(dialect);
+            hl_funcs    |= mlir::isa< hl::FuncOp >(op);
+            hl_typedefs |= mlir::isa< hl::TypeDefOp >(op);
+            ll_ops      |= mlir::isa_and_present< ll::LowLevelDialect >(dialect);
+            abi_ops     |= mlir::isa_and_present< abi::ABIDialect >(dialect);
+            llvm_ops    |= mlir::isa_and_present< mlir::LLVM::LLVMDialect >(dialect);
+            hl_types    |= has_type_somewhere(op, is_hl_only_type);
+            std_types   |= has_type_somewhere(op, is_std_type);
+            lvalues     |= has_type_somewhere(op, is_lvalue_type);
+        });
+
+        // Dialects of the ops present decide the stage first.
+        if (llvm_ops && !hl_ops && !ll_ops && !abi_ops) {
+            return target_dialect::llvm;
+        }
+
+        // ABI ops live only between emitting and lowering the ABI, neither the
+        // abi step nor the following ones can be run on such a module.
+        VAST_CHECK(!abi_ops, "input module is in the middle of the abi conversion");
+
+        // The abi step starts by lowering to ll, which is complete only once
+        // functions are lowered and value categories are gone. Rerunning the
+        // step on a partially lowered module converts the rest.
+        if (ll_ops) {
+            return hl_funcs || lvalues ? target_dialect::std : target_dialect::abi;
+        }
+
+        // Typedefs are resolved by simplification that precedes standard types.
+        if (hl_typedefs) {
+            return target_dialect::high_level;
+        }
+
+        // Only high level and standard types modules are left, they share ops,
+        // hence types break the tie. A module without evidence of either is
+        // treated as high level as rerunning type lowering is harmless.
+        return !hl_types && std_types ? target_dialect::std : target_dialect::high_level;
+    }
+
     bool vast_pipeline::is_disabled(const pipeline_step_ptr &step) const {
         auto disable_step_option = opt::disable(step->name()).str();
         return vargs.has_option(disable_step_option);
@@ -120,16 +260,34 @@ namespace vast::cc {
     schedule_result vast_pipeline::schedule(pipeline_step_ptr step) {
         if (is_disabled(step)) {
             VAST_PIPELINE_DEBUG("step is disabled: {0}", step->name());
+            last_scheduled.reset();
             return schedule_result::advance;
         }
 
+        llvm::SmallVector< step_graph::node_id > deps;
         for (auto &&dep : step->dependencies()) {
             if (schedule(std::move(dep)) == schedule_result::stop) {
                 return schedule_result::stop;
             }
+
+            if (last_scheduled) {
+                deps.push_back(*last_scheduled);
+            }
         }
 
-        if (step->schedule_on(*this) == schedule_result::stop) {
+        auto node = add_step_node(step->name());
+        for (auto dep : deps) {
+            graph->add_edge(dep, node, step_graph::edge_kind::dependency);
+        }
+
+        auto result = [&] {
+            auto scope = open_step(node);
+            return step->schedule_on(*this);
+        } ();
+
+        last_scheduled = node;
+
+        if (result == schedule_result::stop) {
             return schedule_result::stop;
         }
 
@@ -140,22 +298,56 @@ namespace vast::cc {
         return schedule_result::advance;
     }
 
+    std::unique_ptr< pipeline_t > vast_pipeline::make_empty_pipeline() const {
+        auto branch = std::make_unique< vast_pipeline >(*getContext(), vargs);
+        branch->print_on_error(llvm::errs());
+        branch->enableVerifier(!vargs.has_option(cc::opt::disable_vast_verifier));
+        return branch;
+    }
+
+    static void print_pipeline(vast_pipeline &passes, const vast_args &vargs) {
+        if (auto format = vargs.get_option(opt::print_pipeline)) {
+            VAST_CHECK(format.value() == "dot", "unknown pipeline format: {0}", format.value());
+            return passes.graph->print_dot(llvm::errs());
+        }
+
+        passes.dump();
+        for (auto &branch : passes.branches) {
+            llvm::errs() << "Branch " << branch->name << ":\n";
+            branch->pipeline->dump();
+        }
+    }
+
     std::unique_ptr< vast_pipeline > setup_pipeline(
         pipeline_source src,
         target_dialect trg,
         mcontext_t &mctx,
         const vast_args &vargs,
-        string_ref snapshot_prefix
+        string_ref snapshot_prefix,
+        mlir_module input
     ) {
+        std::optional< target_dialect > reached;
+        if (pipeline_source::mlir == src) {
+            VAST_CHECK(input, "missing input module for MLIR pipeline source");
+            reached = reached_dialect(input);
+            VAST_CHECK(
+                pipeline::position(*reached) <= pipeline::position(trg),
+                "input module is already past the target dialect {0}", to_string(trg)
+            );
+        }
+
         auto passes = std::make_unique< vast_pipeline >(mctx, vargs);
         passes->print_on_error(llvm::errs());
 
         if (auto at = vargs.get_options_list(opt::snapshot_at)) {
+            auto config = get_snapshot_config(vargs);
             passes->addInstrumentation([&] () -> std::unique_ptr< util::with_snapshots > {
                 if (std::ranges::count(at.value(), "*")) {
-                    return std::make_unique< util::snapshot_all >(snapshot_prefix);
+                    return std::make_unique< util::snapshot_all >(snapshot_prefix, config);
                 } else {
-                    return std::make_unique< util::snapshot_after_passes >(at.value(), snapshot_prefix);
+                    return std::make_unique< util::snapshot_after_passes >(
+                        at.value(), snapshot_prefix, config
+                    );
                 }
             } ());
         }
@@ -167,18 +359,25 @@ namespace vast::cc {
             }
         }
 
+        // Independent pipelines run on a clone of the high level module.
+        if (auto branches = vargs.get_options_list(opt::branch)) {
+            for (auto pipeline : branches.value()) {
+                passes->schedule(pipeline::detached(pipeline));
+            }
+        }
+
         // Apply desired conversion to target dialect, if target is llvm or
         // binary/assembly. We perform entire conversion to llvm dialect. Vargs
         // can specify how we want to convert to llvm dialect and allows to turn
         // off optional pipelines.
-        for (auto &&step : pipeline::conversion(src, trg, vargs)) {
+        for (auto &&step : pipeline::conversion(src, trg, vargs, reached)) {
             if (passes->schedule(std::move(step)) == schedule_result::stop) {
                 break;
             }
         }
 
         if (vargs.has_option(opt::print_pipeline)) {
-            passes->dump();
+            print_pipeline(*passes, vargs);
         }
 
         if (vargs.has_option(opt::disable_multithreading) || vargs.has_option(opt::emit_crash_reproducer)) {
@@ -0,0 +1,202 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Frontend/Streaming.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/IR/GlobalVariable.h>
+#include <mlir/IR/AttrTypeSubElements.h>
+#include <llvm/Linker/Linker.h>
+#include <mlir/IR/SymbolTable.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/CodeGen/CodeGenDriver.hpp"
+
+#include "vast/Dialect/Core/Interfaces/SymbolInterface.hpp"
+
+#include "vast/Util/Symbols.hpp"
+
+namespace vast::cc {
+
+    namespace {
+
+        void make_declaration(operation op) {
+            auto linkage = core::GlobalLinkageKindAttr::get(
+                op->getContext(), core::GlobalLinkageKind::ExternalLinkage
+            );
+            op->setAttr("linkage", linkage);
+        }
+
+        void make_private_declaration(hl::FuncOp fn) {
+            make_declaration(fn);
+            mlir::SymbolTable::setSymbolVisibility(fn, mlir::SymbolTable::Visibility::Private);
+        }
+
+    } // namespace
+
+    owning_mlir_module_ref streamed_module::extract(core::module mod, hl::FuncOp fn) {
+        auto top  = cg::mk_wrapping_module(*mod.getContext());
+        auto part = mlir::cast< core::module >(mod->cloneWithoutRegions());
+        part.getBodyRegion().emplaceBlock();
+        top->getBody()->push_back(part);
+
+        auto used = referenced_declarations(mod, fn);
+
+        auto bld = mlir::OpBuilder::atBlockEnd(&part.getBodyRegion().front());
+        for (auto &op : mod.getBodyRegion().front()) {
+            if (!used.contains(&op)) {
+                continue;
+            }
+
+            if (auto other = mlir::dyn_cast< hl::FuncOp >(&op)) {
+                auto decl = mlir::cast< hl::FuncOp >(op.cloneWithoutRegions());
+                bld.insert(decl);
+                symbols.insert(mlir::SymbolTable::getSymbolName(decl).getValue());
+                if (other == fn) {
+                    decl.getBody().takeBody(fn.getBody());
+                    make_private_declaration(fn);
+                } else {
+                    make_private_declaration(decl);
+                }
+            } else if (auto var = mlir::dyn_cast< core::VarSymbolOpInterface >(&op)) {
+                // Globals are defined by the remaining module, their
+                // initializers are left out.
+                auto decl = op.cloneWithoutRegions();
+                bld.insert(decl);
+                make_declaration(decl);
+                symbols.insert(var.getSymbolName());
+                globals.insert(var.getSymbolName());
+            } else {
+                bld.clone(op);
+            }
+        }
+
+        return top;
+    }
+
+    llvm::DenseSet< operation > streamed_module::referenced_declarations(
+        core::module mod, hl::FuncOp fn
+    ) {
+        // Module-level declarations by the names they can be referenced by.
+        llvm::StringMap< llvm::SmallVector< operation, 1 > > declarations;
+        for (auto &op : mod.getBodyRegion().front()) {
+            if (mlir::isa< hl::FuncOp, core::VarSymbolOpInterface >(&op)) {
+                declarations[util::symbol_name(&op)].push_back(&op);
+            } else if (mlir::isa< core::TypeSymbolOpInterface >(&op)) {
+                declarations[util::symbol_name(&op)].push_back(&op);
+                // Enum constants are referenced by their own names.
+                op.walk([&] (core::EnumConstantSymbolOpInterface constant) {
+                    declarations[constant.getSymbolName()].push_back(&op);
+                });
+            }
+        }
+
+        llvm::DenseSet< operation > used;
+        std::vector< operation > worklist;
+        auto use = [&] (string_ref name) {
+            if (auto it = declarations.find(name); it != declarations.end()) {
+                for (auto op : it->second) {
+                    if (used.insert(op).second) {
+                        worklist.push_back(op);
+                    }
+                }
+            }
+        };
+
+        mlir::AttrTypeWalker walker;
+        walker.addWalk([&] (mlir::FlatSymbolRefAttr ref) { use(ref.getValue()); });
+        walker.addWalk([&] (mlir_type type) {
+            if (auto td = mlir::dyn_cast< hl::TypedefType >(type)) {
+                use(td.getName());
+            } else if (auto rt = mlir::dyn_cast< hl::RecordType >(type)) {
+                use(rt.getName());
+            } else if (auto et = mlir::dyn_cast< hl::EnumType >(type)) {
+                use(et.getName());
+            }
+        });
+
+        auto collect = [&] (operation op) {
+            walker.walk(op->getAttrDictionary());
+            for (auto type : op->getResultTypes()) {
+                walker.walk(type);
+            }
+            for (auto type : op->getOperandTypes()) {
+                walker.walk(type);
+            }
+            for (auto &region : op->getRegions()) {
+                for (auto &block : region) {
+                    for (auto type : block.getArgumentTypes()) {
+                        walker.walk(type);
+                    }
+                }
+            }
+        };
+
+        used.insert(fn);
+        worklist.push_back(fn);
+        while (!worklist.empty()) {
+            auto op = worklist.back();
+            worklist.pop_back();
+
+            // Only the extracted function and types are cloned with their
+            // regions, other declarations lose their bodies and initializers.
+            if (op == fn || mlir::isa< core::TypeSymbolOpInterface >(op)) {
+                op->walk(collect);
+            } else {
+                collect(op);
+            }
+        }
+
+        return used;
+    }
+
+    void streamed_module::link_function(std::unique_ptr< llvm::Module > part) {
+        link(std::move(part), /* defines_globals */ false);
+    }
+
+    void streamed_module::link_rest(std::unique_ptr< llvm::Module > rest) {
+        link(std::move(rest), /* defines_globals */ true);
+    }
+
+    void streamed_module::link(std::unique_ptr< llvm::Module > part, bool defines_globals) {
+        for (auto &value : part->global_values()) {
+            auto name = value.getName();
+            if (!symbols.contains(name)) {
+                continue;
+            }
+
+            auto var = llvm::dyn_cast< llvm::GlobalVariable >(&value);
+            if (var && !defines_globals && globals.contains(name) && var->hasInitializer()) {
+                var->setInitializer(nullptr);
+                var->setComdat(nullptr);
+                var->setLinkage(llvm::GlobalValue::ExternalLinkage);
+                continue;
+            }
+
+            if (value.hasLocalLinkage() && !value.isDeclaration()) {
+                local_linkage.try_emplace(name, value.getLinkage());
+                value.setLinkage(llvm::GlobalValue::ExternalLinkage);
+            }
+        }
+
+        if (!linked) {
+            linked = std::move(part);
+            return;
+        }
+
+        VAST_CHECK(
+            !llvm::Linker::linkModules(*linked, std::move(part)),
+            "failed to link streamed function"
+        );
+    }
+
+    std::unique_ptr< llvm::Module > streamed_module::finish() {
+        VAST_CHECK(linked, "no streamed module to finish");
+        for (const auto &entry : local_linkage) {
+            if (auto value = linked->getNamedValue(entry.getKey())) {
+                value->setLinkage(entry.getValue());
+            }
+        }
+        return std::move(linked);
+    }
+
+} // namespace vast::cc
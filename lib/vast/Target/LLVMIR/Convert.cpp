@@ -22,6 +22,8 @@ VAST_RELAX_WARNINGS
 #include <llvm/ADT/TypeSwitch.h>
 VAST_UNRELAX_WARNINGS
 
+#include "vast/Dialect/Core/CoreAttributes.hpp"
+#include "vast/Dialect/Core/CoreDialect.hpp"
 #include "vast/Dialect/Core/CoreOps.hpp"
 
 #include "vast/Dialect/HighLevel/HighLevelDialect.hpp"
@@ -57,7 +59,14 @@ namespace vast::target::llvmir
         // some parsing functionality inside the `mlir::translateModuleToLLVMIR`
         // will fail and no conversion translation happens, even in case these
         // entries are not used at all.
+        // Lowering keeps the layout under the name codegen gave it, it is
+        // moved to the `DLTI` attribute. The table of VAST types holds no
+        // LLVM types and is dropped.
         auto dl = mod.getDataLayoutSpec();
+        mod->removeAttr(core::CoreDialect::getDataLayoutAttrName());
+        if (!dl || mlir::isa< core::DataLayoutSpecAttr >(dl)) {
+            return;
+        }
 
         auto is_llvm_compatible_entry = [] (auto entry) {
             return mlir::LLVM::isCompatibleType(entry.getKey().template get< mlir_type >());
@@ -127,11 +127,73 @@ namespace vast::tw {
 
     /* conversion_step::link_interface API */
 
-    operations conversion_step::children(operation) { VAST_UNIMPLEMENTED; }
-    operations conversion_step::children(operations) { VAST_UNIMPLEMENTED; }
+    conversion_step::~conversion_step() {
+        if (!_resolver) {
+            return;
+        }
+
+        if (_by_prev.mod) {
+            _resolver->unpin(_child);
+        }
+
+        if (_by_self.mod) {
+            _resolver->unpin(_parent);
+        }
+    }
+
+    auto conversion_step::index(lazy_index &idx, handle_t handle, auto &&key) -> const lazy_index & {
+        if (idx.mod) {
+            return idx;
+        }
+
+        if (_resolver) {
+            handle = _resolver->resolve(handle.id);
+            _resolver->pin(handle);
+        }
+
+        idx.mod = handle.mod;
+        handle.mod->walk([&](operation op) { idx.ops[key(op)].push_back(op); });
+        return idx;
+    }
+
+    namespace {
+
+        operations lookup(const llvm::DenseMap< loc_t, operations > &ops, loc_t loc) {
+            if (auto it = ops.find(loc); it != ops.end()) {
+                return it->second;
+            }
+            return {};
+        }
+
+    } // namespace
+
+    operations conversion_step::children(operation op) {
+        const auto &idx = index(_by_prev, _child, [&](operation child_op) {
+            return _location_info.prev(child_op);
+        });
+        return lookup(idx.ops, _location_info.self(op));
+    }
+
+    operations conversion_step::children(operations ops) {
+        operations out;
+        for (auto op : ops)
+            append_range(out, children(op));
+        return out;
+    }
 
-    operations conversion_step::parents(operation) { VAST_UNIMPLEMENTED;  }
-    operations conversion_step::parents(operations) { VAST_UNIMPLEMENTED; }
+    operations conversion_step::parents(operation op) {
+        const auto &idx = index(_by_self, _parent, [&](operation parent_op) {
+            return _location_info.self(parent_op);
+        });
+        return lookup(idx.ops, _location_info.prev(op));
+    }
+
+    operations conversion_step::parents(operations ops) {
+        operations out;
+        for (auto op : ops)
+            append_range(out, parents(op));
+        return out;
+    }
 
     op_mapping conversion_step::parents_to_children() {
         return reverse_mapping(children_to_parents());
@@ -141,21 +203,30 @@ namespace vast::tw {
         return build_map(parent(), child(), _location_info);
     }
 
-    handle_t conversion_step::parent() const { return _parent; }
-    handle_t conversion_step::child() const { return _child; }
+    handle_t conversion_step::parent() const {
+        return _resolver ? _resolver->resolve(_parent.id) : _parent;
+    }
+
+    handle_t conversion_step::child() const {
+        return _resolver ? _resolver->resolve(_child.id) : _child;
+    }
 
     /* fat_link */
 
-    fat_link::fat_link(link_vector links)
-        : _links(std::move(links)),
-          _to_children(build_map(_links)),
-          _to_parents(reverse_mapping(_to_children))
-      {}
+    fat_link::fat_link(link_vector links) : _links(std::move(links)) {}
 
     /* fat_link::link_interface API */
 
     operations fat_link::children(operation op) {
-        return _to_children[op];
+        if (auto it = _children.find(op); it != _children.end()) {
+            return it->second;
+        }
+
+        operations ops = { op };
+        for (auto &link : _links) {
+            ops = link->children(std::move(ops));
+        }
+        return _children[op] = std::move(ops);
     }
 
     operations fat_link::children(operations ops) {
@@ -166,7 +237,15 @@ namespace vast::tw {
     }
 
     operations fat_link::parents(operation op) {
-        return _to_parents[op];
+        if (auto it = _parents.find(op); it != _parents.end()) {
+            return it->second;
+        }
+
+        operations ops = { op };
+        for (auto &link : llvm::reverse(_links)) {
+            ops = link->parents(std::move(ops));
+        }
+        return _parents[op] = std::move(ops);
     }
 
     operations fat_link::parents(operations ops) {
@@ -176,8 +255,19 @@ namespace vast::tw {
         return out;
     }
 
-    op_mapping fat_link::parents_to_children() { return _to_children; }
-    op_mapping fat_link::children_to_parents() { return _to_parents; }
+    op_mapping fat_link::parents_to_children() {
+        if (!_to_children) {
+            _to_children = build_map(_links);
+        }
+        return *_to_children;
+    }
+
+    op_mapping fat_link::children_to_parents() {
+        if (!_to_parents) {
+            _to_parents = reverse_mapping(parents_to_children());
+        }
+        return *_to_parents;
+    }
 
     handle_t fat_link::parent() const { return _links.front()->parent(); }
     handle_t fat_link::child() const { return _links.back()->child(); }
@@ -2,47 +2,33 @@
 
 #include "vast/Tower/LocationInfo.hpp"
 
-#include <algorithm>
-#include <numeric>
-
 namespace vast::tw {
 
-    std::string location_info_t::fingerprint(const conversion_path_t &path) {
-        return std::accumulate(path.begin(), path.end(), std::string{});
+    loc_t location_info_t::mk_linked_loc(provenance_t self, loc_t prev) {
+        return mlir::OpaqueLoc::get(encode(self), tag(), prev);
     }
 
-    loc_t location_info_t::mk_unique_loc(const conversion_path_t &path, operation op) {
-        auto mctx = op->getContext();
-        auto raw_id =
-            fingerprint(path) + std::to_string(reinterpret_cast< std::uintptr_t >(op));
-        return mlir::FileLineColLoc::get(mctx, raw_id, 0, 0);
+    bool location_info_t::are_tied(operation parent, operation child) {
+        return self(parent) == prev(child);
     }
 
-    loc_t location_info_t::mk_linked_loc(loc_t self, loc_t prev) {
-        auto mctx = self->getContext();
-        return mlir::FusedLoc::get({ self, prev }, {}, mctx);
-    }
+    namespace {
 
-    loc_t location_info_t::get_as_child(const conversion_path_t &path, operation op) {
-        return mk_linked_loc(self(op), mk_unique_loc(path, op));
-    }
+        void link_locations(location_info_t &li, operation root) {
+            auto step = li.mk_step();
+            std::uint32_t id = 0;
+            auto set_loc = [&](operation op) {
+                op->setLoc(li.mk_linked_loc({ step, id++ }, op->getLoc()));
+            };
+            root->walk(set_loc);
+        }
 
-    loc_t location_info_t::get_root(operation op) {
-        return mk_linked_loc(op->getLoc(), mk_unique_loc({}, op));
-    }
+    } // namespace
 
-    bool location_info_t::are_tied(operation parent, operation child) {
-        return self(parent) == prev(child);
-    }
-
-    void mk_root(location_info_t &li, operation root) {
-        auto set_loc = [&](operation op) { op->setLoc(li.get_root(op)); };
-        root->walk(set_loc);
-    }
+    void mk_root(location_info_t &li, operation root) { link_locations(li, root); }
 
-    void transform_locations(location_info_t &li, const conversion_path_t &path, operation root) {
-        auto set_loc = [&](operation op) { op->setLoc(li.get_as_child(path, op)); };
-        root->walk(set_loc);
+    void transform_locations(location_info_t &li, operation root) {
+        link_locations(li, root);
     }
 
 } // namespace vast::tw
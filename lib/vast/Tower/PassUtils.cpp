@@ -2,8 +2,30 @@
 
 #include "vast/Tower/PassUtils.hpp"
 
+VAST_RELAX_WARNINGS
+#include <llvm/Support/raw_sha1_ostream.h>
+VAST_UNRELAX_WARNINGS
+
 namespace vast::tw {
 
+    namespace {
+
+        // Cloning utilities of `mlir::Pass` are `protected`, their addresses taken
+        // through a derived class can be applied to any pass.
+        struct pass_access : mlir::Pass
+        {
+            static owning_pass_ptr clone(const mlir::Pass &pass) {
+                auto clone_pass   = &pass_access::clonePass;
+                auto copy_options = &pass_access::copyOptionValuesFrom;
+
+                auto copy = (pass.*clone_pass)();
+                ((*copy).*copy_options)(&pass);
+                return copy;
+            }
+        };
+
+    } // namespace
+
     std::string to_string(pass_ptr pass) {
         std::string buffer;
         llvm::raw_string_ostream os(buffer);
@@ -21,13 +43,28 @@ namespace vast::tw {
         return out;
     }
 
+    pass_fingerprint_t fingerprint(pass_ptr pass) {
+        llvm::raw_sha1_ostream os;
+        pass->printAsTextualPipeline(os);
+        return { pass->getTypeID(), os.sha1() };
+    }
+
+    pass_fingerprints_t fingerprint(const conversion_passes_t &passes) {
+        pass_fingerprints_t out;
+        out.reserve(passes.size());
+        for (auto p : passes)
+            out.push_back(fingerprint(p));
+        return out;
+    }
+
     void copy_passes(mlir::PassManager &pm, const conversion_passes_t &passes) {
-        // Sadly I didn't find any better public API to clone passes between `mlir::PassManager`
-        // instances. Pass does have a `clonePass` method but it is `protected` and same holds
-        // for other utilities as well.
-        auto str_pipeline = to_string(passes);
-        auto status = mlir::parsePassPipeline(str_pipeline, pm);
-        VAST_CHECK(mlir::succeeded(status), "Failed to parse pipeline string: {0}", str_pipeline);
+        for (auto p : passes)
+            pm.addPass(pass_access::clone(*p));
+    }
+
+    void copy_passes(mlir::PassManager &pm, mlir::OpPassManager::pass_range passes) {
+        for (auto &p : passes)
+            pm.addPass(pass_access::clone(p));
     }
 
 } // namespace vast::tw
@@ -0,0 +1,228 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Tower/Storage.hpp"
+
+VAST_RELAX_WARNINGS
+#include <mlir/IR/OperationSupport.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/Core/CoreOps.hpp"
+
+namespace vast::tw {
+
+    namespace {
+
+        using unit_t      = module_snapshot::unit_t;
+        using locations_t = module_snapshot::locations_t;
+
+        bool is_module(operation op) { return mlir::isa< mlir::ModuleOp, core::ModuleOp >(op); }
+
+        mlir::Block &body(operation mod) { return mod->getRegion(0).front(); }
+
+        operation clone_module_without_body(operation mod) {
+            auto copy = mod->cloneWithoutRegions();
+            for (auto &region : copy->getRegions()) {
+                region.emplaceBlock();
+            }
+            return copy;
+        }
+
+        locations_t collect_locations(operation op) {
+            locations_t locs;
+            op->walk< mlir::WalkOrder::PreOrder >([&](operation nested) {
+                locs.push_back(nested->getLoc());
+            });
+            return locs;
+        }
+
+        void restore_locations(operation op, const locations_t &locs) {
+            std::size_t idx = 0;
+            op->walk< mlir::WalkOrder::PreOrder >([&](operation nested) {
+                VAST_ASSERT(idx < locs.size());
+                nested->setLoc(locs[idx++]);
+            });
+            VAST_ASSERT(idx == locs.size());
+        }
+
+        // Unit of a stored module as seen by the comparison with the next module.
+        struct unit_view
+        {
+            operation base;
+            // locations if they differ from the ones of `base`
+            const locations_t *locations;
+
+            loc_t loc() const { return locations ? locations->front() : base->getLoc(); }
+
+            bool same_locations(const locations_t &locs) const {
+                return locations ? *locations == locs : collect_locations(base) == locs;
+            }
+        };
+
+        using unit_index_t = llvm::DenseMap< loc_t, unit_view >;
+
+        void index_units(mlir::Block &block, unit_index_t &index) {
+            for (auto &op : block) {
+                if (is_module(&op)) {
+                    index_units(body(&op), index);
+                } else {
+                    index.try_emplace(op.getLoc(), unit_view{ &op, nullptr });
+                }
+            }
+        }
+
+        void index_units(const std::vector< unit_t > &units, unit_index_t &index) {
+            for (const auto &unit : units) {
+                if (unit.is_module) {
+                    index_units(unit.nested, index);
+                } else {
+                    auto view = unit_view{ unit.op, unit.locations.get() };
+                    index.try_emplace(view.loc(), view);
+                }
+            }
+        }
+
+        std::vector< unit_t > snapshot_units(
+            mlir::Block &from, mlir::Block &into, const unchanged_units_t &unchanged
+        ) {
+            std::vector< unit_t > units;
+            for (auto &op : from) {
+                if (is_module(&op)) {
+                    auto copy = clone_module_without_body(&op);
+                    into.push_back(copy);
+                    units.push_back({
+                        copy, nullptr, snapshot_units(body(&op), body(copy), unchanged), true
+                    });
+                } else if (auto it = unchanged.find(&op); it != unchanged.end()) {
+                    auto locs = std::make_shared< const locations_t >(collect_locations(&op));
+                    units.push_back({ it->second, std::move(locs) });
+                } else {
+                    auto copy = op.clone();
+                    into.push_back(copy);
+                    units.push_back({ copy, nullptr });
+                }
+            }
+            return units;
+        }
+
+        void materialize_units(const std::vector< unit_t > &units, mlir::Block &into) {
+            for (const auto &unit : units) {
+                if (unit.is_module) {
+                    auto copy = clone_module_without_body(unit.op);
+                    into.push_back(copy);
+                    materialize_units(unit.nested, body(copy));
+                } else {
+                    auto copy = unit.op->clone();
+                    if (unit.locations) {
+                        restore_locations(copy, *unit.locations);
+                    }
+                    into.push_back(copy);
+                }
+            }
+        }
+
+        owning_mlir_module_ref materialize(const module_snapshot &snapshot) {
+            auto mod = clone_module_without_body(snapshot.skeleton.get());
+            materialize_units(snapshot.units, body(mod));
+            return mlir::cast< mlir_module >(mod);
+        }
+
+    } // namespace
+
+    handle_t module_storage::get(module_key_t module_key) const {
+        if (auto it = storage.find(module_key); it != storage.end()) {
+            return { module_key, it->second.get() };
+        }
+
+        if (auto it = materialized.find(module_key); it != materialized.end()) {
+            return { module_key, it->second.get() };
+        }
+
+        auto it = snapshots.find(module_key);
+        VAST_CHECK(it != snapshots.end(), "Required module not found in the storage!");
+        auto [mat, _] = materialized.insert({ module_key, materialize(it->second) });
+        return { module_key, mat->second.get() };
+    }
+
+    unchanged_units_t module_storage::unchanged_units(handle_t from, mlir_module mod) const {
+        if (mode != storage_mode::delta) {
+            return {};
+        }
+
+        unit_index_t index;
+        if (auto it = snapshots.find(from.id); it != snapshots.end()) {
+            index_units(it->second.units, index);
+        } else {
+            index_units(body(get(from.id).mod), index);
+        }
+
+        unchanged_units_t unchanged;
+        auto compare = [&](auto &self, mlir::Block &block) -> void {
+            for (auto &op : block) {
+                if (is_module(&op)) {
+                    self(self, body(&op));
+                    continue;
+                }
+
+                auto it = index.find(op.getLoc());
+                if (it == index.end()) {
+                    continue;
+                }
+
+                const auto &prev = it->second;
+                auto equivalent = mlir::OperationEquivalence::isEquivalentTo(
+                    &op, prev.base, mlir::OperationEquivalence::IgnoreLocations
+                );
+
+                if (equivalent && prev.same_locations(collect_locations(&op))) {
+                    unchanged[&op] = prev.base;
+                }
+            }
+        };
+
+        compare(compare, body(mod));
+        return unchanged;
+    }
+
+    handle_t module_storage::store(
+        handle_t parent, const pass_fingerprint_t &pass, mlir_module mod,
+        const unchanged_units_t &unchanged
+    ) {
+        if (mode == storage_mode::full_clone) {
+            return store(parent, pass, mlir::cast< mlir_module >(mod->clone()));
+        }
+
+        module_snapshot snapshot;
+        auto skeleton = clone_module_without_body(mod);
+        snapshot.skeleton = mlir::cast< mlir_module >(skeleton);
+        snapshot.units    = snapshot_units(body(mod), body(skeleton), unchanged);
+
+        auto handle = store_snapshot(std::move(snapshot));
+        trie.store(parent, pass, handle.id);
+        return handle;
+    }
+
+    void module_storage::unpin(handle_t handle) {
+        auto it = pinned.find(handle.id);
+        VAST_CHECK(it != pinned.end(), "Unpinned module was not pinned!");
+        if (--it->second != 0) {
+            return;
+        }
+
+        pinned.erase(it);
+        materialized.erase(handle.id);
+    }
+
+    void module_storage::evict_unpinned() {
+        llvm::SmallVector< handle_id_t > evicted;
+        for (const auto &[id, _] : materialized) {
+            if (!pinned.contains(id)) {
+                evicted.push_back(id);
+            }
+        }
+
+        for (auto id : evicted) {
+            materialized.erase(id);
+        }
+    }
+
+} // namespace vast::tw
@@ -10,34 +10,39 @@ namespace vast::tw {
     {
         location_info_t &li;
         module_storage &storage;
-
-        // Start empty and after each callback add to it.
-        conversion_passes_t path = {};
-        // TODO: Remove.
-        conversion_path_t str_path = {};
+        // fingerprints of the scheduled passes in the order they run
+        const pass_fingerprints_t &passes;
 
         std::vector< handle_t > handles;
         link_vector steps;
 
 
-        explicit link_builder(location_info_t &li, module_storage &storage, handle_t root)
-            : li(li), storage(storage), handles{ root } {}
+        explicit link_builder(
+            location_info_t &li, module_storage &storage, handle_t root,
+            const pass_fingerprints_t &passes
+        )
+            : li(li), storage(storage), passes(passes), handles{ root } {}
 
         void runAfterPass(pass_ptr pass, operation op) override {
             auto mod = mlir::dyn_cast< mlir_module >(op);
             VAST_CHECK(mod, "Pass inside tower was not run on module!");
 
+            VAST_CHECK(steps.size() < passes.size(), "Unexpected pass inside tower!");
+            const auto &pass_fingerprint = passes[steps.size()];
+
+            auto from = handles.back();
+            // Compare with the previous module while locations still match.
+            auto unchanged = storage.unchanged_units(from, mod);
+
             // Update locations so each operation now has a unique loc that also
             // encodes backlink.
-            path.emplace_back(pass);
-            str_path.emplace_back(pass->getArgument().str());
-            transform_locations(li, str_path, mod);
-
-            owning_mlir_module_ref persistent = mlir::dyn_cast< mlir_module >(op->clone());
+            transform_locations(li, mod);
 
-            auto from = handles.back();
-            handles.emplace_back(storage.store(path, std::move(persistent)));
-            steps.emplace_back(std::make_unique< conversion_step >(from, handles.back(), li));
+            // Each new module hangs on the edge from the previous one.
+            handles.emplace_back(storage.store(from, pass_fingerprint, mod, unchanged));
+            steps.emplace_back(
+                std::make_unique< conversion_step >(from, handles.back(), li, &storage)
+            );
         }
 
         auto take_links() { return std::move(steps); }
@@ -45,18 +50,49 @@ namespace vast::tw {
 
     namespace {
 
-        link_vector construct_steps(const std::vector< handle_t > &handles, location_info_t &li) {
+        link_vector construct_steps(
+            const std::vector< handle_t > &handles, location_info_t &li, module_resolver &resolver
+        ) {
             VAST_ASSERT(handles.size() >= 2);
             link_vector out;
             for (std::size_t i = 1; i < handles.size(); ++i)
-                out.emplace_back(std::make_unique< conversion_step >(handles[i - 1], handles[i], li));
+                out.emplace_back(std::make_unique< conversion_step >(
+                    handles[i - 1], handles[i], li, &resolver
+                ));
             return out;
         }
 
+        // Keeps modules of the endpoints pinned in the storage for as long as
+        // the link lives.
+        struct pinned_link : fat_link
+        {
+            pinned_link(link_vector links, module_storage &storage)
+                : fat_link(std::move(links))
+                , storage(storage)
+                , pinned_parent(fat_link::parent())
+                , pinned_child(fat_link::child())
+            {
+                storage.pin(pinned_parent);
+                storage.pin(pinned_child);
+            }
+
+            ~pinned_link() override {
+                storage.unpin(pinned_child);
+                storage.unpin(pinned_parent);
+            }
+
+            module_storage &storage;
+            handle_t pinned_parent;
+            handle_t pinned_child;
+        };
+
     } // namespace
 
-    link_vector tower::mk_full_path(handle_t root, location_info_t &li, mlir::PassManager &pm) {
-        auto bld = std::make_unique< link_builder >(li, storage, top());
+    link_vector tower::mk_full_path(
+        handle_t root, location_info_t &li, mlir::PassManager &pm,
+        const pass_fingerprints_t &passes
+    ) {
+        auto bld = std::make_unique< link_builder >(li, storage, root, passes);
 
         // We need to access some of the data after passes are ran.
         auto raw_bld = bld.get();
@@ -64,7 +100,7 @@ namespace vast::tw {
 
         // We need to do a clone, because we received a handle - this means that the module
         // is already stored and should not be modified.
-        auto clone = root.mod->clone();
+        auto clone = storage.resolve(root.id).mod->clone();
 
         // TODO: What if this fails?
         std::ignore = pm.run(clone);
@@ -72,32 +108,46 @@ namespace vast::tw {
     }
 
     link_ptr tower::apply(handle_t root, location_info_t &li, mlir::PassManager &requested_pm) {
-        std::vector< mlir::Pass * > requested_passes;
+        auto link = std::make_unique< pinned_link >(mk_steps(root, li, requested_pm), storage);
+
+        // Only endpoints of live links are kept alive, modules in between
+        // are reconstructed again if a single step is queried.
+        storage.evict_unpinned();
+
+        return link;
+    }
+
+    link_vector tower::mk_steps(handle_t root, location_info_t &li, mlir::PassManager &requested_pm) {
+        // Passes are fingerprinted once, the trie is then queried only by the
+        // fingerprints.
+        pass_fingerprints_t requested_passes;
         for (auto &p : requested_pm.getPasses())
-            requested_passes.push_back(&p);
+            requested_passes.push_back(fingerprint(&p));
         auto [handles, suffix] = storage.get_maximum_prefix_path(requested_passes, root);
 
         // This path is completely new.
         if (handles.empty())
-            return std::make_unique< fat_link >(mk_full_path(root, li, requested_pm));
+            return mk_full_path(root, li, requested_pm, requested_passes);
 
-        auto as_steps = construct_steps(handles, li);
+        auto as_steps = construct_steps(handles, li, storage);
 
         // This path is already present - construct a link.
         if (suffix.empty())
-            return std::make_unique< fat_link >(std::move(as_steps));
+            return as_steps;
 
-        auto pm = mlir::PassManager(requested_pm.getContext());
-        copy_passes(pm, suffix);
+        // Clone the passes that remain to be applied.
+        auto pm = mlir::PassManager(requested_pm.getContext(), requested_pm.getOpAnchorName());
+        auto matched = requested_passes.size() - suffix.size();
+        copy_passes(pm, llvm::drop_begin(requested_pm.getPasses(), matched));
 
-        auto new_steps = mk_full_path(handles.back(), li, pm);
+        auto new_steps = mk_full_path(handles.back(), li, pm, suffix);
         // TODO: Update with newer stdlib
         as_steps.insert(
             as_steps.end(),
             std::make_move_iterator(new_steps.begin()),
             std::make_move_iterator(new_steps.end()));
 
-        return std::make_unique< fat_link >(std::move(as_steps));
+        return as_steps;
     }
 
 } // namespace vast::tw
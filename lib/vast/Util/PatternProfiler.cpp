@@ -0,0 +1,193 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+#include "vast/Util/PatternProfiler.hpp"
+#include "vast/Util/WrappedPattern.hpp"
+
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/Support/FormatVariadic.h>
+VAST_UNRELAX_WARNINGS
+
+namespace vast::util {
+
+    namespace {
+
+        struct profiled_pattern : wrapped_pattern
+        {
+            using clock = pattern_profile::clock;
+
+            template< typename... root_args_t >
+            profiled_pattern(
+                std::unique_ptr< mlir::RewritePattern > pattern,
+                pattern_counters &counters,
+                root_args_t &&...root_args
+            )
+                : wrapped_pattern(std::move(pattern), std::forward< root_args_t >(root_args)...)
+                , counters(counters)
+            {}
+
+            logical_result matchAndRewrite(
+                operation op, mlir::PatternRewriter &rewriter
+            ) const override {
+                auto start  = clock::now();
+                auto result = pattern->matchAndRewrite(op, rewriter);
+                auto end    = clock::now();
+
+                counters.attempts++;
+                if (mlir::succeeded(result)) {
+                    counters.successes++;
+                }
+                counters.nanoseconds += std::chrono::duration_cast<
+                    std::chrono::nanoseconds
+                >(end - start).count();
+                return result;
+            }
+
+            pattern_counters &counters;
+        };
+
+        std::atomic< bool > profiling_enabled = false;
+
+        std::mutex profiles_mutex;
+
+        using context_profiles = llvm::StringMap< pattern_profile >;
+
+        // Profiles are never removed, only reset, so references to them and
+        // to their counters held by wrapped patterns stay valid. Entries of a
+        // string map are allocated separately, hence they survive rehashing of
+        // the outer map.
+        llvm::DenseMap< mlir::MLIRContext *, context_profiles > &profiles() {
+            static llvm::DenseMap< mlir::MLIRContext *, context_profiles > instance;
+            return instance;
+        }
+
+        void print_profiles(const context_profiles &of, llvm::raw_ostream &os) {
+            std::vector< const llvm::StringMapEntry< pattern_profile > * > sorted;
+            for (const auto &entry : of) {
+                if (!entry.second.empty()) {
+                    sorted.push_back(&entry);
+                }
+            }
+
+            std::ranges::sort(sorted, {}, [](const auto *entry) { return entry->first(); });
+            for (const auto *entry : sorted) {
+                entry->second.print(entry->first(), os);
+            }
+        }
+
+        double milliseconds(std::int64_t nanoseconds) { return double(nanoseconds) / 1e6; }
+
+    } // namespace
+
+    pattern_counters &pattern_profile::counters(string_ref pattern) {
+        std::lock_guard lock(mutex);
+        return patterns.try_emplace(pattern).first->second;
+    }
+
+    void pattern_profile::print(string_ref pass, llvm::raw_ostream &os) const {
+        struct row
+        {
+            string_ref name;
+            std::uint64_t attempts;
+            std::uint64_t successes;
+            std::int64_t nanoseconds;
+        };
+
+        std::vector< row > rows;
+        std::int64_t in_patterns = 0;
+        {
+            std::lock_guard lock(mutex);
+            for (const auto &entry : patterns) {
+                const auto &c = entry.second;
+                rows.push_back({ entry.first(), c.attempts, c.successes, c.nanoseconds });
+                in_patterns += c.nanoseconds;
+            }
+        }
+
+        std::ranges::sort(rows, std::greater{}, &row::nanoseconds);
+
+        // Legality callbacks are invoked by the driver and cannot be wrapped,
+        // they account for most of the conversion time outside of patterns.
+        auto total = conversion_nanoseconds.load();
+        auto outside = std::max< std::int64_t >(total - in_patterns, 0);
+        os << "===" << std::string(73, '-') << "===\n";
+        os << "  Pattern profile: " << pass << "\n";
+        os << llvm::formatv(
+            "  conversion: {0:F3} ms in {1} run(s), outside of patterns (legality, driver): {2:F3} ms\n",
+            milliseconds(total), conversions.load(), milliseconds(outside)
+        );
+        os << "===" << std::string(73, '-') << "===\n";
+
+        os << llvm::formatv(
+            "  {0,12} {1,10} {2,10} {3,10}  {4}\n",
+            "time (ms)", "attempts", "successes", "failures", "pattern"
+        );
+        for (const auto &r : rows) {
+            os << llvm::formatv(
+                "  {0,12:F3} {1,10} {2,10} {3,10}  {4}\n",
+                milliseconds(r.nanoseconds), r.attempts, r.successes,
+                r.attempts - r.successes, r.name
+            );
+        }
+        os << "\n";
+    }
+
+    void pattern_profile::reset() {
+        std::lock_guard lock(mutex);
+        for (auto &entry : patterns) {
+            auto &c = entry.second;
+            c.attempts    = 0;
+            c.successes   = 0;
+            c.nanoseconds = 0;
+        }
+        conversions = 0;
+        conversion_nanoseconds = 0;
+    }
+
+    void enable_pattern_profiling(bool enable) { profiling_enabled = enable; }
+
+    bool pattern_profiling_enabled() { return profiling_enabled; }
+
+    pattern_profile &pattern_profile_of(mlir::MLIRContext *mctx, string_ref pass) {
+        std::lock_guard lock(profiles_mutex);
+        return profiles()[mctx].try_emplace(pass).first->second;
+    }
+
+    pattern_profile *active_pattern_profile(mlir::MLIRContext *mctx, string_ref pass) {
+        if (!pattern_profiling_enabled()) {
+            return nullptr;
+        }
+        return &pattern_profile_of(mctx, pass);
+    }
+
+    void profile_patterns(mlir::RewritePatternSet &patterns, pattern_profile &profile) {
+        for (auto &pattern : patterns.getNativePatterns()) {
+            auto &counters = profile.counters(pattern->getDebugName());
+            pattern = wrapped_pattern::wrap< profiled_pattern >(std::move(pattern), counters);
+        }
+    }
+
+    void print_pattern_profiles(mlir::MLIRContext *mctx, llvm::raw_ostream &os) {
+        std::lock_guard lock(profiles_mutex);
+        if (auto it = profiles().find(mctx); it != profiles().end()) {
+            print_profiles(it->second, os);
+        }
+    }
+
+    void print_pattern_profiles(llvm::raw_ostream &os) {
+        std::lock_guard lock(profiles_mutex);
+        for (const auto &[_, of] : profiles()) {
+            print_profiles(of, os);
+        }
+    }
+
+    void reset_pattern_profiles(mlir::MLIRContext *mctx) {
+        std::lock_guard lock(profiles_mutex);
+        if (auto it = profiles().find(mctx); it != profiles().end()) {
+            for (auto &entry : it->second) {
+                entry.second.reset();
+            }
+        }
+    }
+
+} // namespace vast::util
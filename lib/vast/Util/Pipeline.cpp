@@ -3,6 +3,13 @@
 
 #include "vast/Util/Pipeline.hpp"
 
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/ScopeExit.h>
+#include <llvm/Support/GraphWriter.h>
+#include <mlir/IR/BuiltinOps.h>
+#include <mlir/Pass/PassInstrumentation.h>
+VAST_UNRELAX_WARNINGS
+
 #include "vast/Dialect/Core/CoreOps.hpp"
 
 namespace vast {
@@ -14,11 +21,181 @@ namespace vast {
         }
 
         seen.insert(id);
+        record_steps(id);
         VAST_PIPELINE_DEBUG("scheduling pass: {0}", pass->getArgument());
 
         base::addPass(std::move(pass));
     }
 
+    void pipeline_t::add_function_granular_pass(
+        owning_pass_ptr function_part, owning_pass_ptr module_part
+    ) {
+        auto id = function_part->getTypeID();
+        if (seen.count(id)) {
+            return;
+        }
+
+        seen.insert(id);
+        record_steps(id);
+        VAST_PIPELINE_DEBUG("scheduling function granular pass: {0}", function_part->getArgument());
+
+        auto &mod = this->nest< core::module >();
+        mod.nestAny().addPass(std::move(function_part));
+        mod.addPass(std::move(module_part));
+    }
+
+    //
+    // step_graph
+    //
+    step_graph::node_id step_graph::add_node(string_ref name, cluster_id cluster) {
+        nodes.push_back({ name.str(), cluster });
+        return nodes.size() - 1;
+    }
+
+    void step_graph::add_edge(node_id from, node_id to, edge_kind kind) {
+        edges.push_back({ from, to, kind });
+    }
+
+    step_graph::cluster_id step_graph::add_cluster(string_ref name) {
+        clusters.push_back(name.str());
+        return clusters.size() - 1;
+    }
+
+    void step_graph::print_dot(llvm::raw_ostream &os) const {
+        os << "digraph pipeline {\n";
+        os << "  node [shape=box];\n";
+
+        for (cluster_id cluster = 0; cluster < clusters.size(); ++cluster) {
+            os << "  subgraph cluster_" << cluster << " {\n";
+            os << "    label=\"" << llvm::DOT::EscapeString(clusters[cluster]) << "\";\n";
+            for (node_id id = 0; id < nodes.size(); ++id) {
+                if (nodes[id].cluster == cluster) {
+                    os << "    n" << id
+                       << " [label=\"" << llvm::DOT::EscapeString(nodes[id].name) << "\"];\n";
+                }
+            }
+            os << "  }\n";
+        }
+
+        for (const auto &[from, to, kind] : edges) {
+            os << "  n" << from << " -> n" << to;
+            switch (kind) {
+                case edge_kind::sequence: break;
+                case edge_kind::dependency: os << " [style=dashed]"; break;
+                case edge_kind::contains: os << " [style=dotted]"; break;
+            }
+            os << ";\n";
+        }
+
+        os << "}\n";
+    }
+
+    //
+    // pipeline_branch
+    //
+    namespace {
+
+        // Starts the branch on the module as it is at this point of the pipeline.
+        struct fork_pass : mlir::PassWrapper< fork_pass, mlir::OperationPass< mlir_module > >
+        {
+            MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(fork_pass)
+
+            explicit fork_pass(pipeline_branch &branch) : branch(branch) {}
+
+            void runOnOperation() override {
+                branch.start(getOperation());
+                markAllAnalysesPreserved();
+            }
+
+            pipeline_branch &branch;
+        };
+
+    } // namespace
+
+    pipeline_branch::pipeline_branch(string_ref name, std::unique_ptr< pipeline_t > pipeline)
+        : name(name), pipeline(std::move(pipeline))
+    {}
+
+    pipeline_branch::~pipeline_branch() {
+        // Running branch refers to the module and pipeline owned by this.
+        // Deferred branch that was not joined is not run at all.
+        using namespace std::chrono_literals;
+        if (result.valid() && result.wait_for(0s) != std::future_status::deferred) {
+            result.wait();
+        }
+    }
+
+    void pipeline_branch::start(mlir_module mod) {
+        VAST_CHECK(!result.valid(), "branch {0} started multiple times", name);
+        module = owning_mlir_module_ref(mod.clone());
+
+        auto run = [this] { return pipeline->run(module.get()); };
+
+        // Without multithreading the context is not safe to be used
+        // concurrently, the branch runs once it is joined.
+        auto policy = mod->getContext()->isMultithreadingEnabled()
+            ? std::launch::async : std::launch::deferred;
+        result = std::async(policy, run);
+    }
+
+    logical_result pipeline_branch::join() {
+        if (!result.valid()) {
+            return mlir::failure();
+        }
+        return result.get();
+    }
+
+    void pipeline_t::fork(std::unique_ptr< pipeline_branch > branch) {
+        // Dialects can not be loaded while the main pipeline is running, load
+        // them now so that the branch finds them already loaded.
+        mlir::DialectRegistry registry;
+        branch->pipeline->getDependentDialects(registry);
+
+        auto mctx = getContext();
+        mctx->appendDialectRegistry(registry);
+        for (auto name : registry.getDialectNames()) {
+            mctx->getOrLoadDialect(name);
+        }
+
+        VAST_PIPELINE_DEBUG("scheduling branch: {0}", branch->name);
+        base::addPass(std::make_unique< fork_pass >(*branch));
+        branches.push_back(std::move(branch));
+    }
+
+    std::unique_ptr< pipeline_t > pipeline_t::make_branch(string_ref name) {
+        auto branch       = make_empty_pipeline();
+        branch->graph     = graph;
+        branch->cluster   = graph->add_cluster(name);
+        branch->open_steps = { open_step_t{ open_steps.back().node, std::nullopt } };
+        return branch;
+    }
+
+    logical_result pipeline_t::join_branches() {
+        auto result = mlir::success();
+        for (auto &branch : branches) {
+            if (mlir::failed(branch->join())) {
+                result = mlir::failure();
+            }
+        }
+        return result;
+    }
+
+    step_graph::node_id pipeline_t::add_step_node(string_ref name) {
+        auto node    = graph->add_node(name, cluster);
+        auto &parent = open_steps.back();
+
+        if (parent.node) {
+            graph->add_edge(*parent.node, node, step_graph::edge_kind::contains);
+        }
+
+        if (parent.last_substep) {
+            graph->add_edge(*parent.last_substep, node, step_graph::edge_kind::sequence);
+        }
+
+        parent.last_substep = node;
+        return node;
+    }
+
     gap::generator< pipeline_step_ptr > pipeline_step::dependencies() const {
         for (const auto &dep : deps) {
             co_yield dep();
@@ -67,9 +244,42 @@ namespace vast {
         return schedule_result::advance;
     }
 
+    namespace {
+        template< typename pass_t >
+        logical_result initialize_options(pass_t &pass, string_ref options) {
+            auto report = [] ([[maybe_unused]] const llvm::Twine &msg) {
+                VAST_REPORT("{0}", msg.str());
+                return mlir::failure();
+            };
+
+            if constexpr (requires { pass.initializeOptions(options, report); }) {
+                return pass.initializeOptions(options, report);
+            } else {
+                return pass.initializeOptions(options);
+            }
+        }
+    } // namespace
+
+    schedule_result function_granular_pass_pipeline_step::schedule_on(pipeline_t &ppl) {
+        auto function_part = take_pass();
+        // builder is asked again for a fresh module-level instance
+        auto module_part = take_pass();
+
+        auto status = initialize_options(*module_part, "skip-functions=true");
+        VAST_CHECK(mlir::succeeded(status),
+            "Pass {0} can not be scheduled per function.", module_part->getArgument()
+        );
+
+        ppl.add_function_granular_pass(std::move(function_part), std::move(module_part));
+        return schedule_result::advance;
+    }
+
 
     schedule_result compound_pipeline_step::schedule_on(pipeline_t &ppl) {
         VAST_PIPELINE_DEBUG("scheduling compound step: {0}", pipeline_name);
+        ppl.compound_steps.push_back(pipeline_name);
+        auto pop = llvm::make_scope_exit([&] { ppl.compound_steps.pop_back(); });
+
         for (const auto &step : steps) {
             if (ppl.schedule(step()) == schedule_result::stop) {
                 return schedule_result::stop;
@@ -79,6 +289,32 @@ namespace vast {
         return schedule_result::advance;
     }
 
+    schedule_result branch_pipeline_step::schedule_on(pipeline_t &ppl) {
+        auto pipeline = ppl.make_branch(branch_name);
+        for (const auto &step : steps) {
+            if (pipeline->schedule(step()) == schedule_result::stop) {
+                break;
+            }
+        }
+
+        ppl.fork(std::make_unique< pipeline_branch >(branch_name, std::move(pipeline)));
+        return schedule_result::advance;
+    }
+
+    gap::generator< pipeline_step_ptr > branch_pipeline_step::substeps() const {
+        for (const auto &step : steps) {
+            co_yield step();
+        }
+    }
+
+    string_ref branch_pipeline_step::name() const {
+        return branch_name;
+    }
+
+    string_ref branch_pipeline_step::cli_name() const {
+        return branch_name;
+    }
+
     string_ref compound_pipeline_step::name() const {
         return pipeline_name;
     }
@@ -1,27 +1,296 @@
-
 // Copyright (c) 2024, Trail of Bits, Inc.
 
 #include "vast/Util/Snapshots.hpp"
 
+VAST_RELAX_WARNINGS
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Support/Compression.h>
+#include <llvm/Support/Endian.h>
+#include <llvm/Support/EndianStream.h>
+#include <mlir/Bytecode/BytecodeWriter.h>
+#include <mlir/IR/BuiltinOps.h>
+VAST_UNRELAX_WARNINGS
+
 namespace vast::util {
 
+    namespace {
+
+        std::unique_ptr< llvm::raw_fd_ostream > open_snapshot_file(const std::string &name) {
+            std::error_code error_code;
+            auto os = std::make_unique< llvm::raw_fd_ostream >(name, error_code);
+            VAST_CHECK(!error_code, "Cannot open file to store snapshot, error code: {0}", error_code.message());
+            return os;
+        }
+
+        std::optional< llvm::compression::Format > available_compression() {
+            if (llvm::compression::zstd::isAvailable()) {
+                return llvm::compression::Format::Zstd;
+            }
+            if (llvm::compression::zlib::isAvailable()) {
+                return llvm::compression::Format::Zlib;
+            }
+            return std::nullopt;
+        }
+
+    } // namespace
+
+    //
+    // snapshot_files
+    //
+    void snapshot_files::write(std::string name, std::string data) {
+        auto os = open_snapshot_file(prefix + "." + name + extension);
+        (*os) << data;
+    }
+
+    //
+    // snapshot_archive
+    //
+    static constexpr string_ref archive_magic = "VASTSNAP";
+
+    snapshot_archive::snapshot_archive(string_ref prefix, bool compress)
+        : os(open_snapshot_file(prefix.str() + ".snapshots")), compress(compress)
+    {
+        (*os) << archive_magic;
+    }
+
+    void snapshot_archive::write(std::string name, std::string data) {
+        auto bytes = llvm::arrayRefFromStringRef(data);
+
+        snapshot_archive_entry e{ std::move(name), os->tell(), data.size(), data.size(), 0 };
+
+        llvm::SmallVector< uint8_t, 0 > compressed;
+        if (auto format = compress ? available_compression() : std::nullopt) {
+            llvm::compression::compress(*format, bytes, compressed);
+            bytes         = compressed;
+            e.size        = compressed.size();
+            e.compression = std::uint8_t(*format) + 1;
+        }
+
+        os->write(reinterpret_cast< const char * >(bytes.data()), bytes.size());
+        index.push_back(std::move(e));
+    }
+
+    snapshot_archive::~snapshot_archive() {
+        llvm::support::endian::Writer out(*os, llvm::endianness::little);
+
+        std::uint64_t index_offset = os->tell();
+        for (const auto &e : index) {
+            out.write< std::uint32_t >(std::uint32_t(e.name.size()));
+            (*os) << e.name;
+            out.write< std::uint64_t >(e.offset);
+            out.write< std::uint64_t >(e.size);
+            out.write< std::uint64_t >(e.uncompressed_size);
+            out.write< std::uint8_t >(e.compression);
+        }
+
+        out.write< std::uint64_t >(index_offset);
+        out.write< std::uint32_t >(std::uint32_t(index.size()));
+    }
+
+    //
+    // snapshot_archive_reader
+    //
+    std::optional< snapshot_archive_reader > snapshot_archive_reader::open(string_ref path) {
+        auto file = llvm::MemoryBuffer::getFile(path, /* IsText */ false, /* RequiresNullTerminator */ false);
+        if (!file) {
+            return std::nullopt;
+        }
+
+        snapshot_archive_reader reader;
+        reader.buffer = std::move(*file);
+
+        auto data = reader.buffer->getBuffer();
+        constexpr std::size_t trailer_size = sizeof(std::uint64_t) + sizeof(std::uint32_t);
+        if (!data.starts_with(archive_magic) || data.size() < archive_magic.size() + trailer_size) {
+            return std::nullopt;
+        }
+
+        using namespace llvm::support;
+
+        auto trailer = data.take_back(trailer_size);
+        auto index_offset = endian::read< std::uint64_t, llvm::endianness::little >(trailer.data());
+        auto count = endian::read< std::uint32_t, llvm::endianness::little >(
+            trailer.data() + sizeof(std::uint64_t)
+        );
+
+        auto entries_end = data.size() - trailer_size;
+        if (index_offset < archive_magic.size() || index_offset > entries_end) {
+            return std::nullopt;
+        }
+
+        auto index = data.slice(index_offset, entries_end);
+        auto take = [&] (std::size_t size) -> std::optional< string_ref > {
+            if (index.size() < size) {
+                return std::nullopt;
+            }
+            auto bytes = index.take_front(size);
+            index = index.drop_front(size);
+            return bytes;
+        };
+
+        auto take_int = [&] < typename int_t > (int_t &value) {
+            auto bytes = take(sizeof(int_t));
+            if (bytes) {
+                value = endian::read< int_t, llvm::endianness::little >(bytes->data());
+            }
+            return bytes.has_value();
+        };
+
+        for (std::uint32_t idx = 0; idx < count; ++idx) {
+            entry e;
+            std::uint32_t name_size = 0;
+            if (!take_int(name_size)) {
+                return std::nullopt;
+            }
+
+            auto name = take(name_size);
+            if (!name) {
+                return std::nullopt;
+            }
+            e.name = name->str();
+
+            if (!take_int(e.offset) || !take_int(e.size)
+                || !take_int(e.uncompressed_size) || !take_int(e.compression))
+            {
+                return std::nullopt;
+            }
+
+            if (e.offset > index_offset || e.size > index_offset - e.offset) {
+                return std::nullopt;
+            }
+
+            reader.index.push_back(std::move(e));
+        }
+
+        return reader;
+    }
+
+    auto snapshot_archive_reader::find(string_ref name) const -> const entry * {
+        auto it = llvm::find_if(index, [&] (const auto &e) { return e.name == name; });
+        return it != index.end() ? &*it : nullptr;
+    }
+
+    std::optional< std::string > snapshot_archive_reader::read(const entry &e) const {
+        auto data = buffer->getBuffer().substr(e.offset, e.size);
+        if (!e.compression) {
+            return data.str();
+        }
+
+        if (e.compression > std::uint8_t(llvm::compression::Format::Zstd) + 1) {
+            return std::nullopt;
+        }
+
+        auto format = llvm::compression::Format(e.compression - 1);
+        if (llvm::compression::getReasonIfUnsupported(format)) {
+            return std::nullopt;
+        }
+
+        llvm::SmallVector< uint8_t, 0 > uncompressed;
+        auto error = llvm::compression::decompress(
+            format, llvm::arrayRefFromStringRef(data), uncompressed, e.uncompressed_size
+        );
+        if (error) {
+            llvm::consumeError(std::move(error));
+            return std::nullopt;
+        }
+
+        return llvm::toStringRef(uncompressed).str();
+    }
+
+    //
+    // async_snapshot_sink
+    //
+    async_snapshot_sink::async_snapshot_sink(snapshot_sink_ptr sink, std::size_t queue_size)
+        : sink(std::move(sink)), queue_size(std::max< std::size_t >(queue_size, 1))
+        , writer([this] { run(); })
+    {}
+
+    async_snapshot_sink::~async_snapshot_sink() {
+        {
+            std::lock_guard lock(mutex);
+            done = true;
+        }
+        not_empty.notify_one();
+        writer.join();
+    }
+
+    void async_snapshot_sink::write(std::string name, std::string data) {
+        {
+            std::unique_lock lock(mutex);
+            not_full.wait(lock, [&] { return queue.size() < queue_size; });
+            queue.emplace_back(std::move(name), std::move(data));
+        }
+        not_empty.notify_one();
+    }
+
+    void async_snapshot_sink::run() {
+        while (true) {
+            std::pair< std::string, std::string > snapshot;
+            {
+                std::unique_lock lock(mutex);
+                not_empty.wait(lock, [&] { return done || !queue.empty(); });
+                // Pending snapshots are still written after the pipeline finished.
+                if (queue.empty()) {
+                    return;
+                }
+                snapshot = std::move(queue.front());
+                queue.pop_front();
+            }
+            not_full.notify_one();
+
+            sink->write(std::move(snapshot.first), std::move(snapshot.second));
+        }
+    }
+
+    //
+    // with_snapshots
+    //
+    with_snapshots::with_snapshots(string_ref file_prefix, snapshot_config config)
+        : file_prefix(file_prefix), config(config)
+    {
+        if (config.archive) {
+            sink = std::make_unique< snapshot_archive >(file_prefix, config.compress);
+        } else {
+            auto extension = config.format == snapshot_format::bytecode ? ".mlirbc" : "";
+            sink = std::make_unique< snapshot_files >(file_prefix, extension);
+        }
+
+        if (config.async) {
+            sink = std::make_unique< async_snapshot_sink >(std::move(sink), config.queue_size);
+        }
+    }
+
+    std::string with_snapshots::serialize(operation op) const {
+        std::string buffer;
+        llvm::raw_string_ostream os(buffer);
+
+        if (config.format == snapshot_format::bytecode) {
+            mlir::BytecodeWriterConfig writer_config("VAST");
+            auto result = mlir::writeBytecodeToFile(op, os, writer_config);
+            VAST_CHECK(mlir::succeeded(result), "Could not generate snapshot bytecode");
+        } else {
+            os << *op;
+        }
+
+        return buffer;
+    }
+
     void with_snapshots::runAfterPass(pass_ptr pass, operation op) {
         if (!should_snapshot(pass)) {
             return;
         }
 
-        auto os = make_output_stream(pass);
-        (*os) << *op;
-    }
+        // Function-level instances of function granular passes run in
+        // parallel, the module is snapshotted after their module-level part.
+        if (auto parent = op->getParentOp(); parent && !mlir::isa< mlir::ModuleOp >(parent)) {
+            return;
+        }
 
-    auto with_snapshots::make_output_stream(pass_ptr pass)
-        -> output_stream_ptr
-    {
-        std::string output_file_name = file_prefix + "." + pass->getArgument().str();
-        std::error_code error_code;
-        auto os = std::make_shared< llvm::raw_fd_ostream >(output_file_name, error_code);
-        VAST_CHECK(!error_code, "Cannot open file to store snapshot, error code: {0}", error_code.message());
-        return os;
+        // The module is serialized right away, so that only the bytes are
+        // shared with the background writer and not the IR being transformed.
+        auto data = serialize(op);
+        std::lock_guard lock(sink_mutex);
+        sink->write(pass->getArgument().str(), std::move(data));
     }
 
 } // namespace vast::util
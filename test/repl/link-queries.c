@@ -0,0 +1,17 @@
+// RUN: printf "load %s\n storage full\n raise vast-hl-to-ll-cf,vast-vars-to-cells a\n raise vast-hl-to-ll-cf b\n show link a\n show link a\n exit" | %vast-repl | %file-check %s
+// RUN: printf "load %s\n storage delta\n raise vast-hl-to-ll-cf,vast-vars-to-cells a\n raise vast-hl-to-ll-cf b\n show link a\n show link a\n exit" | %vast-repl | %file-check %s
+
+// Queries of a link answer the same after other links evicted modules they
+// went through.
+
+// CHECK: hl.var @x
+// CHECK: => {{.*}}ll.cell
+// CHECK: hl.var @x
+// CHECK: => {{.*}}ll.cell
+
+// REQUIRES: clone-memory-leak
+
+int main(void) {
+    int x = 0;
+    return x;
+}
@@ -0,0 +1,19 @@
+// RUN: printf "load %s\n raise vast-hl-to-ll-cf a\n raise vast-hl-to-ll-cf,vast-hl-to-lazy-regions{skip-functions=true} b\n show link b\n exit" | %vast-repl | %file-check %s
+
+// The cached prefix is reused and the remaining passes are cloned together
+// with their options.
+
+// CHECK: hl.var @g
+// CHECK: hl.bin.land
+// CHECK-NEXT: => {{.*}}core.bin.land
+// CHECK: hl.func @fn
+// CHECK: hl.bin.land
+// CHECK-NEXT: => {{.*}}hl.bin.land
+
+// REQUIRES: clone-memory-leak
+
+int g = 1 && 2;
+
+int fn(int a, int b) {
+    return a && b;
+}
@@ -0,0 +1,13 @@
+// RUN: printf "load %s\n raise vast-hl-to-ll-cf a\n raise vast-hl-to-ll-cf a\n raise vast-hl-to-ll-cf,vast-vars-to-cells b\n raise vast-hl-to-ll-cf,vast-vars-to-cells b\n show link a\n show link b\n exit" | %vast-repl | %file-check %s
+
+// Raising a link under the same name releases the previous one, modules of
+// the remaining links stay available.
+
+// CHECK: hl.func @main
+// CHECK: => {{.*}}hl.func @main
+// CHECK: hl.func @main
+// CHECK: => {{.*}}hl.func @main
+
+// REQUIRES: clone-memory-leak
+
+int main(void) { return 0; }
@@ -0,0 +1,10 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: echo '[{"directory": "%S", "file": "batch-a.c", "arguments": ["clang", "-c", "batch-a.c"]}]' > %t/compile_commands.json
+// RUN: %vast-front -vast-batch=%t/compile_commands.json -vast-emit-mlir=hl -vast-batch-output=%t/out -vast-batch-report=%t/report.json
+// RUN: %file-check --input-file=%t/out/batch-a-0.mlir %s
+// RUN: %file-check --input-file=%t/report.json %s -check-prefix=REPORT
+
+// CHECK: hl.func @sum
+// REPORT: "failed": 0
+// REPORT: "succeeded": 1
+int sum(int a, int b) { return a + b; }
@@ -0,0 +1,13 @@
+// RUN: rm -rf %t && mkdir -p %t && cd %t
+// RUN: %vast-cc1 -vast-emit-mlir=llvm -vast-branch="vast-export-fn-info{o=%t/info.json}" -vast-print-pipeline=dot %s -o %t/out.mlir 2>&1 | %file-check %s -check-prefix=DOT
+// RUN: %file-check --input-file=%t/info.json %s -check-prefix=INFO
+// RUN: test -s %t/branch-a.vast-export-fn-info.mlir
+
+// DOT: digraph pipeline
+// DOT: subgraph cluster_0
+// DOT: label="main"
+// DOT: subgraph cluster_1
+// DOT: label="vast-export-fn-info"
+
+// INFO: "sum"
+int sum(int a, int b) { return a + b; }
@@ -0,0 +1,11 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %vast-cc1 -vast-emit-mlir=llvm %s -o %t/uncached.mlir
+// RUN: %vast-cc1 -vast-cache-dir=%t/cache -vast-emit-mlir=std %s -o %t/std.mlir
+// RUN: %vast-cc1 -vast-cache-dir=%t/cache -vast-emit-mlir=llvm %s -o %t/resumed.mlir
+// RUN: %vast-cc1 -vast-cache-dir=%t/cache -vast-emit-mlir=llvm %s -o %t/cached.mlir
+// RUN: diff %t/uncached.mlir %t/resumed.mlir
+// RUN: diff %t/uncached.mlir %t/cached.mlir
+// RUN: %file-check %s --input-file=%t/cached.mlir
+
+// CHECK: llvm.func @sum
+int sum(int a, int b) { return a + b; }
@@ -0,0 +1,23 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %vast-cc1 -vast-cache-dir=%t/cache -vast-emit-mlir=llvm %s -o %t/full.mlir
+// RUN: %vast-cc1 -vast-emit-mlir-after=vast-hl-lower-types %s -o %t/types.uncached.mlir
+// RUN: %vast-cc1 -vast-cache-dir=%t/cache -vast-emit-mlir-after=vast-hl-lower-types %s -o %t/types.cached.mlir
+// RUN: diff %t/types.uncached.mlir %t/types.cached.mlir
+// RUN: %vast-cc1 -vast-emit-mlir-after=vast-lower-value-categories %s -o %t/lvc.uncached.mlir
+// RUN: %vast-cc1 -vast-cache-dir=%t/cache -vast-emit-mlir-after=vast-lower-value-categories %s -o %t/lvc.cached.mlir
+// RUN: diff %t/lvc.uncached.mlir %t/lvc.cached.mlir
+// RUN: %vast-cc1 -vast-emit-mlir=llvm %s -o %t/full.uncached.mlir
+// RUN: %vast-cc1 -vast-cache-dir=%t/cache -vast-emit-mlir=llvm %s -o %t/full.cached.mlir
+// RUN: diff %t/full.uncached.mlir %t/full.cached.mlir
+// RUN: %file-check %s --input-file=%t/lvc.cached.mlir
+
+// Lowering of value categories is not idempotent, the cached prefix has to
+// contain exactly the steps that precede it.
+
+// CHECK: ll.alloca : !hl.ptr<si32>
+int count(int n) {
+    int total = 0;
+    for (int i = 0; i < n; ++i)
+        total += i;
+    return total;
+}
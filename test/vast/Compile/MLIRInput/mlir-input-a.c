@@ -0,0 +1,13 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t.mlir
+// RUN: %vast-cc1 -vast-emit-mlir=llvm %t.mlir -o - | %file-check %s -check-prefix=LLVM
+// RUN: %vast-cc1 -vast-emit-mlir=std %s -o %t.std.mlir
+// RUN: %vast-cc1 -vast-emit-mlir=std %t.std.mlir -o - | %file-check %s -check-prefix=STD
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-emit-mlir-bytecode %s -o %t.mlirbc
+// RUN: %vast-cc1 -vast-emit-mlir=llvm %t.mlirbc -o - | %file-check %s -check-prefix=LLVM
+
+// LLVM: llvm.func @sum
+// LLVM: llvm.add
+
+// STD: hl.func @sum
+// STD: hl.add
+int sum(int a, int b) { return a + b; }
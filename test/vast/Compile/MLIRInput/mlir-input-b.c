@@ -0,0 +1,9 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t.mlir
+// RUN: %vast-cc1 -vast-stream-functions -vast-emit-llvm %t.mlir -o - | %file-check %s
+// RUN: %vast-cc1 -vast-emit-mlir=llvm -vast-pipeline-stats=%t.json %t.mlir -o - | %file-check %s -check-prefix=STATS
+
+// Options that rely on the codegen driver are ignored for MLIR input.
+
+// CHECK: define {{.*}} i32 @sum
+// STATS: llvm.func @sum
+int sum(int a, int b) { return a + b; }
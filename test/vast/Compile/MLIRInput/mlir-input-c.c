@@ -0,0 +1,10 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t/hl.mlir
+// RUN: %vast-cc1 -vast-emit-mlir=std -vast-print-pipeline %t/hl.mlir -o %t/std.mlir 2>&1 | %file-check %s -check-prefix=HL
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-simplify %s -o %t/simplified.mlir
+// RUN: %vast-cc1 -vast-emit-mlir=std -vast-print-pipeline %t/simplified.mlir -o %t/std.mlir 2>&1 | %file-check %s -check-prefix=HL
+
+// High level module without high level only types is still high level.
+
+// HL: vast-hl-lower-types
+void nop(void) {}
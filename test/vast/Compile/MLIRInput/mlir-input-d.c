@@ -0,0 +1,13 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t/hl.mlir
+// RUN: %vast-cc1 -vast-emit-mlir=std -vast-print-pipeline %t/hl.mlir -o %t/std.mlir 2>&1 | %file-check %s -check-prefix=HL
+// RUN: %vast-cc1 -vast-emit-mlir=llvm -vast-print-pipeline %t/std.mlir -o %t/llvm.mlir 2>&1 | %file-check %s -check-prefix=STD
+
+// HL: vast-hl-lower-types
+
+// STD: Pass Manager with
+// STD-NOT: vast-hl-lower-types
+// STD: vast-hl-to-ll-func
+// STD: vast-emit-abi
+typedef int number;
+number sum(number a, number b) { return a + b; }
@@ -0,0 +1,22 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %vast-cc1 -vast-emit-mlir-after=vast-hl-to-ll-func %s -o %t/to-ll.mlir
+// RUN: %vast-cc1 -vast-emit-mlir=llvm -vast-print-pipeline %t/to-ll.mlir -o %t/partial.mlir 2>&1 | %file-check %s -check-prefix=PARTIAL
+// RUN: %file-check --input-file=%t/partial.mlir %s -check-prefix=LLVM
+// RUN: %vast-cc1 -vast-emit-mlir-after=vast-lower-abi %s -o %t/abi.mlir
+// RUN: %vast-cc1 -vast-emit-mlir=llvm -vast-print-pipeline %t/abi.mlir -o %t/lowered.mlir 2>&1 | %file-check %s -check-prefix=ABI
+// RUN: %file-check --input-file=%t/lowered.mlir %s -check-prefix=LLVM
+
+// Module in the middle of lowering to ll still needs the whole abi step.
+
+// PARTIAL: Pass Manager with
+// PARTIAL-NOT: vast-hl-lower-types
+// PARTIAL: vast-lower-value-categories
+// PARTIAL: vast-emit-abi
+// PARTIAL: vast-irs-to-llvm
+
+// ABI: Pass Manager with
+// ABI-NOT: vast-emit-abi
+// ABI: vast-irs-to-llvm
+
+// LLVM: llvm.func @sum
+int sum(int a, int b) { return a + b; }
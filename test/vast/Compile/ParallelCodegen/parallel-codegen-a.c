@@ -0,0 +1,38 @@
+// RUN: %vast-front -vast-emit-mlir=hl -vast-codegen-jobs=4 -o - %s | %file-check %s
+// RUN: %vast-front -vast-emit-mlir=hl -vast-codegen-jobs=1 -o %t.sequential.mlir %s
+// RUN: %vast-front -vast-emit-mlir=hl -vast-codegen-jobs=4 -o %t.parallel.mlir %s
+// RUN: diff %t.sequential.mlir %t.parallel.mlir
+
+struct point { int x, y; };
+
+// CHECK: hl.func @abs
+// CHECK: hl.return
+int abs(int v) { return v < 0 ? -v : v; }
+
+// CHECK: hl.func @dist
+// CHECK: hl.call @abs
+// CHECK: hl.call @abs
+int dist(struct point a, struct point b) {
+    return abs(a.x - b.x) + abs(a.y - b.y);
+}
+
+// CHECK: hl.func @clear
+// CHECK: hl.call
+void clear(char *buf, unsigned long size) {
+    __builtin_memset(buf, 0, size);
+}
+
+// CHECK: hl.func @count
+// CHECK: hl.label.decl @skip
+// CHECK: hl.for
+// CHECK: hl.goto
+int count(int n) {
+    int total = 0;
+    for (int i = 0; i < n; ++i) {
+        if (i % 2)
+            goto skip;
+        total += i;
+    skip:;
+    }
+    return total;
+}
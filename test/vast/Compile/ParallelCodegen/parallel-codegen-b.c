@@ -0,0 +1,26 @@
+// RUN: %vast-front -vast-emit-mlir=hl -vast-codegen-jobs=4 -o - %s | %file-check %s
+
+// The builtin `va_list` is first used in bodies emitted by workers.
+
+// CHECK: hl.typedef @__builtin_va_list
+// CHECK: hl.func @sum
+// CHECK: hl.call @__builtin_va_start
+int sum(int n, ...) {
+    __builtin_va_list args;
+    __builtin_va_start(args, n);
+    int total = 0;
+    for (int i = 0; i < n; ++i)
+        total += __builtin_va_arg(args, int);
+    __builtin_va_end(args);
+    return total;
+}
+
+// CHECK: hl.func @first
+// CHECK: hl.va_arg_expr
+int first(int n, ...) {
+    __builtin_va_list args;
+    __builtin_va_start(args, n);
+    int value = __builtin_va_arg(args, int);
+    __builtin_va_end(args);
+    return value;
+}
@@ -0,0 +1,16 @@
+// RUN: %vast-front -vast-emit-mlir=hl -vast-codegen-jobs=1 -o %t.sequential.mlir %s
+// RUN: %vast-front -vast-emit-mlir=hl -vast-codegen-jobs=8 -o %t.parallel.mlir %s
+// RUN: diff %t.sequential.mlir %t.parallel.mlir
+// RUN: %file-check %s --input-file=%t.parallel.mlir
+
+// Types first generated by different workers are laid out in a stable order.
+
+// CHECK: vast.core.dl_spec = #core.data_layout<[
+struct a { char c; };
+struct b { short s; };
+struct c { long l; };
+
+short fa(struct a v) { short s = v.c; return s; }
+long fb(struct b v) { long l = v.s; return l; }
+double fc(struct c v) { double d = v.l; return d; }
+unsigned char fd(float f) { unsigned char u = f; return u; }
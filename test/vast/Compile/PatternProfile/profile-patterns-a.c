@@ -0,0 +1,5 @@
+// RUN: %vast-cc1 -vast-emit-mlir=llvm -vast-profile-patterns %s -o %t.mlir 2>&1 | %file-check %s
+
+// CHECK: Pattern profile: vast-irs-to-llvm
+// CHECK: time (ms) attempts successes failures pattern
+int sum(int a, int b) { return a + b; }
@@ -0,0 +1,19 @@
+// RUN: %vast-cc1 -vast-emit-mlir=llvm -vast-pipeline-stats=%t.json %s -o %t.mlir
+// RUN: cat %t.json | %file-check %s
+// RUN: %vast-cc1 -vast-emit-mlir=llvm -vast-pipeline-stats=%t.measured.json -vast-pipeline-stats-measure=vast-hl-lower-types %s -o %t.mlir
+// RUN: cat %t.measured.json | %file-check %s -check-prefix=MEASURED
+
+// CHECK: "codegen"
+// CHECK: "emit"
+// CHECK: "passes"
+// CHECK-NOT: "ops"
+// CHECK: "name": "vast-hl-lower-types"
+// CHECK: "steps"
+
+// MEASURED: "passes"
+// MEASURED: "after"
+// MEASURED: "ops"
+// MEASURED: "before"
+// MEASURED: "ops"
+// MEASURED: "name": "vast-hl-lower-types"
+int sum(int a, int b) { return a + b; }
@@ -0,0 +1,13 @@
+// RUN: rm -rf %t && mkdir -p %t && cd %t
+// RUN: %vast-cc1 -vast-emit-mlir=std -vast-snapshot-at=vast-hl-lower-types -vast-snapshot-format=bytecode -vast-snapshot-async %s -o %t/out.mlir
+// RUN: %vast-cc1 -vast-emit-mlir=std %t/snapshot-a.vast-hl-lower-types.mlirbc -o - | %file-check %s
+// RUN: %vast-cc1 -vast-emit-mlir=std -vast-snapshot-at=* -vast-snapshot-archive -vast-snapshot-compress %s -o %t/out.mlir
+// RUN: %vast-query --list-snapshots %t/snapshot-a.snapshots | %file-check %s -check-prefix=LIST
+// RUN: %vast-query --extract-snapshot=vast-hl-lower-types %t/snapshot-a.snapshots > %t/archived.mlir
+// RUN: %vast-cc1 -vast-emit-mlir=std %t/archived.mlir -o - | %file-check %s
+
+// LIST: vast-hl-lower-types {{[1-9][0-9]*}}
+
+// CHECK: hl.func @sum
+// CHECK: hl.add
+int sum(int a, int b) { return a + b; }
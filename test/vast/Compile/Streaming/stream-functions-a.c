@@ -0,0 +1,22 @@
+// RUN: %vast-front -vast-stream-functions -S -emit-llvm -o - %s | %file-check %s
+// RUN: %vast-front -vast-stream-functions -o %t %s && (%t; test $? -eq 7)
+
+struct pair { int first, second; };
+
+// CHECK-DAG: @counter = global i32 3
+int counter = 3;
+
+// CHECK-DAG: @scale = internal global i32 2
+static int scale = 2;
+
+// CHECK-DAG: define internal {{.*}}i32 @twice(
+static int twice(int v) { return v * scale; }
+
+// CHECK-DAG: define {{.*}}i32 @sum(
+int sum(struct pair p) { return twice(p.first) + p.second; }
+
+// CHECK-DAG: define {{.*}}i32 @main(
+int main(void) {
+    struct pair p = { 1, 2 };
+    return sum(p) + counter;
+}
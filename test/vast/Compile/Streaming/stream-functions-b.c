@@ -0,0 +1,32 @@
+// RUN: %vast-front -vast-stream-functions -S -emit-llvm -o - %s | %file-check %s
+// RUN: %vast-front -vast-stream-functions -o %t %s && (%t; test $? -eq 12)
+
+// Each streamed function gets only declarations it references, including
+// types nested in referenced types.
+
+enum color { red = 1, green = 2 };
+
+struct inner { int value; };
+struct outer { struct inner in; enum color c; };
+
+typedef struct outer outer_t;
+
+// CHECK-DAG: @limit = internal global i32 4
+static int limit = 4;
+
+// CHECK-DAG: define internal {{.*}}i32 @unused(
+static int unused(void) { return limit; }
+
+// CHECK-DAG: define {{.*}}i32 @weight(
+int weight(outer_t o) { return o.in.value * (o.c == green ? 2 : 1); }
+
+typedef int (*callback_t)(outer_t);
+
+// CHECK-DAG: define {{.*}}i32 @apply(
+int apply(callback_t cb, outer_t o) { return cb(o); }
+
+// CHECK-DAG: define {{.*}}i32 @main(
+int main(void) {
+    outer_t o = { { 3 }, green };
+    return apply(weight, o) + limit + (unused() - limit) * 0 + 2;
+}
@@ -0,0 +1,37 @@
+// RUN: %vast-front -vast-emit-mlir-after=vast-hl-to-lazy-regions %s -o %t.mlir
+// RUN: %vast-opt --vast-emit-abi %t.mlir | %file-check %s
+// RUN: %vast-opt --vast-emit-abi -mlir-pass-statistics -mlir-pass-statistics-display=list %t.mlir -o /dev/null 2>&1 | %file-check %s -check-prefix=STATS
+
+// Calls are wrapped, functions other than main get the abi signature and
+// only returns of values get epilogues: 3 calls, 3 functions and 1 return.
+
+// STATS: EmitABI
+// STATS-DAG: (S) {{[1-9][0-9]*}} ops-visited
+// STATS-DAG: (S) 7 ops-rewritten
+
+struct vec { int a; int b; };
+
+// CHECK: abi.func @vast.abi.reset
+// CHECK-NOT: abi.epilogue
+// CHECK: ll.return
+void reset(struct vec *v) { v->a = 0; return; }
+
+// CHECK: abi.func @vast.abi.noop
+// CHECK-NOT: abi.epilogue
+// CHECK: abi.func @vast.abi.sum
+void noop(void) {}
+
+// CHECK: abi.epilogue
+// CHECK: func @main
+int sum(struct vec v) { return v.a + v.b; }
+
+// CHECK-NOT: abi.epilogue
+// CHECK: abi.call_exec @reset
+// CHECK: abi.call_exec @noop
+// CHECK: abi.call_exec @sum
+int main(void) {
+    struct vec v;
+    reset(&v);
+    noop();
+    return sum(v);
+}
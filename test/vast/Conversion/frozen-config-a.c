@@ -0,0 +1,21 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt -mlir-disable-threading --pass-pipeline='builtin.module(core.module(any(vast-hl-to-lazy-regions)))' | %file-check %s -check-prefix=LAZY
+// RUN: %vast-front -vast-emit-mlir-after=vast-vars-to-cells %s -o %t.mlir
+// RUN: %vast-opt -mlir-disable-threading --pass-pipeline='builtin.module(core.module(any(vast-strip-param-lvalues)))' %t.mlir | %file-check %s -check-prefix=PARAMS
+// RUN: %vast-opt --pass-pipeline='builtin.module(core.module(any(vast-strip-param-lvalues)))' %t.mlir | %file-check %s -check-prefix=PARAMS
+
+// A single instance of a pass with a frozen configuration converts each function.
+
+// LAZY: hl.func @fst
+// LAZY: core.bin.land
+// LAZY: hl.func @snd
+// LAZY: core.bin.lor
+
+// PARAMS: ll.func @fst external ({{%.*}}: si32, {{%.*}}: si32) -> si32
+// PARAMS: ll.func @snd external ({{%.*}}: si32, {{%.*}}: si32) -> si32
+int fst(int a, int b) {
+    return a && b;
+}
+
+int snd(int a, int b) {
+    return a || b;
+}
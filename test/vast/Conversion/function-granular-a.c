@@ -0,0 +1,20 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --pass-pipeline='builtin.module(core.module(vast-hl-to-lazy-regions{skip-functions=true}))' | %file-check %s -check-prefix=MOD
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --pass-pipeline='builtin.module(core.module(any(vast-hl-to-lazy-regions)))' | %file-check %s -check-prefix=FN
+// RUN: %vast-front -vast-emit-mlir-after=vast-hl-to-lazy-regions %s -o %t.mlir
+// RUN: %vast-front -vast-emit-mlir-after=vast-hl-to-lazy-regions -vast-disable-multithreading %s -o %t.serial.mlir
+// RUN: diff %t.mlir %t.serial.mlir
+
+// MOD: hl.var @g
+// MOD: core.bin.land
+// MOD: hl.func @fn
+// MOD: hl.bin.land
+
+// FN: hl.var @g
+// FN: hl.bin.land
+// FN: hl.func @fn
+// FN: core.bin.land
+int g = 1 && 2;
+
+int fn(int a, int b) {
+    return a && b;
+}
@@ -0,0 +1,31 @@
+// RUN: %vast-front -vast-emit-mlir-after=vast-emit-abi %s -o -  | %file-check %s -check-prefix=ABI
+
+// Functions of the same signature share their classification.
+
+struct vec
+{
+    int a;
+    int b;
+};
+
+// ABI:      abi.func @vast.abi.sum{{.*}} (%arg0: i64) -> si32 {{.*}}
+// ABI-NEXT: {{.*}} = abi.prologue {
+// ABI-NEXT:   {{.*}} = abi.direct %arg0 : i64 -> !hl.record<@vec>
+int sum( struct vec v ) { return v.a + v.b; }
+
+// ABI:      abi.func @vast.abi.diff{{.*}} (%arg0: i64) -> si32 {{.*}}
+// ABI-NEXT: {{.*}} = abi.prologue {
+// ABI-NEXT:   {{.*}} = abi.direct %arg0 : i64 -> !hl.record<@vec>
+int diff( struct vec v ) { return v.a - v.b; }
+
+// ABI:      abi.func @vast.abi.first{{.*}} (%arg0: i64, %arg1: i64) -> si32 {{.*}}
+int first( struct vec v, struct vec w ) { return v.a + w.a; }
+
+int main()
+{
+    struct vec v;
+    // ABI: abi.call @sum({{.*}}) : (i64) -> si32
+    // ABI: abi.call @diff({{.*}}) : (i64) -> si32
+    // ABI: abi.call @first({{.*}}) : (i64, i64) -> si32
+    return sum( v ) + diff( v ) + first( v, v );
+}
@@ -0,0 +1,15 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-lower-enum-refs -mlir-pass-statistics -mlir-pass-statistics-display=list -o /dev/null 2>&1 | %file-check %s
+
+// CHECK: LowerEnumRefs
+// CHECK-DAG: (S) {{[0-9]+}} indexed-symbols
+// CHECK-DAG: (S) {{[1-9][0-9]*}} symbol-lookups
+// CHECK-DAG: (S) {{[1-9]}} symbol-table-materializations
+
+enum E { E_a, E_b, E_c };
+
+int main() {
+    int a = E_a;
+    int b = E_b;
+    int c = E_c;
+    return a + b + c;
+}
@@ -0,0 +1,11 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %file-check %s
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-emit-mlir-bytecode %s -o %t.mlirbc
+// RUN: %vast-cc1 -vast-emit-mlir=hl %t.mlirbc -o - | %file-check %s
+// RUN: %vast-cc1 -vast-emit-mlir=llvm %t.mlirbc -o - | %file-check %s -check-prefix=LLVM
+
+// CHECK: vast.core.dl_spec = #core.data_layout<[
+// CHECK-DAG: !hl.int = 32 : 32
+// CHECK-DAG: !hl.long = 64 : 64
+
+// LLVM: llvm.func @fn
+long fn(int a) { return a; }
@@ -0,0 +1,21 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-show-locs %s -o - | %file-check %s -check-prefix=COLUMN
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-show-locs -vast-locs-granularity=line %s -o - | %file-check %s -check-prefix=LINE
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-show-locs -vast-locs-granularity=function %s -o - | %file-check %s -check-prefix=FUNCTION
+
+#define ZERO 0
+
+int fn(int a) {
+    int b = ZERO;
+    return a + b;
+}
+
+// COLUMN: hl.return {{.*}}locs-granularity-a.c:9:5
+// COLUMN: } {{.*}}locs-granularity-a.c:7:5
+
+// LINE-NOT: locs-granularity-a.c:9:5
+// LINE: hl.return {{.*}}locs-granularity-a.c:9:0
+// LINE: } {{.*}}locs-granularity-a.c:7:0
+
+// FUNCTION-NOT: locs-granularity-a.c:9:
+// FUNCTION: hl.return {{.*}}locs-granularity-a.c:7:0
+// FUNCTION: } {{.*}}locs-granularity-a.c:7:0
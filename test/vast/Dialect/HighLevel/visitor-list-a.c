@@ -0,0 +1,24 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o %t.static.mlir
+// RUN: %vast-cc1 -vast-emit-mlir=hl -vast-dynamic-visitor-list %s -o %t.dynamic.mlir
+// RUN: diff %t.static.mlir %t.dynamic.mlir
+// RUN: %file-check %s --input-file=%t.dynamic.mlir
+
+// Statically composed visitors and the visitor list generate the same module.
+
+// CHECK: hl.struct @point
+struct point { int x, y; };
+
+// CHECK: hl.func @fun {{.*}} attributes {hl.warn_unused_result = #hl.warn_unused_result}
+__attribute__((warn_unused_result)) int fun(struct point p) {
+    // CHECK: hl.member {{.*}} at @x
+    // CHECK: hl.member {{.*}} at @y
+    return p.x + p.y;
+}
+
+// CHECK: hl.func @main
+int main(void) {
+    // CHECK: hl.var @p {{.*}}!hl.record<@point>
+    struct point p = { 1, 2 };
+    // CHECK: hl.call @fun
+    return fun(p);
+}
@@ -0,0 +1,21 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-export-fn-info="o=%t.json" -o %t.mlir
+// RUN: %file-check --input-file=%t.json %s
+
+struct pair { char c; int i; };
+struct outer { struct pair p; double d; };
+
+// CHECK: "fn": {
+// CHECK: "records": {
+// CHECK:   "outer": {
+// CHECK:     "align": 8,
+// CHECK:     "offset": 0,
+// CHECK:     "name": "pair",
+// CHECK:     "offset": 64,
+// CHECK:     "size": 128
+// CHECK:   "pair": {
+// CHECK:     "align": 4,
+// CHECK:     "offset": 0,
+// CHECK:     "size": 8,
+// CHECK:     "offset": 32,
+// CHECK:     "size": 64
+int fn(struct outer o, struct pair *q) { return o.p.i + q->c; }
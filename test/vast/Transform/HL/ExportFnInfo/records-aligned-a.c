@@ -0,0 +1,13 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-export-fn-info="o=%t.json" -o %t.mlir
+// RUN: %file-check --input-file=%t.json %s
+
+// Alignment of a field raises the alignment and the size of the record.
+struct aligned { int i __attribute__((aligned(16))); };
+
+// CHECK: "records": {
+// CHECK:   "aligned": {
+// CHECK:     "align": 16,
+// CHECK-NOT: "offset"
+// CHECK:     ],
+// CHECK-NEXT: "size": 128
+int fn(struct aligned a) { return a.i; }
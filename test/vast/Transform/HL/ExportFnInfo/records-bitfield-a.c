@@ -0,0 +1,13 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-export-fn-info="o=%t.json" -o %t.mlir
+// RUN: %file-check --input-file=%t.json %s
+
+// Bitfields share storage, the layout of the record comes from the frontend.
+struct flags { unsigned a : 3; unsigned b : 5; int c; };
+
+// CHECK: "records": {
+// CHECK:   "flags": {
+// CHECK:     "align": 4,
+// CHECK-NOT: "offset"
+// CHECK:     ],
+// CHECK-NEXT: "size": 64
+int fn(struct flags f) { return f.a + f.b + f.c; }
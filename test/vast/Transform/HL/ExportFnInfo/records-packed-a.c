@@ -0,0 +1,13 @@
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-export-fn-info="o=%t.json" -o %t.mlir
+// RUN: %file-check --input-file=%t.json %s
+
+// Packed records have no padding between their fields.
+struct __attribute__((packed)) packed { char c; int i; };
+
+// CHECK: "records": {
+// CHECK:   "packed": {
+// CHECK:     "align": 1,
+// CHECK-NOT: "offset"
+// CHECK:     ],
+// CHECK-NEXT: "size": 40
+int fn(struct packed p) { return p.c + p.i; }
@@ -0,0 +1,16 @@
+// RUN: %vast-front -vast-emit-mlir=hl -vast-simplify %s -o - | %file-check %s -check-prefix=FULL
+// RUN: %vast-front -vast-emit-mlir=hl -vast-simplify -vast-prune-data-layout %s -o - | %file-check %s
+// RUN: %vast-cc1 -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-dce --vast-hl-prune-data-layout | %file-check %s
+
+// FULL: vast.core.dl_spec = #core.data_layout<[{{.*}}!hl.short = 16 : 16
+
+// CHECK: vast.core.dl_spec = #core.data_layout<[
+// CHECK-NOT: !hl.short
+// CHECK-SAME: !hl.int = 32 : 32
+// CHECK-NOT: !hl.short
+// CHECK-SAME: ]>
+// CHECK: hl.func @fn
+int fn(int a) {
+    return a;
+    short dead = 0;
+}
@@ -0,0 +1,12 @@
+// RUN: %vast-front -vast-emit-mlir=hl %s -o - | %vast-opt --vast-hl-ude | %file-check %s
+
+void h(int x);
+
+// CHECK-DAG: hl.func @g
+__attribute__((always_inline)) inline void g(int x) { if (x) h(x - 1); }
+
+// CHECK-DAG: hl.func @h
+__attribute__((always_inline)) inline void h(int x) { if (x) g(x - 1); }
+
+// CHECK-DAG: hl.func @f
+void f() { g(1); }
@@ -0,0 +1,316 @@
+// Copyright (c) 2024-present, Trail of Bits, Inc.
+
+//===----------------------------------------------------------------------===//
+//
+// Batch mode of vast-front compiles all translation units of a compilation
+// database within a single process. Workers share the dialect registry and
+// keep their MLIR context for a number of translation units, or until a unit
+// crashes.
+//
+//===----------------------------------------------------------------------===//
+
+#include "vast/Util/Warnings.hpp"
+
+VAST_RELAX_WARNINGS
+#include <clang/Frontend/TextDiagnosticPrinter.h>
+#include <clang/Frontend/Utils.h>
+#include <clang/Tooling/JSONCompilationDatabase.h>
+#include <llvm/Support/CrashRecoveryContext.h>
+#include <llvm/Support/FormatVariadic.h>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/Threading.h>
+#include <llvm/Support/VirtualFileSystem.h>
+#include <mlir/InitAllDialects.h>
+VAST_UNRELAX_WARNINGS
+
+#include "vast/Dialect/Dialects.hpp"
+#include "vast/Frontend/CompilerInstance.hpp"
+#include "vast/Frontend/CompilerInvocation.hpp"
+#include "vast/Frontend/Options.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <thread>
+#include <tuple>
+
+namespace vast::cc {
+
+    frontend_action_ptr create_frontend_action(
+        compiler_instance &ci, const vast_args &vargs, mcontext_t &mctx
+    );
+
+    namespace {
+
+        using clock = std::chrono::steady_clock;
+
+        // Uniqued types and attributes are never released by a context, so
+        // workers start over with a fresh one after this many units.
+        constexpr std::size_t units_per_context = 64;
+
+        struct unit_result
+        {
+            std::string file;
+            std::string output;
+            bool success = false;
+            bool crashed = false;
+            double wall_ms = 0;
+            std::string diagnostics;
+        };
+
+        string_ref output_extension(const vast_args &vargs) {
+            if (vargs.has_option(opt::emit_mlir_bytecode)) {
+                return ".mlirbc";
+            }
+            if (vargs.has_option(opt::emit_mlir) || vargs.has_option(opt::emit_mlir_after)) {
+                return ".mlir";
+            }
+            if (vargs.has_option(opt::emit_llvm)) {
+                return ".ll";
+            }
+            if (vargs.has_option(opt::emit_asm)) {
+                return ".s";
+            }
+            return ".o";
+        }
+
+        struct batch_compiler
+        {
+            batch_compiler(
+                const vast_args &vargs, std::string output_dir, std::string resource_dir
+            )
+                : vargs(vargs), output_dir(std::move(output_dir))
+                , resource_dir(std::move(resource_dir)), extension(output_extension(vargs))
+            {
+                mlir::registerAllDialects(registry);
+                vast::registerAllDialects(registry);
+            }
+
+            std::unique_ptr< mcontext_t > make_context() const {
+                // Workers already compile in parallel, passes run on the
+                // worker thread.
+                auto mctx = std::make_unique< mcontext_t >(
+                    registry, mcontext_t::Threading::DISABLED
+                );
+                mctx->loadAllAvailableDialects();
+                return mctx;
+            }
+
+            std::string output_path(const clang::tooling::CompileCommand &cmd, std::size_t idx) const {
+                // Translation units with the same file name are told apart by
+                // their index in the database.
+                auto stem = llvm::sys::path::stem(cmd.Filename);
+                return (std::filesystem::path(output_dir)
+                    / llvm::formatv("{0}-{1}{2}", stem, idx, extension).str()
+                ).string();
+            }
+
+            unit_result compile(
+                const clang::tooling::CompileCommand &cmd, std::size_t idx, mcontext_t &mctx
+            ) const {
+                unit_result result{ cmd.Filename, output_path(cmd, idx) };
+                auto start = clock::now();
+
+                llvm::raw_string_ostream diag_os(result.diagnostics);
+                auto diag_opts = llvm::makeIntrusiveRefCnt< clang::DiagnosticOptions >();
+                clang::TextDiagnosticPrinter printer(diag_os, diag_opts.get());
+
+                // Each unit resolves relative paths against its own directory.
+                llvm::IntrusiveRefCntPtr< llvm::vfs::FileSystem > vfs =
+                    llvm::vfs::createPhysicalFileSystem();
+                vfs->setCurrentWorkingDirectory(cmd.Directory);
+
+                std::vector< const char * > args;
+                for (const auto &arg : cmd.CommandLine) {
+                    args.push_back(arg.c_str());
+                }
+
+                clang::CreateInvocationOptions inv_opts;
+                inv_opts.Diags = compiler_instance::createDiagnostics(
+                    diag_opts.get(), &printer, /* ShouldOwnClient */ false
+                );
+                inv_opts.VFS = vfs;
+
+                auto invocation = clang::createInvocation(args, std::move(inv_opts));
+                if (!invocation) {
+                    result.diagnostics += "error: failed to create compiler invocation\n";
+                    return result;
+                }
+
+                auto ci = std::make_unique< compiler_instance >();
+                ci->setInvocation(std::move(invocation));
+                ci->createDiagnostics(&printer, /* ShouldOwnClient */ false);
+                ci->createFileManager(vfs);
+
+                auto &frontend_opts       = ci->getFrontendOpts();
+                frontend_opts.OutputFile  = result.output;
+                frontend_opts.DisableFree = false;
+                ci->getHeaderSearchOpts().ResourceDir = resource_dir;
+
+                // Fatal errors of a single unit do not bring the batch down.
+                llvm::CrashRecoveryContext crc;
+                bool success = false;
+                bool finished = crc.RunSafely([&] {
+                    if (auto action = create_frontend_action(*ci, vargs, mctx)) {
+                        success = ci->ExecuteAction(*action);
+                    }
+                });
+
+                if (!finished) {
+                    result.diagnostics += "error: compilation crashed\n";
+                    result.crashed = true;
+                    // Partial outputs are removed. The instance might be in an
+                    // inconsistent state, it is abandoned instead of destroyed.
+                    ci->clearOutputFiles(/* EraseFiles */ true);
+                    std::ignore = ci.release();
+                }
+
+                result.success = finished && success;
+                result.wall_ms = std::chrono::duration< double, std::milli >(
+                    clock::now() - start
+                ).count();
+                return result;
+            }
+
+            const vast_args &vargs;
+            std::string output_dir;
+            std::string resource_dir;
+            string_ref extension;
+            mlir::DialectRegistry registry;
+        };
+
+        void write_report(
+            string_ref path, llvm::ArrayRef< unit_result > results, double wall_ms
+        ) {
+            llvm::json::Array units;
+            std::size_t failed = 0;
+            for (const auto &r : results) {
+                failed += !r.success;
+                units.push_back(llvm::json::Object{
+                    { "file", r.file },
+                    { "output", r.output },
+                    { "success", r.success },
+                    { "wall_ms", r.wall_ms },
+                    { "diagnostics", r.diagnostics }
+                });
+            }
+
+            std::error_code ec;
+            llvm::raw_fd_ostream os(path, ec);
+            VAST_CHECK(!ec, "Cannot open batch report file: {0}", ec.message());
+
+            os << llvm::formatv("{0:2}", llvm::json::Value(llvm::json::Object{
+                { "succeeded", std::int64_t(results.size() - failed) },
+                { "failed", std::int64_t(failed) },
+                { "wall_ms", wall_ms },
+                { "units", std::move(units) }
+            }));
+        }
+
+    } // namespace
+
+    int batch(const vast_args &vargs, arg_t tool, void *main_addr) {
+        auto database_path = vargs.get_option(opt::batch);
+        if (!database_path) {
+            llvm::errs() << "error: expected -vast-batch=<compile_commands.json>\n";
+            return 1;
+        }
+
+        std::string error;
+        auto database = clang::tooling::JSONCompilationDatabase::loadFromFile(
+            database_path.value(), error, clang::tooling::JSONCommandLineSyntax::AutoDetect
+        );
+
+        if (!database) {
+            llvm::errs() << "error: " << error << "\n";
+            return 1;
+        }
+
+        auto commands = database->getAllCompileCommands();
+
+        auto output_dir = vargs.get_option(opt::batch_output).value_or(".").str();
+        std::error_code ec;
+        std::filesystem::create_directories(output_dir, ec);
+        if (ec) {
+            llvm::errs() << "error: cannot create " << output_dir << ": " << ec.message() << "\n";
+            return 1;
+        }
+
+        unsigned jobs = 0;
+        if (auto value = vargs.get_option(opt::batch_jobs)) {
+            if (value->getAsInteger(10, jobs)) {
+                llvm::errs() << "error: invalid number of batch jobs: " << *value << "\n";
+                return 1;
+            }
+        }
+
+        auto strategy = jobs ? llvm::hardware_concurrency(jobs) : llvm::hardware_concurrency();
+        auto workers  = std::min< std::size_t >(
+            strategy.compute_thread_count(), std::max< std::size_t >(commands.size(), 1)
+        );
+
+        batch_compiler compiler(
+            vargs, output_dir, clang_invocation::GetResourcesPath(tool, main_addr)
+        );
+
+        // Worker threads recover from crashes of individual units.
+        llvm::CrashRecoveryContext::Enable();
+
+        std::vector< unit_result > results(commands.size());
+        std::atomic< std::size_t > next = 0;
+
+        auto start = clock::now();
+
+        auto work = [&] {
+            std::unique_ptr< mcontext_t > mctx;
+            std::size_t compiled = 0;
+
+            for (auto idx = next++; idx < commands.size(); idx = next++) {
+                if (compiled++ % units_per_context == 0) {
+                    mctx = compiler.make_context();
+                }
+
+                results[idx] = compiler.compile(commands[idx], idx, *mctx);
+
+                // The context might hold state of the crashed unit, the next
+                // unit starts over with a fresh one. The old context is
+                // abandoned as destroying it might crash as well.
+                if (results[idx].crashed) {
+                    std::ignore = mctx.release();
+                    compiled = 0;
+                }
+            }
+        };
+
+        std::vector< std::thread > threads;
+        for (std::size_t i = 0; i < workers; ++i) {
+            threads.emplace_back(work);
+        }
+
+        for (auto &thread : threads) {
+            thread.join();
+        }
+
+        auto wall_ms = std::chrono::duration< double, std::milli >(clock::now() - start).count();
+
+        auto failed = std::ranges::count_if(results, [] (const auto &r) { return !r.success; });
+        for (const auto &r : results) {
+            if (!r.success) {
+                llvm::errs() << "failed: " << r.file << "\n" << r.diagnostics;
+            }
+        }
+
+        llvm::errs() << llvm::formatv(
+            "vast-front batch: {0} succeeded, {1} failed in {2:F1} ms using {3} workers\n",
+            results.size() - std::size_t(failed), failed, wall_ms, workers
+        );
+
+        if (auto report = vargs.get_option(opt::batch_report)) {
+            write_report(report.value(), results, wall_ms);
+        }
+
+        return failed ? 1 : 0;
+    }
+
+} // namespace vast::cc
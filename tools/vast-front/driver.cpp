@@ -22,6 +22,9 @@ VAST_UNRELAX_WARNINGS
 // main frontend method. Lives inside cc1_main.cpp
 namespace vast::cc {
     extern int cc1(const vast_args & vargs, argv_t argv, arg_t tool, void *main_addr);
+
+    // compilation of a whole compilation database. Lives inside batch.cpp
+    extern int batch(const vast_args &vargs, arg_t tool, void *main_addr);
 } // namespace vast::cc
 
 VAST_RELAX_WARNINGS
@@ -133,6 +136,19 @@ int main(int argc, char **argv) try {
 
     llvm::InitializeAllTargets();
 
+    // Batch mode compiles all units in this process, the driver is not involved.
+    if (auto [vargs, _] = vast::cc::filter_args(cmd_args); vargs.has_option(vast::cc::opt::batch)) {
+        llvm::InitializeAllTargetMCs();
+        llvm::InitializeAllAsmPrinters();
+        llvm::InitializeAllAsmParsers();
+
+        VAST_RELAX_WARNINGS
+        void *get_executable_path_ptr = (void *) (intptr_t) get_executable_path;
+        VAST_UNRELAX_WARNINGS
+
+        return vast::cc::batch(vargs, cmd_args[0], get_executable_path_ptr);
+    }
+
     llvm::BumpPtrAllocator pointer_allocator;
     llvm::StringSaver saver(pointer_allocator);
 
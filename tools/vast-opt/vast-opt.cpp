@@ -23,6 +23,16 @@ VAST_UNRELAX_WARNINGS
 #include "vast/Dialect/HighLevel/Passes.hpp"
 #include "vast/Conversion/Passes.hpp"
 #include "vast/Dialect/Dialects.hpp"
+#include "vast/Util/PatternProfiler.hpp"
+
+static llvm::cl::opt< bool > profile_patterns(
+    "vast-profile-patterns",
+    llvm::cl::desc("Profile rewrite patterns of vast conversion passes"),
+    llvm::cl::init(false),
+    llvm::cl::cb< void, bool >([](bool enable) {
+        vast::util::enable_pattern_profiling(enable);
+    })
+);
 
 int main(int argc, char **argv)
 {
@@ -40,7 +50,11 @@ int main(int argc, char **argv)
     // register conversions
     mlir::registerAllToLLVMIRTranslations(registry);
 
-    return failed(
-        mlir::MlirOptMain(argc, argv, "VAST Optimizer driver\n", registry)
-    );
+    auto result = mlir::MlirOptMain(argc, argv, "VAST Optimizer driver\n", registry);
+
+    if (profile_patterns) {
+        vast::util::print_pattern_profiles(llvm::errs());
+    }
+
+    return failed(result);
 }
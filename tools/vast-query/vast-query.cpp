@@ -26,6 +26,7 @@ VAST_UNRELAX_WARNINGS
 #include "vast/Dialect/HighLevel/HighLevelTypes.hpp"
 #include "vast/Dialect/HighLevel/Passes.hpp"
 #include "vast/Util/Common.hpp"
+#include "vast/Util/Snapshots.hpp"
 #include "vast/Util/Symbols.hpp"
 
 using memory_buffer  = std::unique_ptr< llvm::MemoryBuffer >;
@@ -74,6 +75,17 @@ namespace vast::cl
             cl::init(""),
             cl::cat(queries)
         };
+        cl::opt< bool > list_snapshots{ "list-snapshots",
+            cl::desc("List entries of a snapshot archive (-vast-snapshot-archive)"),
+            cl::init(false),
+            cl::cat(queries)
+        };
+        cl::opt< std::string > extract_snapshot{ "extract-snapshot",
+            cl::desc("Print the first snapshot taken after a given pass from a snapshot archive"),
+            cl::value_desc("pass name"),
+            cl::init(""),
+            cl::cat(queries)
+        };
     };
     // clang-format on
 
@@ -90,6 +102,10 @@ namespace vast::query
 
     bool constrained_scope() { return !cl::options->scope_name.empty(); }
 
+    bool query_snapshots() {
+        return cl::options->list_snapshots || !cl::options->extract_snapshot.empty();
+    }
+
     template< typename... Ts >
     auto is_one_of() {
         return [](mlir::Operation *op) { return (mlir::isa< Ts >(op) || ...); };
@@ -205,7 +221,43 @@ namespace vast
         }
     }
 
+    logical_result do_query_snapshots(string_ref path) {
+        auto archive = util::snapshot_archive_reader::open(path);
+        if (!archive) {
+            llvm::errs() << "error: cannot read snapshot archive " << path << "\n";
+            return mlir::failure();
+        }
+
+        if (cl::options->list_snapshots) {
+            for (const auto &entry : archive->entries()) {
+                llvm::outs() << entry.name << " " << entry.uncompressed_size << "\n";
+            }
+        }
+
+        if (auto &name = cl::options->extract_snapshot; !name.empty()) {
+            auto entry = archive->find(name);
+            if (!entry) {
+                llvm::errs() << "error: no snapshot after pass " << name << "\n";
+                return mlir::failure();
+            }
+
+            auto data = archive->read(*entry);
+            if (!data) {
+                llvm::errs() << "error: cannot read snapshot after pass " << name << "\n";
+                return mlir::failure();
+            }
+
+            llvm::outs() << *data;
+        }
+
+        return mlir::success();
+    }
+
     logical_result run(mcontext_t &ctx) {
+        if (query::query_snapshots()) {
+            return do_query_snapshots(cl::options->input_file);
+        }
+
         std::string err;
         if (auto input = mlir::openInputFile(cl::options->input_file, &err))
             return do_query(ctx, std::move(input));
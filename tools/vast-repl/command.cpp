@@ -213,7 +213,8 @@ namespace cmd {
             }
         }
         auto link = state.tower->apply(top, state.location_info, pm);
-        state.links.emplace(link_name, std::move(link));
+        // raising under an existing name releases the previous link
+        state.links.insert_or_assign(link_name, std::move(link));
     }
 
     //
@@ -229,6 +230,16 @@ namespace cmd {
         state.sticked.push_back(parse_command(tokens));
     }
 
+    //
+    // storage command
+    //
+    void storage::run(state_t &state) const {
+        if (state.tower) {
+            throw_error("storage mode has to be set before the tower is raised");
+        }
+        state.tower_storage = get_param< mode_param >(params);
+    }
+
 } // namespace cmd
 
     command_ptr parse_command(std::span< command_token > tokens) {
@@ -8,7 +8,7 @@ VAST_UNRELAX_WARNINGS
 namespace vast::repl {
 
     void state_t::raise_tower(owning_mlir_module_ref mod) {
-        tower.emplace(ctx, location_info, std::move(mod));
+        tower.emplace(ctx, location_info, std::move(mod), tower_storage);
     }
 
     mlir_module state_t::current_module() {